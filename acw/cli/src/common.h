@@ -7,6 +7,8 @@
 #include <hax.h>
 #include <acw.h>
 #include <sndfile.h>
+#include <dirent.h>
+#include <sys/stat.h>
 #include "inc.h"
 
 #endif
@@ -1,12 +1,34 @@
 #include "common.h"
 
 
+/**
+ * Batch structure.
+ *   @n, next, done, nfail: The number of files, next file, number finished,
+ *     and number failed.
+ *   @input, output: The input and output path arrays.
+ *   @start: The start time.
+ *   @lock: The progress lock.
+ */
+struct batch_t {
+	unsigned int n, next, done, nfail;
+	char **input, **output;
+
+	int64_t start;
+	sys_mutex_t lock;
+};
+
+
 /*
  * local declarations
  */
-static void encode(const char *output, const char *input);
+static char *encode(const char *output, const char *input, unsigned int nthreads);
 static void decode(const char *output, const char *input);
 
+static void batch(const char *output, const char *input, unsigned int nthreads);
+static void batch_scan(struct batch_t *batch, const struct stat *root, const char *output, const char *input);
+static void batch_mkdir(const char *path);
+static void *batch_worker(void *arg);
+
 static void noreturn error(const char *restrict format, ...);
 
 
@@ -19,8 +41,11 @@ static void noreturn error(const char *restrict format, ...);
 int main(int argc, char **argv)
 {
 	int i;
+	char *err, *end;
+	struct stat info;
 	bool dec = false, args = true;
-	const char *input = NULL, *output = NULL;
+	const char *input = NULL, *output = NULL, *jobs = NULL;
+	unsigned int nthreads = sysconf(_SC_NPROCESSORS_ONLN);
 
 	for(i = 1; i < argc; i++) {
 		if(args && (argv[i][0] == '-')) {
@@ -37,12 +62,20 @@ int main(int argc, char **argv)
 
 					output = argv[i];
 				}
-				else if(memcmp(argv[i] + 2, "output=", 7) == 0) {
+				else if(strncmp(argv[i] + 2, "output=", 7) == 0) {
 					if(output != NULL)
 						error("Output already specified.");
 
 					output = argv[i] + 9;
 				}
+				else if(strcmp(argv[i] + 2, "jobs") == 0) {
+					if(argv[++i] == NULL)
+						error("Expected count after '--jobs'.");
+
+					jobs = argv[i];
+				}
+				else if(strncmp(argv[i] + 2, "jobs=", 5) == 0)
+					jobs = argv[i] + 7;
 				else
 					error("Unknown flag '%s'.", argv[i]);
 			}
@@ -72,6 +105,19 @@ int main(int argc, char **argv)
 
 						break;
 
+					case 'j':
+						ptr++;
+						if(*ptr == '\0') {
+							ptr = argv[++i];
+							if(ptr == NULL)
+								error("Expected count after '-j'.");
+						}
+
+						brk = true;
+						jobs = ptr;
+
+						break;
+
 					default:
 						error("Unknown flag '-%c'.", *ptr);
 					}
@@ -95,23 +141,37 @@ int main(int argc, char **argv)
 	else if(output == NULL)
 		error("Missing output path.");
 
+	if(jobs != NULL) {
+		errno = 0;
+		nthreads = strtoul(jobs, &end, 10);
+		if((errno != 0) || (*end != '\0') || (nthreads == 0))
+			error("Invalid job count '%s'.", jobs);
+	}
+	else if((int)nthreads <= 0)
+		nthreads = 1;
+
 	if(dec)
 		decode(output, input);
-	else
-		encode(output, input);
+	else if((stat(input, &info) == 0) && S_ISDIR(info.st_mode))
+		batch(output, input, nthreads);
+	else if((err = encode(output, input, nthreads)) != NULL)
+		error("%s", err);
 
 	return 0;
 }
 
 
 /**
- * Encode a file.
+ * Encode a file. All channels are encoded, split across the threads.
  *   @output: The output.
  *   @input: The input.
+ *   @nthreads: The number of threads.
+ *   &returns: Error.
  */
-static void encode(const char *output, const char *input)
+static char *encode(const char *output, const char *input, unsigned int nthreads)
 {
-	int *dat, *arr;
+	char *err;
+	int *arr;
 	unsigned int i, shift;
 	SNDFILE *file;
 	SF_INFO info;
@@ -120,32 +180,31 @@ static void encode(const char *output, const char *input)
 	info.format = 0;
 	file = sf_open(input, SFM_READ, &info);
 	if(file == NULL)
-		error("Cannot read '%s'. %s", input, sf_strerror(NULL));
+		return mprintf("Cannot read '%s'. %s", input, sf_strerror(NULL));
 
 	switch(info.format & 0xF) {
 	case SF_FORMAT_PCM_S8: shift = 24; break;
 	case SF_FORMAT_PCM_16: shift = 16;; break;
 	case SF_FORMAT_PCM_24: shift = 8;; break;
 	case SF_FORMAT_PCM_32: shift = 8;; break;
-	default: return error("Invalid format in '%s'. Expected signed integer format.", input);
+	default: return sf_close(file), mprintf("Invalid format in '%s'. Expected signed integer format.", input);
 	}
 
-	dat = malloc(info.channels * info.frames * sizeof(int));
-	sf_readf_int(file, dat, info.frames);
-
-	arr = malloc(info.frames * sizeof(int));
-	for(i = 0; i < info.frames; i++)
-		arr[i] = dat[i * info.channels] >> shift;
-
-	free(dat);
+	arr = malloc(info.channels * info.frames * sizeof(int));
+	sf_readf_int(file, arr, info.frames);
 	sf_close(file);
 
-	buf = acw_buf_enc32(arr, info.frames);
+	for(i = 0; i < info.channels * info.frames; i++)
+		arr[i] >>= shift;
+
+	buf = acw_encode_par(arr, info.channels, info.frames, nthreads);
 	buf.info.rate = info.samplerate;
-	acw_buf_save(buf, output);
+	err = acw_buf_save(buf, output);
 	acw_buf_delete(buf);
 
 	free(arr);
+
+	return err;
 }
 
 /**
@@ -159,6 +218,184 @@ static void decode(const char *output, const char *input)
 }
 
 
+/**
+ * Encode every WAV and FLAC file under a directory into the same layout under
+ * the output directory. Files are encoded in parallel, one per thread, and
+ * progress is printed as each finishes.
+ *   @output: The output directory.
+ *   @input: The input directory.
+ *   @nthreads: The number of threads.
+ */
+static void batch(const char *output, const char *input, unsigned int nthreads)
+{
+	unsigned int i;
+	struct stat root;
+	sys_thread_t thread[nthreads];
+	struct batch_t batch;
+
+	batch.n = batch.next = batch.done = batch.nfail = 0;
+	batch.input = malloc(0);
+	batch.output = malloc(0);
+	batch.lock = sys_mutex_init(0);
+
+	batch_mkdir(output);
+	if(stat(output, &root) < 0)
+		error("Cannot read directory '%s'. %s.", output, strerror(errno));
+
+	batch_scan(&batch, &root, output, input);
+
+	batch.start = sys_utime();
+
+	for(i = 1; i < nthreads; i++)
+		thread[i] = sys_thread_create(0, batch_worker, &batch);
+
+	batch_worker(&batch);
+
+	for(i = 1; i < nthreads; i++)
+		sys_thread_join(&thread[i]);
+
+	fprintf(stderr, "Encoded %u files in %.1fs, %u failed.\n", batch.done - batch.nfail, (sys_utime() - batch.start) / 1e6, batch.nfail);
+
+	for(i = 0; i < batch.n; i++) {
+		free(batch.input[i]);
+		free(batch.output[i]);
+	}
+
+	free(batch.input);
+	free(batch.output);
+	sys_mutex_destroy(&batch.lock);
+
+	if(batch.nfail > 0)
+		exit(1);
+}
+
+/**
+ * Scan a directory for files to encode, creating the output directories. The
+ * output root is skipped so that it may live inside the input tree.
+ *   @batch: The batch.
+ *   @root: The output root information.
+ *   @output: The output directory.
+ *   @input: The input directory.
+ */
+static void batch_scan(struct batch_t *batch, const struct stat *root, const char *output, const char *input)
+{
+	DIR *dir;
+	const char *ext;
+	struct stat info;
+	struct dirent *ent;
+
+	dir = opendir(input);
+	if(dir == NULL)
+		error("Cannot read directory '%s'. %s.", input, strerror(errno));
+
+	batch_mkdir(output);
+
+	while((ent = readdir(dir)) != NULL) {
+		char *path, *dest;
+
+		if(ent->d_name[0] == '.')
+			continue;
+
+		path = mprintf("%s/%s", input, ent->d_name);
+		if(stat(path, &info) < 0) {
+			free(path);
+			continue;
+		}
+
+		if(S_ISDIR(info.st_mode)) {
+			if((info.st_dev == root->st_dev) && (info.st_ino == root->st_ino)) {
+				free(path);
+				continue;
+			}
+
+			dest = mprintf("%s/%s", output, ent->d_name);
+			batch_scan(batch, root, dest, path);
+			free(dest);
+			free(path);
+			continue;
+		}
+
+		ext = strrchr(ent->d_name, '.');
+		if((ext == NULL) || ((strcasecmp(ext, ".wav") != 0) && (strcasecmp(ext, ".flac") != 0))) {
+			free(path);
+			continue;
+		}
+
+		dest = mprintf("%s/%s", output, ent->d_name);
+		strcpy(strrchr(dest, '.'), ".acw");
+
+		batch->input = realloc(batch->input, (batch->n + 1) * sizeof(char *));
+		batch->output = realloc(batch->output, (batch->n + 1) * sizeof(char *));
+		batch->input[batch->n] = path;
+		batch->output[batch->n] = dest;
+		batch->n++;
+	}
+
+	closedir(dir);
+}
+
+/**
+ * Create a directory along with any missing parents.
+ *   @path: The directory path.
+ */
+static void batch_mkdir(const char *path)
+{
+	char *dir, *sep;
+	struct stat info;
+
+	dir = strdup(path);
+
+	for(sep = strchr(dir + 1, '/'); sep != NULL; sep = strchr(sep + 1, '/')) {
+		if(sep[-1] == '/')
+			continue;
+
+		*sep = '\0';
+		if(!fs_trymkdir(dir, 0775) && (errno != EEXIST))
+			error("Failed to create directory '%s'. %s.", dir, strerror(errno));
+
+		*sep = '/';
+	}
+
+	if(!fs_trymkdir(dir, 0775) && (errno != EEXIST))
+		error("Failed to create directory '%s'. %s.", dir, strerror(errno));
+
+	if((stat(dir, &info) < 0) || !S_ISDIR(info.st_mode))
+		error("Cannot create directory '%s'. Path is not a directory.", dir);
+
+	free(dir);
+}
+
+/**
+ * Encode files from a batch until none are left.
+ *   @arg: The batch.
+ *   &returns: Null.
+ */
+static void *batch_worker(void *arg)
+{
+	char *err;
+	unsigned int i;
+	struct batch_t *batch = arg;
+
+	while((i = __atomic_fetch_add(&batch->next, 1, __ATOMIC_RELAXED)) < batch->n) {
+		err = encode(batch->output[i], batch->input[i], 1);
+
+		sys_mutex_lock(&batch->lock);
+
+		batch->done++;
+		if(err != NULL)
+			batch->nfail++, fprintf(stderr, "[%u/%u] %s\n", batch->done, batch->n, err);
+		else
+			fprintf(stderr, "[%u/%u] %s\n", batch->done, batch->n, batch->output[i]);
+
+		sys_mutex_unlock(&batch->lock);
+
+		free(err);
+	}
+
+	return NULL;
+}
+
+
 /**
  * Print an error and exit.
  *   @format, ...: The printf-style format and arguments.
@@ -2,33 +2,97 @@
 #define DEFS_H
 
 /**
- * ACW information structure.
+ * ACW information structure. Versions before 1.2 store a 24-byte header with
+ * a 16-bit rate and no channel count; it is converted when read.
  *   @magic: Magic constant.
- *   @nbytes, nblocks, length: Number of bytes, blocks, and total length
- *   @rate, bits: The sample rate and base bitwidth.
+ *   @nbytes, nblocks, length: Number of bytes, blocks, and length per channel.
+ *   @rate: The sample rate, zero if unknown.
+ *   @chan, bits: The number of channels and base bitwidth.
+ *   @rsvd: Reserved, zero.
  */
 struct acw_info_t {
 	uint64_t magic;
-	uint32_t nbytes, nblocks, length;
-	uint16_t rate, bits;
+	uint32_t nbytes, nblocks, length, rate;
+	uint16_t chan, bits;
+	uint32_t rsvd;
 };
 
 /**
  * Buffer structure.
  *   @info: The buffer information.
- *   @raw: The raw data.
+ *   @raw: The raw data, read-only when mapped.
+ *   @map: The mapping length, zero if the data is allocated.
  */
 struct acw_buf_t {
 	struct acw_info_t info;
 	void *raw;
+	size_t map;
+};
+
+
+/**
+ * Mapping flags.
+ *   @ACW_MAP_PREFAULT: Read every page of the file before returning.
+ *   @ACW_MAP_HEAD: The number of bytes hinted for immediate use otherwise.
+ */
+#define ACW_MAP_PREFAULT 0x01
+#define ACW_MAP_HEAD (64*1024)
+
+/**
+ * Index entry structure. Version 1.1 files follow the block data with a
+ * 32-bit entry count and the entries, one for the first block starting at or
+ * after every multiple of 'ACW_INDEX_STEP' samples. Version 1.2 files store
+ * the channels one after another; the block data is followed by the byte
+ * offset of each channel and then a count and entries for each channel.
+ *   @sample: The sample offset.
+ *   @offset: The byte offset of the block.
+ */
+struct acw_index_t {
+	uint32_t sample, offset;
 };
 
 
 /**
  * Magic constant values.
  *   @ACW_MAGIC_1_0: Version 1.0.
+ *   @ACW_MAGIC_1_1: Version 1.1, with a seek index.
+ *   @ACW_MAGIC_1_2: Version 1.2, with channels and a 32-bit rate.
  */
 #define ACW_MAGIC_1_0 0x8821eb30b0f0100
+#define ACW_MAGIC_1_1 0x8821eb30b0f0101
+#define ACW_MAGIC_1_2 0x8821eb30b0f0102
+
+/**
+ * Header definitions.
+ *   @ACW_HEAD_1_0: The header size before version 1.2.
+ */
+#define ACW_HEAD_1_0 24
+
+/**
+ * Index definitions.
+ *   @ACW_INDEX_STEP: The sample spacing of index entries.
+ */
+#define ACW_INDEX_STEP 1024
+
+/**
+ * Check if the magic number is a supported version.
+ *   @magic: The magic number.
+ *   &returns: True if supported.
+ */
+static inline bool acw_magic_valid(uint64_t magic)
+{
+	return (magic == ACW_MAGIC_1_0) || (magic == ACW_MAGIC_1_1) || (magic == ACW_MAGIC_1_2);
+}
+
+/**
+ * Retrieve the size of the header stored in a file.
+ *   @magic: The magic number.
+ *   &returns: The size in bytes.
+ */
+static inline size_t acw_info_size(uint64_t magic)
+{
+	return (magic == ACW_MAGIC_1_2) ? sizeof(struct acw_info_t) : ACW_HEAD_1_0;
+}
 
 
 /*
@@ -41,6 +41,7 @@ static inline void perf_mark(uint32_t *mark)
  */
 #define POOL_SIZE (64*1024)
 #define BUFLEN 512
+#define SEGLEN (64*1024)
 
 
 /**
@@ -91,12 +92,33 @@ static inline struct acw_block_t acw_block(unsigned int bits, unsigned int len,
 }
 
 
+/**
+ * Parallel job structure.
+ *   @arr: The interleaved input.
+ *   @chan, len, nseg: The number of channels, length, and segments per
+ *     channel.
+ *   @next: The next segment to encode.
+ *   @enc: The finished encoder for each segment.
+ */
+struct enc_job_t {
+	const int32_t *arr;
+	unsigned int chan, len, nseg;
+	unsigned int next;
+
+	struct acw_encode_t **enc;
+};
+
+
 /*
  * local declarations
  */
 void enc_flush(struct acw_encode_t *enc);
 struct acw_block_t *enc_block(struct acw_encode_t *enc, unsigned int bits, struct acw_trial_t trial);
 
+static void enc_finish(struct acw_encode_t *enc);
+static struct acw_buf_t enc_build(struct acw_block_t *block, size_t nbytes);
+static void *enc_worker(void *arg);
+
 
 /**
  * Create an encoder.
@@ -130,50 +152,193 @@ void acw_encode_proc(struct acw_encode_t *enc, int *arr, unsigned int len)
 }
 
 /**
- * Finish encoding.
+ * Finish encoding. The buffer is a single channel of version 1.2, with the
+ * seek index stored after the block data, and an unknown rate.
  *   @enc: The enocder.
  *   &returns: The buffer.
  */
 struct acw_buf_t acw_encode_done(struct acw_encode_t *enc)
 {
-	struct acw_block_t *block;
+	struct acw_buf_t buf;
+
+	enc_finish(enc);
+	buf = enc_build(enc->block, enc->nbytes);
+	free(enc);
+
+	return buf;
+}
+
+
+/**
+ * Encode interleaved channels in parallel. Each channel is split into
+ * segments that are encoded independently by a pool of threads, and the
+ * blocks of the segments are joined into a single stream. Since every block
+ * stores its initial value, no state crosses a segment boundary; the result
+ * is valid but may differ slightly from a sequential encoding.
+ *   @arr: The interleaved input.
+ *   @chan: The number of channels.
+ *   @len: The length per channel.
+ *   @nthreads: The number of threads, including the caller.
+ *   &returns: The buffer.
+ */
+struct acw_buf_t acw_encode_par(const int32_t *arr, unsigned int chan, unsigned int len, unsigned int nthreads)
+{
+	size_t nbytes;
+	unsigned int i, c, s;
+	sys_thread_t *thread;
+	struct acw_buf_t buf[chan];
+	struct acw_block_t *block, **tail;
+	struct enc_job_t job;
+
+	if(nthreads == 0)
+		nthreads = 1;
+
+	thread = malloc(nthreads * sizeof(sys_thread_t));
+	job.arr = arr;
+	job.chan = chan;
+	job.len = len;
+	job.nseg = (len + SEGLEN - 1) / SEGLEN;
+	job.next = 0;
+	job.enc = malloc(chan * job.nseg * sizeof(struct acw_encode_t *));
+
+	for(i = 1; i < nthreads; i++)
+		thread[i] = sys_thread_create(0, enc_worker, &job);
+
+	enc_worker(&job);
+
+	for(i = 1; i < nthreads; i++)
+		sys_thread_join(&thread[i]);
+
+	free(thread);
+
+	for(c = 0; c < chan; c++) {
+		nbytes = 0;
+		tail = &block;
+
+		for(s = 0; s < job.nseg; s++) {
+			struct acw_encode_t *enc = job.enc[c * job.nseg + s];
+
+			*tail = enc->block;
+			if(enc->block != NULL)
+				tail = enc->tail;
+
+			nbytes += enc->nbytes;
+			free(enc);
+		}
+
+		*tail = NULL;
+		buf[c] = enc_build(block, nbytes);
+	}
+
+	free(job.enc);
 
+	return acw_buf_join(buf, chan);
+}
+
+
+/**
+ * Flush all buffered samples and terminate the block list.
+ *   @enc: The encoder.
+ */
+static void enc_finish(struct acw_encode_t *enc)
+{
 	while(enc->rd != enc->wr)
 		enc_flush(enc);
 
+	*enc->tail = NULL;
+}
+
+/**
+ * Build a buffer from a block list, freeing the blocks.
+ *   @block: The block list.
+ *   @nbytes: The number of bytes in the blocks.
+ *   &returns: The buffer.
+ */
+static struct acw_buf_t enc_build(struct acw_block_t *block, size_t nbytes)
+{
 	void *ptr;
+	uint32_t n = 0, next = 0, len = 0;
 	struct acw_buf_t buf;
+	struct acw_block_t *iter;
+	struct acw_index_t *index;
 
-	buf.raw = ptr = malloc(enc->nbytes += 2);
-	buf.info.nblocks = 0;
-	buf.info.length = 0;
-	buf.info.nbytes = enc->nbytes;
-	buf.info.magic = ACW_MAGIC_1_0;
+	for(iter = block; iter != NULL; iter = iter->next) {
+		if(len >= next)
+			n++, next = (len / ACW_INDEX_STEP + 1) * ACW_INDEX_STEP;
 
-	while(enc->block != NULL) {
-		block = enc->block;
-		enc->block = block->next;
+		len += iter->len;
+	}
+
+	nbytes += 2;
+	buf.raw = ptr = malloc(nbytes + 2 * sizeof(uint32_t) + n * sizeof(struct acw_index_t));
+	buf.map = 0;
+	buf.info = (struct acw_info_t){ ACW_MAGIC_1_2, nbytes, 0, 0, 0, 1, 24, 0 };
+
+	((uint32_t *)(buf.raw + nbytes))[0] = 0;
+	((uint32_t *)(buf.raw + nbytes))[1] = n;
+	index = buf.raw + nbytes + 2 * sizeof(uint32_t);
+	next = 0;
+
+	while(block != NULL) {
+		iter = block;
+		block = iter->next;
+
+		if(buf.info.length >= next) {
+			*index++ = (struct acw_index_t){ buf.info.length, ptr - buf.raw };
+			next = (buf.info.length / ACW_INDEX_STEP + 1) * ACW_INDEX_STEP;
+		}
 
 		buf.info.nblocks++;
-		buf.info.length += block->len;
+		buf.info.length += iter->len;
 
-		memcpy(ptr, block->raw, block->nbytes);
-		ptr += block->nbytes;
+		memcpy(ptr, iter->raw, iter->nbytes);
+		ptr += iter->nbytes;
 
-		free(block->raw);
-		free(block);
+		free(iter->raw);
+		free(iter);
 	}
 
 	*(uint16_t *)ptr = ACW_24BIT << 12;
 	ptr += 2;
 
-	assert((ptr - buf.raw) == enc->nbytes);
-
-	free(enc);
+	assert((ptr - buf.raw) == nbytes);
 
 	return buf;
 }
 
+/**
+ * Encode segments of a parallel job until none are left.
+ *   @arg: The job.
+ *   &returns: Null.
+ */
+static void *enc_worker(void *arg)
+{
+	int *tmp;
+	unsigned int i, k, c, off, len;
+	struct enc_job_t *job = arg;
+	struct acw_encode_t *enc;
+
+	tmp = malloc(SEGLEN * sizeof(int));
+
+	while((i = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED)) < (job->chan * job->nseg)) {
+		c = i / job->nseg;
+		off = (i % job->nseg) * SEGLEN;
+		len = m_min_u(SEGLEN, job->len - off);
+
+		for(k = 0; k < len; k++)
+			tmp[k] = job->arr[(off + k) * job->chan + c];
+
+		enc = acw_encode_new();
+		acw_encode_proc(enc, tmp, len);
+		enc_finish(enc);
+		job->enc[i] = enc;
+	}
+
+	free(tmp);
+
+	return NULL;
+}
+
 
 /**
  * Run a trial for encoding at a given bit width and offset.
@@ -301,7 +466,7 @@ struct acw_block_t *enc_block(struct acw_encode_t *enc, unsigned int bits, struc
 	switch(bits) {
 	case 24:
 		block->nbytes = 2 + 3 * block->len;
-		block->raw = raw = malloc(block->nbytes);
+		block->raw = raw = malloc(block->nbytes+1);
 
 		*(uint16_t *)raw = (ACW_24BIT << 12) | block->len;
 		raw += 2;
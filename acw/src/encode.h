@@ -8,4 +8,6 @@ struct acw_encode_t *acw_encode_new(void);
 void acw_encode_proc(struct acw_encode_t *enc, int *arr, unsigned int len);
 struct acw_buf_t acw_encode_done(struct acw_encode_t *enc);
 
+struct acw_buf_t acw_encode_par(const int32_t *arr, unsigned int chan, unsigned int len, unsigned int nthreads);
+
 #endif
@@ -1,5 +1,60 @@
 #include "common.h"
 
+#ifndef WINDOWS
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#endif
+#ifdef __SSE2__
+#	include <emmintrin.h>
+#endif
+#ifdef __AVX2__
+#	include <immintrin.h>
+#endif
+
+
+/*
+ * local declarations
+ */
+static void info_encode(void *raw, const struct acw_info_t *info);
+static void info_decode(struct acw_info_t *info, const void *raw);
+
+static char *buf_read(struct acw_buf_t *buf, const char *path);
+static bool buf_check(struct acw_buf_t buf, size_t size);
+
+static void dec_24(int32_t *restrict out, const uint8_t *restrict ptr, unsigned int n);
+static void dec_16(int32_t *restrict out, const int16_t *restrict ptr, unsigned int n, int init, int add);
+static void dec_8(int32_t *restrict out, const int8_t *restrict ptr, unsigned int n, int init, int add);
+static void dec_4(int32_t *restrict out, const uint8_t *restrict ptr, unsigned int n, int init, int add);
+
+
+/**
+ * Read the header from a file, converting headers before version 1.2.
+ *   @info: Out. The information.
+ *   @file: The file, positioned at the start.
+ *   @path: The path, used for errors.
+ *   &returns: Error.
+ */
+char *acw_info_read(struct acw_info_t *info, FILE *file, const char *path)
+{
+	uint8_t raw[sizeof(struct acw_info_t)];
+
+	if(fread(raw, 1, ACW_HEAD_1_0, file) < ACW_HEAD_1_0)
+		return mprintf("Failed to read from '%s'. %s.", path, ferror(file) ? strerror(errno) : "Truncated file");
+
+	if(!acw_magic_valid(*(uint64_t *)raw))
+		return mprintf("Invalid file '%s'. Expected ACW.", path);
+
+	if(acw_info_size(*(uint64_t *)raw) > ACW_HEAD_1_0) {
+		if(fread(raw + ACW_HEAD_1_0, 1, sizeof(struct acw_info_t) - ACW_HEAD_1_0, file) < (sizeof(struct acw_info_t) - ACW_HEAD_1_0))
+			return mprintf("Failed to read from '%s'. Truncated file.", path);
+	}
+
+	info_decode(info, raw);
+
+	return NULL;
+}
+
 
 /**
  * Load a buffer.
@@ -9,28 +64,68 @@
  */
 char *acw_buf_load(struct acw_buf_t *buf, const char *path)
 {
-#define onexit fclose(file);
-	FILE *file;
-	size_t nbytes;
+	return acw_buf_map(buf, path, 0);
+}
 
-	file = fopen(path, "r");
-	if(file == NULL)
+/**
+ * Map a buffer from a file. The raw data points into a shared, read-only
+ * mapping, so every process loading the file shares the same pages and pages
+ * are only read from disk once touched. The head of the file is hinted for
+ * immediate use, or the whole file is read up front when prefaulting. When
+ * mapping is not available, the file is read into memory instead.
+ *   @buf: Ref. The buffer.
+ *   @path: The path.
+ *   @flags: The mapping flags.
+ *   &returns: Error.
+ */
+char *acw_buf_map(struct acw_buf_t *buf, const char *path, unsigned int flags)
+{
+#ifndef WINDOWS
+	int fd;
+	void *map;
+	size_t i, size;
+	struct stat info;
+
+	fd = open(path, O_RDONLY);
+	if(fd < 0)
 		return mprintf("Unable to open '%s'. %s.", path, strerror(errno));
 
-	if(fread(&buf->info, sizeof(struct acw_info_t), 1, file) < 1)
-		fail("Failed to read from '%s'. %s.", path, strerror(errno));
+	if((fstat(fd, &info) < 0) || (info.st_size < ACW_HEAD_1_0))
+		return close(fd), buf_read(buf, path);
 
-	if(buf->info.magic != ACW_MAGIC_1_0)
-		fail("Invalid file '%s'. Expected ACW.", path);
+	size = info.st_size;
+	map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
 
-	buf->raw = malloc(nbytes = buf->info.nbytes);
-	if(fread(buf->raw, 1, nbytes, file) < nbytes)
-		fail("Failed to read from '%s'. %s.", path, strerror(errno));
+	if(map == MAP_FAILED)
+		return buf_read(buf, path);
 
-	fclose(file);
+	if(!acw_magic_valid(*(uint64_t *)map))
+		return munmap(map, size), mprintf("Invalid file '%s'. Expected ACW.", path);
+	else if(acw_info_size(*(uint64_t *)map) > size)
+		return munmap(map, size), mprintf("Failed to read from '%s'. Truncated file.", path);
+
+	info_decode(&buf->info, map);
+	buf->raw = map + acw_info_size(buf->info.magic);
+
+	if(!buf_check(*buf, size - acw_info_size(buf->info.magic)))
+		return munmap(map, size), mprintf("Failed to read from '%s'. Truncated file.", path);
+
+	if(flags & ACW_MAP_PREFAULT) {
+		madvise(map, size, MADV_WILLNEED);
+
+		for(i = 0; i < size; i += 4096)
+			(void)*(volatile uint8_t *)(map + i);
+	}
+	else
+		madvise(map, (size < ACW_MAP_HEAD) ? size : ACW_MAP_HEAD, MADV_WILLNEED);
+
+	buf->map = size;
 
 	return NULL;
-#undef onexit
+#else
+	return buf_read(buf, path);
+#endif
 }
 
 /**
@@ -42,13 +137,19 @@ char *acw_buf_load(struct acw_buf_t *buf, const char *path)
 char *acw_buf_save(struct acw_buf_t buf, const char *path)
 {
 	FILE *file;
+	uint8_t raw[sizeof(struct acw_info_t)];
 
 	file = fopen(path, "w");
 	if(file == NULL)
-		return mprintf("Unable to open '%s' for writing.");
+		return mprintf("Unable to open '%s' for writing.", path);
+
+	info_encode(raw, &buf.info);
+	fwrite(raw, 1, acw_info_size(buf.info.magic), file);
+	fwrite(buf.raw, buf.info.nbytes + acw_buf_extra(buf), 1, file);
+
+	if(ferror(file))
+		return fclose(file), mprintf("Failed to write '%s'. %s.", path, strerror(errno));
 
-	fwrite(&buf.info, 1, sizeof(struct acw_info_t), file);
-	fwrite(buf.raw, buf.info.nbytes, 1, file);
 	fclose(file);
 
 	return NULL;
@@ -60,7 +161,12 @@ char *acw_buf_save(struct acw_buf_t buf, const char *path)
  */
 void acw_buf_delete(struct acw_buf_t buf)
 {
-	free(buf.raw);
+#ifndef WINDOWS
+	if(buf.map > 0)
+		munmap(buf.raw - acw_info_size(buf.info.magic), buf.map);
+	else
+#endif
+		free(buf.raw);
 }
 
 
@@ -80,28 +186,501 @@ struct acw_buf_t acw_buf_enc32(int32_t *arr, unsigned int len)
 	return acw_encode_done(enc);
 }
 
+/**
+ * Directly encode interleaved channels from a 32-bit buffer.
+ *   @arr: The interleaved array.
+ *   @chan: The number of channels.
+ *   @len: The length per channel.
+ *   &returns: The buffer.
+ */
+struct acw_buf_t acw_buf_enc32n(const int32_t *arr, unsigned int chan, unsigned int len)
+{
+	int32_t *tmp;
+	unsigned int i, c;
+	struct acw_buf_t buf, part[chan];
+
+	tmp = malloc(len * sizeof(int32_t));
+
+	for(c = 0; c < chan; c++) {
+		for(i = 0; i < len; i++)
+			tmp[i] = arr[i * chan + c];
+
+		part[c] = acw_buf_enc32(tmp, len);
+	}
+
+	free(tmp);
+	buf = acw_buf_join(part, chan);
+
+	return buf;
+}
+
+/**
+ * Join single channel buffers into a multichannel buffer. The buffers must
+ * have the same length; the rate is taken from the first.
+ *   @buf: Consumed. The buffer array.
+ *   @chan: The number of channels.
+ *   &returns: The buffer.
+ */
+struct acw_buf_t acw_buf_join(struct acw_buf_t *buf, unsigned int chan)
+{
+	void *ptr;
+	uint32_t i, c, n, *off;
+	size_t extra;
+	struct acw_buf_t join;
+	const struct acw_index_t *index;
+
+	if(chan == 1)
+		return buf[0];
+
+	join.info = (struct acw_info_t){ ACW_MAGIC_1_2, 0, 0, buf[0].info.length, buf[0].info.rate, chan, 24, 0 };
+	join.map = 0;
+	extra = chan * sizeof(uint32_t);
+
+	for(c = 0; c < chan; c++) {
+		assert(buf[c].info.length == join.info.length);
+
+		acw_buf_index(buf[c], 0, &n);
+		join.info.nbytes += buf[c].info.nbytes;
+		join.info.nblocks += buf[c].info.nblocks;
+		extra += sizeof(uint32_t) + n * sizeof(struct acw_index_t);
+	}
+
+	join.raw = malloc(join.info.nbytes + extra);
+	off = join.raw + join.info.nbytes;
+	ptr = off + chan;
+
+	for(c = 0, off[0] = 0; c < chan; c++) {
+		memcpy(join.raw + off[c], acw_buf_chan(buf[c], 0), buf[c].info.nbytes);
+		if((c + 1) < chan)
+			off[c + 1] = off[c] + buf[c].info.nbytes;
+
+		index = acw_buf_index(buf[c], 0, &n);
+		*(uint32_t *)ptr = n;
+		ptr += sizeof(uint32_t);
+
+		for(i = 0; i < n; i++, ptr += sizeof(struct acw_index_t))
+			*(struct acw_index_t *)ptr = (struct acw_index_t){ index[i].sample, index[i].offset + off[c] };
+
+		acw_buf_delete(buf[c]);
+	}
+
+	return join;
+}
+
 
 /**
- * Read PCM data from a buffer.
+ * Read PCM data from a buffer, interleaving the channels.
  *   @buf: The buffer.
  *   &returns: The PCM array.
  */
 int32_t *acw_buf_pcm32(struct acw_buf_t buf)
 {
-	int32_t *arr;
-	unsigned int i;
+	int32_t *arr, tmp[256];
+	unsigned int i, j, c, n;
 	struct acw_play_t play;
 
-	play = acw_play_init(buf.raw);
-	arr = malloc(sizeof(int32_t) * buf.info.length);
+	arr = malloc(sizeof(int32_t) * buf.info.length * buf.info.chan);
 
-	for(i = 0; i < buf.info.length; i++)
-		arr[i] = acw_play_next(&play);
+	if(buf.info.chan == 1) {
+		play = acw_play_init(buf.raw);
+		acw_play_read(&play, arr, buf.info.length);
+
+		return arr;
+	}
+
+	for(c = 0; c < buf.info.chan; c++) {
+		play = acw_play_init(acw_buf_chan(buf, c));
+
+		for(i = 0; i < buf.info.length; i += n) {
+			n = acw_play_read(&play, tmp, m_min_u(256, buf.info.length - i));
+			if(n == 0)
+				break;
+
+			for(j = 0; j < n; j++)
+				arr[(i + j) * buf.info.chan + c] = tmp[j];
+		}
+	}
 
 	return arr;
 }
 
 
+/**
+ * Read a buffer into memory.
+ *   @buf: Ref. The buffer.
+ *   @path: The path.
+ *   &returns: Error.
+ */
+static char *buf_read(struct acw_buf_t *buf, const char *path)
+{
+#define onexit fclose(file); free(buf->raw);
+	FILE *file;
+	long size;
+
+	file = fopen(path, "r");
+	if(file == NULL)
+		return mprintf("Unable to open '%s'. %s.", path, strerror(errno));
+
+	buf->raw = NULL;
+	buf->map = 0;
+
+	chkfail(acw_info_read(&buf->info, file, path));
+
+	if((fseek(file, 0, SEEK_END) < 0) || ((size = ftell(file)) < 0) || (fseek(file, acw_info_size(buf->info.magic), SEEK_SET) < 0))
+		fail("Failed to read from '%s'. %s.", path, strerror(errno));
+
+	size -= acw_info_size(buf->info.magic);
+	buf->raw = malloc(size);
+	if(fread(buf->raw, 1, size, file) < (size_t)size)
+		fail("Failed to read from '%s'. %s.", path, strerror(errno));
+
+	if(!buf_check(*buf, size))
+		fail("Failed to read from '%s'. Truncated file.", path);
+
+	fclose(file);
+
+	return NULL;
+#undef onexit
+}
+
+/**
+ * Check that the block data and index of a buffer fit within the data read
+ * from the file.
+ *   @buf: The buffer.
+ *   @size: The number of bytes following the header.
+ *   &returns: True if valid.
+ */
+static bool buf_check(struct acw_buf_t buf, size_t size)
+{
+	uint32_t c, n;
+	size_t off;
+
+	if(buf.info.nbytes > size)
+		return false;
+
+	switch(buf.info.magic) {
+	case ACW_MAGIC_1_0:
+		return true;
+
+	case ACW_MAGIC_1_1:
+		off = buf.info.nbytes;
+		break;
+
+	case ACW_MAGIC_1_2:
+		if((buf.info.chan == 0) || ((buf.info.nbytes + buf.info.chan * sizeof(uint32_t)) > size))
+			return false;
+
+		for(c = 0; c < buf.info.chan; c++) {
+			if(((const uint32_t *)(buf.raw + buf.info.nbytes))[c] >= buf.info.nbytes)
+				return false;
+		}
+
+		off = buf.info.nbytes + buf.info.chan * sizeof(uint32_t);
+		break;
+
+	default:
+		return false;
+	}
+
+	for(c = 0; c < buf.info.chan; c++) {
+		if((off + sizeof(uint32_t)) > size)
+			return false;
+
+		n = *(const uint32_t *)(buf.raw + off);
+		off += sizeof(uint32_t) + (size_t)n * sizeof(struct acw_index_t);
+		if(off > size)
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * Encode a header as stored in a file.
+ *   @raw: Out. The raw header.
+ *   @info: The information.
+ */
+static void info_encode(void *raw, const struct acw_info_t *info)
+{
+	if(info->magic == ACW_MAGIC_1_2) {
+		memcpy(raw, info, sizeof(struct acw_info_t));
+
+		return;
+	}
+
+	memcpy(raw, info, 20);
+	*(uint16_t *)(raw + 20) = info->rate;
+	*(uint16_t *)(raw + 22) = info->bits;
+}
+
+/**
+ * Decode a header as stored in a file.
+ *   @info: Out. The information.
+ *   @raw: The raw header.
+ */
+static void info_decode(struct acw_info_t *info, const void *raw)
+{
+	if(*(const uint64_t *)raw == ACW_MAGIC_1_2) {
+		memcpy(info, raw, sizeof(struct acw_info_t));
+
+		return;
+	}
+
+	memcpy(info, raw, 20);
+	info->rate = *(const uint16_t *)(raw + 20);
+	info->bits = *(const uint16_t *)(raw + 22);
+	info->chan = 1;
+	info->rsvd = 0;
+}
+
+
+/**
+ * Create a player positioned at a sample. The index is searched for the last
+ * entry at or before the position, and the remaining samples are decoded and
+ * discarded; without an index, decoding starts from the beginning.
+ *   @buf: The buffer.
+ *   @chan: The channel.
+ *   @pos: The sample position.
+ *   &returns: The player.
+ */
+struct acw_play_t acw_play_seek(struct acw_buf_t buf, unsigned int chan, uint32_t pos)
+{
+	uint32_t n, lo, hi, mid, skip, off;
+	struct acw_play_t play;
+	const struct acw_index_t *index;
+
+	skip = pos;
+	off = acw_buf_chan(buf, chan) - buf.raw;
+
+	index = acw_buf_index(buf, chan, &n);
+	if(n > 0) {
+		lo = 0;
+		hi = n;
+		while((hi - lo) > 1) {
+			mid = lo + (hi - lo) / 2;
+			if(index[mid].sample <= pos)
+				lo = mid;
+			else
+				hi = mid;
+		}
+
+		if(index[lo].sample <= pos) {
+			skip = pos - index[lo].sample;
+			off = index[lo].offset;
+		}
+	}
+
+	play = acw_play_init(buf.raw + off);
+	while((skip-- > 0) && !acw_play_eos(&play))
+		acw_play_next(&play);
+
+	return play;
+}
+
+
+/**
+ * Decode samples from a player into a buffer. Whole runs of each block are
+ * unpacked at once, so the result matches repeated calls to 'acw_play_next'.
+ *   @play: The player.
+ *   @buf: The output buffer.
+ *   @len: The number of samples requested.
+ *   &returns: The number of samples decoded, less than requested only at the
+ *     end of stream.
+ */
+unsigned int acw_play_read(struct acw_play_t *play, int32_t *buf, unsigned int len)
+{
+	unsigned int i = 0, n;
+
+	while((i < len) && (play->ptr != NULL)) {
+		if(play->len == 0) {
+			acw_play_block(play);
+
+			if(play->bits == 24) {
+				if(play->len == 0) {
+					play->ptr = NULL;
+					break;
+				}
+			}
+			else {
+				buf[i++] = play->init;
+				continue;
+			}
+		}
+
+		if((play->bits == 4) && (play->frac != 0)) {
+			buf[i++] = acw_play_next(play);
+			continue;
+		}
+
+		n = m_min_u(play->len, len - i);
+
+		switch(play->bits) {
+		case 24:
+			dec_24(buf + i, play->ptr, n);
+			play->ptr += 3 * n;
+			break;
+
+		case 16:
+			dec_16(buf + i, play->ptr, n, play->init, play->add);
+			play->ptr += 2 * n;
+			break;
+
+		case 8:
+			dec_8(buf + i, play->ptr, n, play->init, play->add);
+			play->ptr += n;
+			break;
+
+		case 4:
+			dec_4(buf + i, play->ptr, n, play->init, play->add);
+			play->ptr += (n + 1) / 2;
+			play->frac = n % 2;
+			break;
+
+		default:
+			fatal("Invalid bit width.");
+		}
+
+		play->init += (int)n * play->add;
+		play->len -= n;
+		i += n;
+	}
+
+	return i;
+}
+
+
+/**
+ * Decode a run of 24-bit samples.
+ *   @out: The output.
+ *   @ptr: The packed samples.
+ *   @n: The number of samples.
+ */
+static void dec_24(int32_t *restrict out, const uint8_t *restrict ptr, unsigned int n)
+{
+	unsigned int i;
+
+	for(i = 0; i < n; i++, ptr += 3)
+		out[i] = acw_ext(ptr[0] | (ptr[1] << 8) | (ptr[2] << 16), 24);
+}
+
+/**
+ * Decode a run of 16-bit residuals.
+ *   @out: The output.
+ *   @ptr: The residuals.
+ *   @n: The number of samples.
+ *   @init, add: The initial and addend values.
+ */
+static void dec_16(int32_t *restrict out, const int16_t *restrict ptr, unsigned int n, int init, int add)
+{
+	unsigned int i = 0;
+
+#if defined(__AVX2__)
+	__m256i base = _mm256_add_epi32(_mm256_set1_epi32(init), _mm256_mullo_epi32(_mm256_set1_epi32(add), _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 8)));
+	__m256i step = _mm256_set1_epi32(8 * add);
+
+	for(; i + 8 <= n; i += 8) {
+		_mm256_storeu_si256((__m256i *)(out + i), _mm256_add_epi32(base, _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(ptr + i)))));
+		base = _mm256_add_epi32(base, step);
+	}
+#elif defined(__SSE2__)
+	__m128i base = _mm_setr_epi32(init + add, init + 2 * add, init + 3 * add, init + 4 * add);
+	__m128i step = _mm_set1_epi32(4 * add);
+
+	for(; i + 8 <= n; i += 8) {
+		__m128i v;
+
+		v = _mm_loadu_si128((const __m128i *)(ptr + i));
+		_mm_storeu_si128((__m128i *)(out + i + 0), _mm_add_epi32(base, _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)));
+		base = _mm_add_epi32(base, step);
+		_mm_storeu_si128((__m128i *)(out + i + 4), _mm_add_epi32(base, _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)));
+		base = _mm_add_epi32(base, step);
+	}
+#endif
+
+	for(init += i * add; i < n; i++)
+		out[i] = (init += add) + ptr[i];
+}
+
+/**
+ * Decode a run of 8-bit residuals.
+ *   @out: The output.
+ *   @ptr: The residuals.
+ *   @n: The number of samples.
+ *   @init, add: The initial and addend values.
+ */
+static void dec_8(int32_t *restrict out, const int8_t *restrict ptr, unsigned int n, int init, int add)
+{
+	unsigned int i = 0;
+
+#if defined(__AVX2__)
+	__m256i base = _mm256_add_epi32(_mm256_set1_epi32(init), _mm256_mullo_epi32(_mm256_set1_epi32(add), _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 8)));
+	__m256i step = _mm256_set1_epi32(8 * add);
+
+	for(; i + 8 <= n; i += 8) {
+		_mm256_storeu_si256((__m256i *)(out + i), _mm256_add_epi32(base, _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *)(ptr + i)))));
+		base = _mm256_add_epi32(base, step);
+	}
+#elif defined(__SSE2__)
+	__m128i base = _mm_setr_epi32(init + add, init + 2 * add, init + 3 * add, init + 4 * add);
+	__m128i step = _mm_set1_epi32(4 * add);
+
+	for(; i + 8 <= n; i += 8) {
+		__m128i v;
+
+		v = _mm_loadl_epi64((const __m128i *)(ptr + i));
+		v = _mm_unpacklo_epi8(v, v);
+		_mm_storeu_si128((__m128i *)(out + i + 0), _mm_add_epi32(base, _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 24)));
+		base = _mm_add_epi32(base, step);
+		_mm_storeu_si128((__m128i *)(out + i + 4), _mm_add_epi32(base, _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 24)));
+		base = _mm_add_epi32(base, step);
+	}
+#endif
+
+	for(init += i * add; i < n; i++)
+		out[i] = (init += add) + ptr[i];
+}
+
+/**
+ * Decode a run of 4-bit residuals, starting on a byte boundary. Each byte
+ * holds two residuals, low nibble first.
+ *   @out: The output.
+ *   @ptr: The residuals.
+ *   @n: The number of samples.
+ *   @init, add: The initial and addend values.
+ */
+static void dec_4(int32_t *restrict out, const uint8_t *restrict ptr, unsigned int n, int init, int add)
+{
+	unsigned int i = 0;
+
+#ifdef __SSE2__
+	__m128i base = _mm_setr_epi32(init + add, init + 2 * add, init + 3 * add, init + 4 * add);
+	__m128i step = _mm_set1_epi32(4 * add);
+	__m128i mask = _mm_set1_epi8(0x0F);
+
+	for(; i + 16 <= n; i += 16) {
+		__m128i v, lo, hi;
+
+		v = _mm_loadl_epi64((const __m128i *)(ptr + i / 2));
+		v = _mm_unpacklo_epi8(_mm_and_si128(v, mask), _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+		lo = _mm_unpacklo_epi8(v, v);
+		hi = _mm_unpackhi_epi8(v, v);
+
+		_mm_storeu_si128((__m128i *)(out + i + 0), _mm_add_epi32(base, _mm_srai_epi32(_mm_slli_epi32(_mm_unpacklo_epi16(lo, lo), 28), 28)));
+		base = _mm_add_epi32(base, step);
+		_mm_storeu_si128((__m128i *)(out + i + 4), _mm_add_epi32(base, _mm_srai_epi32(_mm_slli_epi32(_mm_unpackhi_epi16(lo, lo), 28), 28)));
+		base = _mm_add_epi32(base, step);
+		_mm_storeu_si128((__m128i *)(out + i + 8), _mm_add_epi32(base, _mm_srai_epi32(_mm_slli_epi32(_mm_unpacklo_epi16(hi, hi), 28), 28)));
+		base = _mm_add_epi32(base, step);
+		_mm_storeu_si128((__m128i *)(out + i + 12), _mm_add_epi32(base, _mm_srai_epi32(_mm_slli_epi32(_mm_unpackhi_epi16(hi, hi), 28), 28)));
+		base = _mm_add_epi32(base, step);
+	}
+#endif
+
+	for(init += i * add; i < n; i++)
+		out[i] = (init += add) + acw_ext((ptr[i / 2] >> (4 * (i % 2))) & 0x0F, 4);
+}
+
+
 /**
  * Load raw data from the path.
  *   @path: The path.
@@ -110,6 +689,7 @@ int32_t *acw_buf_pcm32(struct acw_buf_t buf)
  */
 void *acw_load_raw(const char *path, struct acw_info_t *info)
 {
+	char *err;
 	void *raw;
 	FILE *file;
 	struct acw_info_t sinfo;
@@ -121,8 +701,9 @@ void *acw_load_raw(const char *path, struct acw_info_t *info)
 	if(file == NULL)
 		return NULL;
 
-	if(fread(info, sizeof(struct acw_info_t), 1, file) < 1)
-		return fclose(file), NULL;
+	err = acw_info_read(info, file, path);
+	if(err != NULL)
+		return free(err), fclose(file), NULL;
 
 	raw = malloc(info->nbytes);
 
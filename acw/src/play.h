@@ -1,17 +1,91 @@
 #ifndef PLAY_H
 #define PLAY_H
 
+/*
+ * information declarations
+ */
+char *acw_info_read(struct acw_info_t *info, FILE *file, const char *path);
+
 /*
  * buffer declarations
  */
 char *acw_buf_load(struct acw_buf_t *buf, const char *path);
+char *acw_buf_map(struct acw_buf_t *buf, const char *path, unsigned int flags);
 char *acw_buf_save(struct acw_buf_t buf, const char *path);
 void acw_buf_delete(struct acw_buf_t buf);
 
 struct acw_buf_t acw_buf_enc32(int32_t *arr, unsigned int len);
+struct acw_buf_t acw_buf_enc32n(const int32_t *arr, unsigned int chan, unsigned int len);
+struct acw_buf_t acw_buf_join(struct acw_buf_t *buf, unsigned int chan);
 
 int32_t *acw_buf_pcm32(struct acw_buf_t buf);
 
+/**
+ * Retrieve the start of a channel's block data.
+ *   @buf: The buffer.
+ *   @chan: The channel.
+ *   &returns: The block pointer.
+ */
+static inline void *acw_buf_chan(struct acw_buf_t buf, unsigned int chan)
+{
+	if(buf.info.magic != ACW_MAGIC_1_2)
+		return buf.raw;
+
+	return buf.raw + ((const uint32_t *)(buf.raw + buf.info.nbytes))[chan];
+}
+
+/**
+ * Retrieve the seek index of a channel.
+ *   @buf: The buffer.
+ *   @chan: The channel.
+ *   @n: Out. The number of entries.
+ *   &returns: The index, or null if the buffer has no index.
+ */
+static inline const struct acw_index_t *acw_buf_index(struct acw_buf_t buf, unsigned int chan, uint32_t *n)
+{
+	unsigned int i;
+	const void *ptr;
+
+	switch(buf.info.magic) {
+	case ACW_MAGIC_1_1:
+		ptr = buf.raw + buf.info.nbytes;
+		break;
+
+	case ACW_MAGIC_1_2:
+		ptr = buf.raw + buf.info.nbytes + buf.info.chan * sizeof(uint32_t);
+		for(i = 0; i < chan; i++)
+			ptr += sizeof(uint32_t) + *(const uint32_t *)ptr * sizeof(struct acw_index_t);
+
+		break;
+
+	default:
+		*n = 0;
+
+		return NULL;
+	}
+
+	*n = *(const uint32_t *)ptr;
+
+	return ptr + sizeof(uint32_t);
+}
+
+/**
+ * Compute the number of bytes stored after the block data.
+ *   @buf: The buffer.
+ *   &returns: The size in bytes.
+ */
+static inline size_t acw_buf_extra(struct acw_buf_t buf)
+{
+	uint32_t n;
+	const struct acw_index_t *index;
+
+	index = acw_buf_index(buf, buf.info.chan - 1, &n);
+	if(index == NULL)
+		return 0;
+
+	return (const void *)(index + n) - (buf.raw + buf.info.nbytes);
+}
+
 
 /*
  * loading declarations
@@ -60,6 +134,39 @@ static inline void acw_play_block(struct acw_play_t *play)
 	}
 }
 
+/**
+ * Compute the size of a block from its header. Only the first two bytes are
+ * read for 24-bit blocks, otherwise the first six.
+ *   @ptr: The block pointer.
+ *   @nsamp: Out. Optional. The number of samples in the block.
+ *   &returns: The size in bytes, or zero if the format is not supported.
+ */
+static inline unsigned int acw_block_size(const void *ptr, unsigned int *nsamp)
+{
+	uint16_t info;
+	unsigned int len;
+
+	info = *(const uint16_t *)ptr;
+	if((info >> 12) == ACW_24BIT) {
+		len = info & 0x0FFF;
+		if(nsamp != NULL)
+			*nsamp = len;
+
+		return 2 + 3 * len;
+	}
+
+	len = *(const uint8_t *)(ptr + 5);
+	if(nsamp != NULL)
+		*nsamp = len + 1;
+
+	switch(info >> 12) {
+	case ACW_16BIT: return 6 + 2 * len;
+	case ACW_8BIT: return 6 + len;
+	case ACW_4BIT: return 6 + (len + 1) / 2;
+	default: return 0;
+	}
+}
+
 
 /**
  * Initialize a player on memory.
@@ -157,4 +264,11 @@ static inline bool acw_play_eos(struct acw_play_t *play)
 	return play->ptr == NULL;
 }
 
+
+/*
+ * player declarations
+ */
+struct acw_play_t acw_play_seek(struct acw_buf_t buf, unsigned int chan, uint32_t pos);
+unsigned int acw_play_read(struct acw_play_t *play, int32_t *buf, unsigned int len);
+
 #endif
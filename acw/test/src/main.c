@@ -9,8 +9,10 @@
  */
 int main(int argc, char **argv)
 {
-	unsigned int i;
-	int *arr, *cmp;
+	unsigned int i, j, n;
+	int32_t chunk[97];
+	int *arr, *cmp, *inter;
+	struct acw_play_t play;
 	SNDFILE *file;
 	SF_INFO info;
 	struct acw_buf_t buf;
@@ -42,8 +44,88 @@ int main(int argc, char **argv)
 			fatal("Input and ACW differ on input #%u.\n", i);
 	}
 
+	free(cmp);
+
+	play = acw_play_init(buf.raw);
+	for(i = 0, j = 1; i < info.frames; i += n, j = (j * 7 + 3) % 97 + 1) {
+		n = acw_play_read(&play, chunk, j);
+		if((n == 0) || ((i + n) > info.frames) || (memcmp(chunk, arr + i, n * sizeof(int)) != 0))
+			fatal("Input and ACW differ on block read at #%u.\n", i);
+	}
+
+	if((acw_play_read(&play, chunk, 1) != 0) || !acw_play_eos(&play))
+		fatal("ACW block read past the end.");
+
+	chkexit(acw_buf_save(buf, "test.acw"));
+	acw_buf_delete(buf);
+
+	chkexit(acw_buf_map(&buf, "test.acw", ACW_MAP_PREFAULT));
+	cmp = acw_buf_pcm32(buf);
+	unlink("test.acw");
+
+	if(buf.info.length != info.frames)
+		fatal("Input and mapped ACW differ on length.");
+
+	for(i = 0; i < info.frames; i++) {
+		if(arr[i] != cmp[i])
+			fatal("Input and mapped ACW differ on input #%u.\n", i);
+	}
+
+	for(i = 0; i < info.frames; i += 997) {
+		play = acw_play_seek(buf, 0, i);
+
+		for(j = i; (j < info.frames) && (j < (i + 64)); j++) {
+			if(arr[j] != acw_play_next(&play))
+				fatal("Input and ACW differ after seeking to #%u.\n", i);
+		}
+	}
+
+	free(cmp);
+	acw_buf_delete(buf);
+
+	inter = malloc(2 * info.frames * sizeof(int));
+	for(i = 0; i < info.frames; i++) {
+		inter[2*i+0] = arr[i];
+		inter[2*i+1] = -arr[info.frames - i - 1];
+	}
+
+	buf = acw_encode_par(inter, 2, info.frames, 4);
+	cmp = acw_buf_pcm32(buf);
+
+	for(i = 0; i < 2 * info.frames; i++) {
+		if(inter[i] != cmp[i])
+			fatal("Input and parallel ACW differ on input #%u.\n", i);
+	}
+
+	free(cmp);
+	acw_buf_delete(buf);
+
+	buf = acw_buf_enc32n(inter, 2, info.frames);
+	buf.info.rate = 96000;
+	chkexit(acw_buf_save(buf, "test.acw"));
+	acw_buf_delete(buf);
+
+	chkexit(acw_buf_load(&buf, "test.acw"));
+	cmp = acw_buf_pcm32(buf);
+	unlink("test.acw");
+
+	if((buf.info.chan != 2) || (buf.info.rate != 96000) || (buf.info.length != info.frames))
+		fatal("Input and stereo ACW differ on format.");
+
+	for(i = 0; i < 2 * info.frames; i++) {
+		if(inter[i] != cmp[i])
+			fatal("Input and stereo ACW differ on input #%u.\n", i);
+	}
+
+	for(i = 0; i < info.frames; i += 997) {
+		play = acw_play_seek(buf, 1, i);
+		if(inter[2*i+1] != acw_play_next(&play))
+			fatal("Input and stereo ACW differ after seeking to #%u.\n", i);
+	}
+
 	free(arr);
 	free(cmp);
+	free(inter);
 	acw_buf_delete(buf);
 
 	if(hax_memcnt > 0)
@@ -0,0 +1,11 @@
+(* fdn.ml
+ *   Feedback delay network benchmark: the voices of the reverb benchmark
+ *   through a single eight line network in place of the filter chain.
+ *)
+
+let voice = Mul([ADSR'(0.005,0.1,0.4,0.2), Sine'(330)])
+
+let amp.instr = Splice(Chain([
+	Gen(Synth(0,8,voice)),
+	Fdn(8,0.05,2.0,6000)
+]))
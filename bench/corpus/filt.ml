@@ -0,0 +1,19 @@
+(* filt.ml
+ *   Filter benchmark: synthesizer voices and noise through a chain of static
+ *   and modulated filters.
+ *)
+
+let voice = Mul([ADSR'(0.01,0.2,0.6,0.3), Sine'(220)])
+let sweep = SineScale'(0.5,400,4000)
+
+let amp.instr = Splice(Chain([
+	Gen(Synth(0,8,voice)),
+	Gen(Noise()),
+	Lpf(sweep),
+	Hpf(80),
+	Lpf2(6000),
+	Hpf2(40),
+	Moog(1200,0.5),
+	Peak(1000,6,0.7),
+	Svlpf(3000,0.7)
+]))
@@ -0,0 +1,13 @@
+(* mixer.ml
+ *   Mixer benchmark: four independent branches mixed together, exercising the
+ *   parallel mixer.
+ *)
+
+let voice f = Mul([ADSR'(0.01,0.2,0.5,0.3), Sine'(f)])
+
+let amp.instr = Mixer([
+	Splice(Chain([Gen(Synth(0,8,voice 220)), Lpf(2000), Comb(0.031,0.6)])),
+	Splice(Chain([Gen(Synth(0,8,voice 440)), Hpf(200), Allpass(0.005,0.7)])),
+	Splice(Chain([Gen(Noise()), Lpf(SineScale'(0.25,300,3000)), Gain(0.2)])),
+	Splice(Chain([Gen(Synth(0,4,voice 110)), Moog(800,0.3), Comb(0.043,0.5)]))
+])
@@ -0,0 +1,7 @@
+(* piano.ml
+ *   Piano benchmark: one synthetic tone per key over the scripted key range.
+ *)
+
+let tone k = if (k < 48) then () else [[bench.dir ++ "/key" ++ val2str(k) ++ ".acw"]]
+
+let amp.instr = Splice(Gen(Piano(0,map tone (seq(85)),())))
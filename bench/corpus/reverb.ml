@@ -0,0 +1,17 @@
+(* reverb.ml
+ *   Reverb benchmark: synthesizer voices through a Schroeder style network of
+ *   comb and allpass filters.
+ *)
+
+let voice = Mul([ADSR'(0.005,0.1,0.4,0.2), Sine'(330)])
+
+let amp.instr = Splice(Chain([
+	Gen(Synth(0,8,voice)),
+	Comb(0.0297,0.77),
+	Comb(0.0371,0.80),
+	Comb(0.0411,0.73),
+	Comb(0.0437,0.71),
+	Allpass(0.0050,0.7),
+	Allpass(0.0017,0.7),
+	LpcfV(0.06,0.06,0.5,3000)
+]))
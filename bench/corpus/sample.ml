@@ -0,0 +1,11 @@
+(* sample.ml
+ *   Sample benchmark: two velocity layers of round-robin hits from the
+ *   synthetic sample set, triggered by every scripted note.
+ *)
+
+let hit v r = bench.dir ++ "/hit" ++ val2str(v) ++ val2str(r) ++ ".acw"
+
+let amp.instr = Splice(Chain([
+	Gen(Sample(16,0.9995,[[hit 0 0, hit 0 1],[hit 1 0, hit 1 1]])),
+	Lpf(8000)
+]))
@@ -0,0 +1,17 @@
+#ifndef COMMON_H
+#define COMMON_H
+
+/*
+ * common headers
+ */
+#include "config.h"
+
+#include <hax.h>
+#include <libdsp.h>
+#include <muselang.h>
+#include <acw.h>
+#include <amplib.h>
+
+#include "inc.h"
+
+#endif
@@ -0,0 +1,425 @@
+#include "common.h"
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+
+
+/**
+ * Benchmark configuration structure.
+ *   @rate, len: The sample rate and block length.
+ *   @secs, warm: The measured and warm-up lengths in seconds.
+ *   @notes: The number of scripted notes per second.
+ *   @dev: The device of the scripted notes.
+ */
+struct bench_conf_t {
+	unsigned int rate, len;
+	double secs, warm, notes;
+	unsigned int dev;
+};
+
+/**
+ * Benchmark result structure. Times are in nanoseconds.
+ *   @samples: The number of measured samples.
+ *   @total: The total processing time.
+ *   @p50, p99, max: The block processing time percentiles.
+ *   @rms: The RMS of the left channel, used to detect changes in output.
+ *   @rss: The peak resident set size of the patch process in KiB.
+ *   @underrun: The number of streamed samples not ready in time.
+ */
+struct bench_res_t {
+	uint64_t samples;
+	uint64_t total, p50, p99, max;
+	double rms;
+	long rss;
+	uint64_t underrun;
+};
+
+
+/*
+ * local declarations
+ */
+static void bench_conf(struct bench_conf_t *conf, const char *str);
+static void bench_fork(struct bench_res_t *res, const char *path, const char *dir, const struct bench_conf_t *conf);
+static void bench_run(struct bench_res_t *res, const char *path, const char *dir, const struct bench_conf_t *conf);
+
+static uint64_t bench_nsec(void);
+static int bench_cmp(const void *left, const void *right);
+static void bench_json(FILE *file, const char *str);
+
+static char *optlong(char ***arg, const char *opt);
+
+
+/**
+ * Main entry point.
+ *   @argc: The number of arguments.
+ *   @argv: The argument array.
+ *   &returns: The exit code.
+ */
+int main(int argc, char **argv)
+{
+	FILE *file;
+	unsigned int i, n = 0;
+	char **arg, *val, *conf = NULL, *output = NULL, **patch, dir[256];
+	struct bench_conf_t bench;
+	struct bench_res_t *res;
+
+	patch = malloc(argc * sizeof(char *));
+
+	for(arg = argv + 1; *arg != NULL; arg++) {
+		if((*arg)[0] != '-')
+			patch[n++] = *arg;
+		else if((val = optlong(&arg, "--conf")) != NULL)
+			conf = val;
+		else if((val = optlong(&arg, "--output")) != NULL)
+			output = val;
+		else
+			fprintf(stderr, "Unknown option '%s'.\n", *arg), exit(1);
+	}
+
+	if(n == 0)
+		fprintf(stderr, "Missing patch file.\n"), exit(1);
+
+	bench_conf(&bench, conf);
+
+	snprintf(dir, sizeof(dir), "%s/amp-bench.XXXXXX", getenv("TMPDIR") ?: "/tmp");
+	if(mkdtemp(dir) == NULL)
+		fprintf(stderr, "Cannot create '%s'. %s.\n", dir, strerror(errno)), exit(1);
+
+	chkexit(bench_synth_new(dir));
+
+	res = malloc(n * sizeof(struct bench_res_t));
+
+	for(i = 0; i < n; i++) {
+		bench_fork(&res[i], patch[i], dir, &bench);
+		fprintf(stderr, "%s: %.2f ns/sample, %.1fx realtime\n", patch[i], (double)res[i].total / res[i].samples, (1e9 * res[i].samples / bench.rate) / res[i].total);
+	}
+
+	bench_synth_delete(dir);
+
+	if(output != NULL) {
+		file = fopen(output, "w");
+		if(file == NULL)
+			fprintf(stderr, "Cannot write '%s'. %s.\n", output, strerror(errno)), exit(1);
+	}
+	else
+		file = stdout;
+
+	fprintf(file, "{\n");
+	fprintf(file, "  \"version\": 1,\n");
+#if DSP_FLOAT
+	fprintf(file, "  \"precision\": \"single\",\n");
+#else
+	fprintf(file, "  \"precision\": \"double\",\n");
+#endif
+	fprintf(file, "  \"rate\": %u,\n", bench.rate);
+	fprintf(file, "  \"block\": %u,\n", bench.len);
+	fprintf(file, "  \"secs\": %g,\n", bench.secs);
+	fprintf(file, "  \"warmup\": %g,\n", bench.warm);
+	fprintf(file, "  \"notes\": %g,\n", bench.notes);
+	fprintf(file, "  \"results\": [\n");
+
+	for(i = 0; i < n; i++) {
+		fprintf(file, "    {\n");
+		fprintf(file, "      \"patch\": "), bench_json(file, patch[i]), fprintf(file, ",\n");
+		fprintf(file, "      \"samples\": %lu,\n", (unsigned long)res[i].samples);
+		fprintf(file, "      \"ns_per_sample\": %.3f,\n", (double)res[i].total / res[i].samples);
+		fprintf(file, "      \"realtime\": %.3f,\n", (1e9 * res[i].samples / bench.rate) / res[i].total);
+		fprintf(file, "      \"block_us\": { \"p50\": %.3f, \"p99\": %.3f, \"max\": %.3f },\n", res[i].p50 / 1e3, res[i].p99 / 1e3, res[i].max / 1e3);
+		fprintf(file, "      \"rms\": %.6f,\n", res[i].rms);
+		fprintf(file, "      \"peak_rss_kb\": %ld,\n", res[i].rss);
+		fprintf(file, "      \"underruns\": %lu\n", (unsigned long)res[i].underrun);
+		fprintf(file, "    }%s\n", (i + 1 < n) ? "," : "");
+	}
+
+	fprintf(file, "  ]\n");
+	fprintf(file, "}\n");
+
+	if(file != stdout)
+		fclose(file);
+
+	free(res);
+	free(patch);
+
+	return 0;
+}
+
+
+/**
+ * Parse the benchmark configuration. The string is a list of options, each a
+ * letter followed by a number: 'r' for sample rate, 'l' for block length, 's'
+ * for the measured seconds, 'w' for the warm-up seconds, 'n' for the scripted
+ * notes per second, and 'd' for the device of the scripted notes.
+ *   @conf: The configuration.
+ *   @str: Optional. The string.
+ */
+static void bench_conf(struct bench_conf_t *conf, const char *str)
+{
+	*conf = (struct bench_conf_t){ 48000, 256, 10.0, 1.0, 8.0, 0 };
+
+	if(str == NULL)
+		return;
+
+	while(true) {
+		char opt;
+		double val;
+
+		while(isspace(*str))
+			str++;
+
+		if(*str == '\0')
+			break;
+
+		opt = *str++;
+		if(!isdigit(*str) && (*str != '.'))
+			fprintf(stderr, "Missing benchmark parameter.\n"), exit(1);
+
+		errno = 0;
+		val = strtod(str, (char **)&str);
+		if((errno != 0) || (val < 0.0) || (val > UINT_MAX))
+			fprintf(stderr, "Invalid parameter. %s.\n", strerror(errno)), exit(1);
+
+		switch(opt) {
+		case 'r': conf->rate = val; break;
+		case 'l': conf->len = val; break;
+		case 's': conf->secs = val; break;
+		case 'w': conf->warm = val; break;
+		case 'n': conf->notes = val; break;
+		case 'd': conf->dev = val; break;
+		default: fprintf(stderr, "Invalid benchmark option '%c'.\n", opt), exit(1);
+		}
+	}
+
+	if((conf->rate == 0) || (conf->len == 0) || (conf->secs == 0.0))
+		fprintf(stderr, "Benchmark rate, block length and seconds must be non-zero.\n"), exit(1);
+
+	if(conf->dev > UINT16_MAX)
+		fprintf(stderr, "Invalid device number.\n"), exit(1);
+}
+
+/**
+ * Run a patch in a child process, so that the peak resident set size is
+ * measured for the patch alone. The child exits on any error.
+ *   @res: The result.
+ *   @path: The patch path.
+ *   @dir: The synthetic sample directory.
+ *   @conf: The configuration.
+ */
+static void bench_fork(struct bench_res_t *res, const char *path, const char *dir, const struct bench_conf_t *conf)
+{
+	int fd[2], status;
+	pid_t pid;
+	ssize_t ret;
+	struct rusage usage;
+
+	if(pipe(fd) < 0)
+		fprintf(stderr, "Cannot create pipe. %s.\n", strerror(errno)), exit(1);
+
+	fflush(NULL);
+
+	pid = fork();
+	if(pid < 0)
+		fprintf(stderr, "Cannot fork. %s.\n", strerror(errno)), exit(1);
+
+	if(pid == 0) {
+		close(fd[0]);
+		bench_run(res, path, dir, conf);
+		ret = write(fd[1], res, sizeof(struct bench_res_t));
+		_exit((ret == sizeof(struct bench_res_t)) ? 0 : 1);
+	}
+
+	close(fd[1]);
+	ret = read(fd[0], res, sizeof(struct bench_res_t));
+	close(fd[0]);
+
+	if(wait4(pid, &status, 0, &usage) < 0)
+		fprintf(stderr, "Cannot wait for '%s'. %s.\n", path, strerror(errno)), exit(1);
+
+	if(!WIFEXITED(status) || (WEXITSTATUS(status) != 0) || (ret != sizeof(struct bench_res_t)))
+		exit(1);
+
+	res->rss = usage.ru_maxrss;
+}
+
+/**
+ * Run a patch. The warm-up and measured lengths are rounded up to whole
+ * blocks, and only the measured blocks are timed.
+ *   @res: The result.
+ *   @path: The patch path.
+ *   @dir: The synthetic sample directory.
+ *   @conf: The configuration.
+ */
+static void bench_run(struct bench_res_t *res, const char *path, const char *dir, const struct bench_conf_t *conf)
+{
+	char *err;
+	double sum = 0.0;
+	unsigned int i, n, warm, cnt;
+	uint64_t *ns;
+	struct ml_env_t *env;
+	struct ml_value_t *value;
+	struct amp_box_t *box;
+	struct amp_core_t *core;
+	struct amp_clock_t clock;
+	struct amp_instr_t instr;
+	struct amp_seek_t seek;
+	struct bench_script_t script;
+
+	core = amp_core_new(conf->rate);
+	ml_env_add(&core->env, strdup("bench.dir"), ml_value_str(strdup(dir), ml_tag_copy(ml_tag_null)));
+
+	env = amp_core_eval(core, path, &err);
+	if(env == NULL)
+		fprintf(stderr, "%s\n", err), exit(1);
+
+	clock = amp_basic_clock(amp_basic_new(120.0, 4.0, conf->rate));
+
+	value = ml_env_lookup(env, "amp.clock");
+	if(value != NULL) {
+		box = amp_unbox_value(value, amp_box_clock_e);
+		if(box == NULL)
+			fprintf(stderr, "%s: Type for 'amp.clock' is not valid.\n", path), exit(1);
+
+		amp_clock_set(&clock, amp_clock_copy(box->data.clock));
+	}
+
+	value = ml_env_lookup(env, "amp.instr");
+	if(value == NULL)
+		fprintf(stderr, "%s: Missing 'amp.instr'.\n", path), exit(1);
+
+	box = amp_unbox_value(value, amp_box_instr_e);
+	if(box == NULL)
+		fprintf(stderr, "%s: Type for 'amp.instr' is not valid.\n", path), exit(1);
+
+	instr = amp_instr_copy(box->data.instr);
+	ml_env_delete(env);
+
+	amp_clock_info(clock, amp_info_init());
+	amp_instr_info(instr, amp_info_init());
+	amp_clock_info(clock, amp_info_start(&seek));
+	amp_instr_info(instr, amp_info_start(&seek));
+
+	bench_script_init(&script, conf->dev, conf->notes, conf->rate);
+
+	warm = ceil(conf->warm * conf->rate / conf->len);
+	cnt = ceil(conf->secs * conf->rate / conf->len);
+	ns = malloc(cnt * sizeof(uint64_t));
+
+	for(n = 0; n < warm + cnt; n++) {
+		uint64_t begin;
+		dsp_sample_t left[conf->len], right[conf->len], *buf[2] = { left, right };
+		struct amp_time_t time[conf->len+1];
+		struct amp_queue_t queue;
+
+		dsp_zero_s(left, conf->len);
+		dsp_zero_s(right, conf->len);
+
+		begin = bench_nsec();
+
+		amp_clock_proc(clock, time, conf->len);
+		amp_queue_init(&queue);
+		bench_script_proc(&script, &queue, (uint64_t)n * conf->len, conf->len);
+		amp_instr_proc(instr, buf, time, conf->len, &queue);
+
+		if(n < warm)
+			continue;
+
+		ns[n - warm] = bench_nsec() - begin;
+
+		for(i = 0; i < conf->len; i++)
+			sum += left[i] * left[i];
+	}
+
+	qsort(ns, cnt, sizeof(uint64_t), bench_cmp);
+
+	res->samples = (uint64_t)cnt * conf->len;
+	res->total = 0;
+	for(i = 0; i < cnt; i++)
+		res->total += ns[i];
+
+	res->p50 = ns[(cnt - 1) / 2];
+	res->p99 = ns[(cnt - 1) * 99 / 100];
+	res->max = ns[cnt - 1];
+	res->rms = sqrt(sum / res->samples);
+
+	free(ns);
+	amp_instr_delete(instr);
+	amp_clock_delete(clock);
+
+	res->underrun = amp_io_underrun(core->io);
+	amp_core_delete(core);
+}
+
+
+/**
+ * Retrieve the monotonic time.
+ *   &returns: The time in nanoseconds.
+ */
+static uint64_t bench_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * Compare two times for sorting.
+ *   @left: The left time.
+ *   @right: The right time.
+ *   &returns: Their order.
+ */
+static int bench_cmp(const void *left, const void *right)
+{
+	uint64_t a = *(const uint64_t *)left, b = *(const uint64_t *)right;
+
+	return (a > b) - (a < b);
+}
+
+/**
+ * Write a string as a JSON string.
+ *   @file: The file.
+ *   @str: The string.
+ */
+static void bench_json(FILE *file, const char *str)
+{
+	fputc('"', file);
+
+	for(; *str != '\0'; str++) {
+		if((*str == '"') || (*str == '\\'))
+			fprintf(file, "\\%c", *str);
+		else if((unsigned char)*str < 0x20)
+			fprintf(file, "\\u%04x", *str);
+		else
+			fputc(*str, file);
+	}
+
+	fputc('"', file);
+}
+
+
+/**
+ * Retrieve a long option.
+ *   @arg: The argument pointer.
+ *   @opt: The option.
+ *   &returns: The value if matched, false otherwise.
+ */
+static char *optlong(char ***arg, const char *opt)
+{
+	unsigned int len = strlen(opt);
+
+	if(memcmp(**arg, opt, len) != 0)
+		return NULL;
+
+	if((**arg)[len] == '=') {
+		return **arg + len + 1;
+	}
+	else if((**arg)[len] == '\0') {
+		(*arg)++;
+		if(**arg == NULL)
+			fprintf(stderr, "Option '%s' expected parameter.\n", opt), exit(1);
+
+		return **arg;
+	}
+	else
+		return NULL;
+}
@@ -0,0 +1,78 @@
+#include "common.h"
+
+
+/*
+ * local declarations
+ */
+static unsigned int script_rand(struct bench_script_t *script);
+
+
+/**
+ * Initialize a MIDI script.
+ *   @script: The script.
+ *   @dev: The device.
+ *   @notes: The number of notes per second, zero to disable.
+ *   @rate: The sample rate.
+ */
+void bench_script_init(struct bench_script_t *script, uint16_t dev, double notes, unsigned int rate)
+{
+	script->dev = dev;
+	script->seed = 1;
+	script->next = 0;
+	script->period = (notes > 0.0) ? m_max_u(rate / notes, 1) : 0;
+	script->hold = 5 * script->period / 2;
+	script->n = 0;
+}
+
+/**
+ * Add the scripted events for a block to the queue. Note ons are added before
+ * note offs so that a note never ends before it starts.
+ *   @script: The script.
+ *   @queue: The action queue.
+ *   @pos: The sample position of the block.
+ *   @len: The block length.
+ */
+void bench_script_proc(struct bench_script_t *script, struct amp_queue_t *queue, uint64_t pos, unsigned int len)
+{
+	unsigned int i;
+
+	if(script->period == 0)
+		return;
+
+	while(script->next < (pos + len)) {
+		uint16_t key, vel;
+
+		key = BENCH_KEYLO + script_rand(script) % (BENCH_KEYHI - BENCH_KEYLO + 1);
+		vel = 16384 + script_rand(script) % 49152;
+
+		if(script->n < BENCH_HELD) {
+			amp_queue_add(queue, amp_action(script->next - pos, amp_event(script->dev, key, vel), queue));
+			script->held[script->n++] = (struct bench_note_t){ script->next + script->hold, key };
+		}
+
+		script->next += script->period;
+	}
+
+	for(i = 0; i < script->n; ) {
+		if(script->held[i].off >= (pos + len)) {
+			i++;
+			continue;
+		}
+
+		amp_queue_add(queue, amp_action(script->held[i].off - pos, amp_event(script->dev, script->held[i].key, 0), queue));
+		script->held[i] = script->held[--script->n];
+	}
+}
+
+
+/**
+ * Retrieve the next value from the script generator.
+ *   @script: The script.
+ *   &returns: The value, in the range zero to 32767.
+ */
+static unsigned int script_rand(struct bench_script_t *script)
+{
+	script->seed = script->seed * 1103515245 + 12345;
+
+	return (script->seed >> 16) & 0x7FFF;
+}
@@ -0,0 +1,51 @@
+#ifndef SCRIPT_H
+#define SCRIPT_H
+
+/*
+ * script definitions
+ *   @BENCH_HELD: The maximum number of held notes.
+ *   @BENCH_KEYLO, BENCH_KEYHI: The range of scripted keys.
+ */
+#define BENCH_HELD  16
+#define BENCH_KEYLO 48
+#define BENCH_KEYHI 84
+
+/**
+ * Held note structure.
+ *   @off: The sample position of the note off.
+ *   @key: The key.
+ */
+struct bench_note_t {
+	uint64_t off;
+	uint16_t key;
+};
+
+/**
+ * MIDI script structure. Keys and velocities are drawn from a generator with
+ * a fixed seed so that every run receives identical events.
+ *   @dev: The device.
+ *   @seed: The generator state.
+ *   @next: The sample position of the next note on.
+ *   @period, hold: The note period and hold length in samples.
+ *   @n: The number of held notes.
+ *   @held: The held notes.
+ */
+struct bench_script_t {
+	uint16_t dev;
+	uint32_t seed;
+
+	uint64_t next;
+	unsigned int period, hold;
+
+	unsigned int n;
+	struct bench_note_t held[BENCH_HELD];
+};
+
+
+/*
+ * script declarations
+ */
+void bench_script_init(struct bench_script_t *script, uint16_t dev, double notes, unsigned int rate);
+void bench_script_proc(struct bench_script_t *script, struct amp_queue_t *queue, uint64_t pos, unsigned int len);
+
+#endif
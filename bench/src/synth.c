@@ -0,0 +1,121 @@
+#include "common.h"
+
+
+/*
+ * local declarations
+ */
+#define SYNTH_RATE 44100
+
+static char *synth_save(const char *dir, const char *name, int *arr, unsigned int len);
+
+
+/**
+ * Generate the synthetic sample set used by the corpus. Every key in the
+ * scripted range has a decaying harmonic tone, 'key<n>.acw', and there are
+ * two velocity layers of two round-robin hits, 'hit<v><r>.acw'. The output
+ * is identical on every run.
+ *   @dir: The output directory.
+ *   &returns: Error.
+ */
+char *bench_synth_new(const char *dir)
+{
+#define onexit free(arr);
+	unsigned int i, k, h, v, r, len;
+	uint32_t seed = 1;
+	char name[32];
+	int *arr;
+
+	len = 3 * SYNTH_RATE / 2;
+	arr = malloc(len * sizeof(int));
+
+	for(k = BENCH_KEYLO; k <= BENCH_KEYHI; k++) {
+		double freq = amp_key_freq_f(k);
+
+		for(i = 0; i < len; i++) {
+			double t = (double)i / SYNTH_RATE, val = 0.0;
+
+			for(h = 1; h <= 4; h++)
+				val += sin(2.0 * M_PI * freq * h * t) * exp(-t * (1.5 + h)) / h;
+
+			arr[i] = 0.4 * val * (1 << 23);
+		}
+
+		sprintf(name, "key%u.acw", k);
+		chkfail(synth_save(dir, name, arr, len));
+	}
+
+	len = SYNTH_RATE / 2;
+
+	for(v = 0; v < 2; v++) {
+		for(r = 0; r < 2; r++) {
+			for(i = 0; i < len; i++) {
+				double t = (double)i / SYNTH_RATE, noise;
+
+				seed = seed * 1103515245 + 12345;
+				noise = (double)((seed >> 16) & 0x7FFF) / 16384.0 - 1.0;
+
+				arr[i] = (0.3 + 0.3 * v) * (0.6 * sin(2.0 * M_PI * (60.0 + 10.0 * r) * t) + 0.4 * noise) * exp(-t * 12.0) * (1 << 23);
+			}
+
+			sprintf(name, "hit%u%u.acw", v, r);
+			chkfail(synth_save(dir, name, arr, len));
+		}
+	}
+
+	free(arr);
+
+	return NULL;
+#undef onexit
+}
+
+/**
+ * Remove the synthetic sample set and its directory.
+ *   @dir: The directory.
+ */
+void bench_synth_delete(const char *dir)
+{
+	char *path;
+	unsigned int k, v, r;
+
+	for(k = BENCH_KEYLO; k <= BENCH_KEYHI; k++) {
+		path = mprintf("%s/key%u.acw", dir, k);
+		unlink(path);
+		free(path);
+	}
+
+	for(v = 0; v < 2; v++) {
+		for(r = 0; r < 2; r++) {
+			path = mprintf("%s/hit%u%u.acw", dir, v, r);
+			unlink(path);
+			free(path);
+		}
+	}
+
+	rmdir(dir);
+}
+
+
+/**
+ * Encode and save a sample.
+ *   @dir: The directory.
+ *   @name: The file name.
+ *   @arr: The 24-bit sample array.
+ *   @len: The length.
+ *   &returns: Error.
+ */
+static char *synth_save(const char *dir, const char *name, int *arr, unsigned int len)
+{
+	char *err, *path;
+	struct acw_buf_t buf;
+
+	buf = acw_buf_enc32(arr, len);
+	buf.info.rate = SYNTH_RATE;
+
+	path = mprintf("%s/%s", dir, name);
+	err = acw_buf_save(buf, path);
+	free(path);
+
+	acw_buf_delete(buf);
+
+	return err;
+}
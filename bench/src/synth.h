@@ -0,0 +1,10 @@
+#ifndef SYNTH_H
+#define SYNTH_H
+
+/*
+ * synthetic sample declarations
+ */
+char *bench_synth_new(const char *dir);
+void bench_synth_delete(const char *dir);
+
+#endif
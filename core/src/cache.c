@@ -1,44 +1,156 @@
 #include "common.h"
+#include <sys/stat.h>
 
 /**
- * File cache.
- *   @file: The file.
+ * File cache. Files are indexed by a hash of their key. Files without any
+ * references are kept in the idle list, oldest first, and evicted once the
+ * bytes they hold exceed the budget.
+ *
+ * Opening a file that is not cached returns a pending file and queues it to
+ * the loader threads; 'amp_cache_wait' must be called before any pending file
+ * is played. The table, the idle list and reference counts are only used by
+ * the thread evaluating patches, while the loader threads only fill in the
+ * files handed to them.
+ *   @table: The hash table.
+ *   @nbuckets, nfiles: The number of buckets, a power of two, and files.
+ *   @idle: The idle list.
+ *   @nidle, budget: The bytes held by idle files and the budget.
+ *   @flags: The ACW mapping flags.
+ *   @nthreads, thread: The loader threads.
+ *   @lock, cond, finish: The loader lock and the queued and finished
+ *     condition variables.
+ *   @term: The terminate flag.
+ *   @head, tail, done: The load queue and the finished list.
+ *   @npending: The number of pending files.
+ *   @nload, ntotal: The number of files finished and queued since the last
+ *     wait.
+ *   @func, arg: The progress callback and argument.
  */
 struct amp_cache_t {
-	struct amp_file_t *file;
+	struct amp_file_t **table;
+	unsigned int nbuckets, nfiles;
+
+	struct list_root_t idle;
+	size_t nidle, budget;
+
+	unsigned int flags;
+
+	unsigned int nthreads;
+	sys_thread_t *thread;
+
+	sys_mutex_t lock;
+	sys_cond_t cond, finish;
+	bool term;
+
+	struct amp_file_t *head, *tail, *done;
+	unsigned int npending;
+
+	unsigned int nload, ntotal;
+	amp_cache_f func;
+	void *arg;
 };
 
 /**
  * File structure.
  *   @path: The path.
- *   @chan: The channel.
+ *   @chan: The channel, zero for decoded files which hold every channel.
+ *   @rate, quality: The sample rate and resampling quality.
  *   @buf: The buffer.
+ *   @sinc: The resampler table, null if not resampled or linear.
+ *   @dsp: The decoded buffer of each channel, null unless the file was
+ *     opened decoded.
+ *   @head: The requested head length for streamed files, zero if fully loaded.
+ *   @len, off: The number of samples and bytes held in the buffer.
+ *   @base: The file offset of the channel's block data for streamed files.
+ *   @decode: Flag indicating the file is decoded.
+ *   @hash: The key hash.
+ *   @mtime, size: The modification time and size of the file when loaded.
+ *   @hashed, pending: Flags indicating the file is in the hash table and
+ *     that it has not yet been waited upon.
+ *   @err: The load error, set by the loader.
  *   @refcnt: The reference count.
  *   @cache: The cache.
- *   @next: The next file.
+ *   @next: The next file in the bucket.
+ *   @job: The next file in the load queue or finished list.
+ *   @node: The idle list node.
  */
 struct amp_file_t {
 	char *path;
 	unsigned int chan;
+	unsigned int rate, quality;
 	struct acw_buf_t buf;
+	struct dsp_sinc_t *sinc;
+	struct dsp_buf_t **dsp;
+	unsigned int head, len, off;
+	long base;
+	bool decode;
+
+	uint32_t hash;
+	int64_t mtime, size;
+	bool hashed, pending;
+	char *err;
 
 	struct amp_cache_t *cache;
 	unsigned int refcnt;
 
-	struct amp_file_t *next;
+	struct amp_file_t *next, *job;
+	struct list_node_t node;
 };
 
 
+/*
+ * local declarations
+ */
+static uint32_t cache_hash(const char *path, unsigned int chan, unsigned int rate, unsigned int quality, unsigned int head, bool decode);
+static struct amp_file_t *cache_find(struct amp_cache_t *cache, const char *path, unsigned int chan, unsigned int rate, unsigned int quality, unsigned int head, bool decode);
+static struct amp_file_t *cache_get(struct amp_cache_t *cache, const char *path, unsigned int chan, unsigned int rate, unsigned int quality, unsigned int head, bool decode);
+static struct amp_file_t *cache_reuse(struct amp_cache_t *cache, const char *path, unsigned int chan, unsigned int rate, unsigned int quality, unsigned int head, bool decode);
+static struct amp_file_t *cache_add(struct amp_cache_t *cache, const char *path, unsigned int chan, unsigned int rate, unsigned int quality, unsigned int head, bool decode);
+static void cache_unhash(struct amp_cache_t *cache, struct amp_file_t *file);
+static void cache_trim(struct amp_cache_t *cache);
+static void cache_free(struct amp_file_t *file);
+static bool cache_stat(const char *path, int64_t *mtime, int64_t *size);
+
+static void *cache_thread(void *arg);
+static void cache_load(struct amp_cache_t *cache, struct amp_file_t *file);
+static char *cache_head(struct acw_buf_t *buf, unsigned int *len, unsigned int *off, long *base, const char *path, unsigned int chan, unsigned int head);
+static struct dsp_buf_t **cache_decode(struct acw_buf_t buf, unsigned int rate, size_t *size);
+
+static bool stream_block(struct amp_stream_t *stream);
+
+
 /**
  * Create a new cache.
  *   @cache: The cache.
  */
 struct amp_cache_t *amp_cache_new(void)
 {
+	unsigned int i;
 	struct amp_cache_t *cache;
 
 	cache = malloc(sizeof(struct amp_cache_t));
-	cache->file = NULL;
+	cache->nbuckets = 64;
+	cache->nfiles = 0;
+	cache->table = calloc(cache->nbuckets, sizeof(struct amp_file_t *));
+	cache->idle = list_root_init();
+	cache->nidle = 0;
+	cache->budget = AMP_CACHE_BUDGET;
+	cache->flags = 0;
+	cache->lock = sys_mutex_init(0);
+	cache->cond = sys_cond_init(0);
+	cache->finish = sys_cond_init(0);
+	cache->term = false;
+	cache->head = cache->tail = cache->done = NULL;
+	cache->npending = 0;
+	cache->nload = cache->ntotal = 0;
+	cache->func = NULL;
+	cache->arg = NULL;
+
+	cache->nthreads = m_max_u(amp_pool_ncpu(), AMP_CACHE_THREADS);
+	cache->thread = malloc(cache->nthreads * sizeof(sys_thread_t));
+
+	for(i = 0; i < cache->nthreads; i++)
+		cache->thread[i] = sys_thread_create(0, cache_thread, cache);
 
 	return cache;
 }
@@ -49,94 +161,216 @@ struct amp_cache_t *amp_cache_new(void)
  */
 void amp_cache_delete(struct amp_cache_t *cache)
 {
+	char *err;
+	unsigned int i;
 	struct amp_file_t *cur, *next;
 
-	for(cur = cache->file; cur != NULL; cur = next) {
-		next = cur->next;
+	err = amp_cache_wait(cache);
+	if(err != NULL)
+		free(err);
+
+	sys_mutex_lock(&cache->lock);
+	cache->term = true;
+	sys_cond_broadcast(&cache->cond);
+	sys_mutex_unlock(&cache->lock);
+
+	for(i = 0; i < cache->nthreads; i++)
+		sys_thread_join(&cache->thread[i]);
 
-		acw_buf_delete(cur->buf);
-		free(cur->path);
-		free(cur);
+	for(i = 0; i < cache->nbuckets; i++) {
+		for(cur = cache->table[i]; cur != NULL; cur = next) {
+			next = cur->next;
+			cache_free(cur);
+		}
 	}
 
+	sys_mutex_destroy(&cache->lock);
+	sys_cond_destroy(&cache->cond);
+	sys_cond_destroy(&cache->finish);
+	free(cache->thread);
+	free(cache->table);
 	free(cache);
 }
 
 
 /**
- * Look up a file in the cache.
+ * Set whether files are prefaulted when opened. Files are mapped, so pages
+ * are otherwise read from disk on first use, possibly by the audio thread.
+ *   @cache: The cache.
+ *   @enable: The enable flag.
+ */
+void amp_cache_prefault(struct amp_cache_t *cache, bool enable)
+{
+	cache->flags = enable ? ACW_MAP_PREFAULT : 0;
+}
+
+/**
+ * Set the number of bytes that files without references may hold before
+ * the least recently used are evicted.
+ *   @cache: The cache.
+ *   @budget: The budget in bytes.
+ */
+void amp_cache_budget(struct amp_cache_t *cache, size_t budget)
+{
+	cache->budget = budget;
+	cache_trim(cache);
+}
+
+/**
+ * Set the callback reporting load progress. The callback is invoked from
+ * 'amp_cache_wait' as each file finishes loading.
+ *   @cache: The cache.
+ *   @func: Optional. The callback.
+ *   @arg: The argument.
+ */
+void amp_cache_progress(struct amp_cache_t *cache, amp_cache_f func, void *arg)
+{
+	cache->func = func;
+	cache->arg = arg;
+}
+
+
+/**
+ * Look up a file in the cache without adding a reference.
  *   @cache: The cache.
  *   @path: The path.
  *   @chan: The channel.
+ *   @rate: The sample rate.
+ *   @quality: The resampling quality.
  *   &returns: The file if successful, false otherwise.
  */
-struct amp_file_t *amp_cache_lookup(struct amp_cache_t *cache, const char *path, unsigned int chan)
+struct amp_file_t *amp_cache_lookup(struct amp_cache_t *cache, const char *path, unsigned int chan, unsigned int rate, unsigned int quality)
 {
-	struct amp_file_t *file;
+	return cache_find(cache, path, chan, rate, quality, 0, false);
+}
 
-	for(file = cache->file; file != NULL; file = file->next) {
-		if((strcmp(file->path, path) == 0) && (file->chan == chan))
-			return file;
-	}
 
-	return NULL;
+/**
+ * Open a file in the cache. Files recorded at another rate carry a resampler
+ * table for the quality. A cached file is reused unless it has changed on
+ * disk since it was loaded; otherwise the file is loaded in the background.
+ *   @cache: The cache.
+ *   @path: The path.
+ *   @chan: The channel.
+ *   @rate: The sample rate.
+ *   @quality: The resampling quality.
+ *   &returns: The file, pending until the cache is waited upon.
+ */
+struct amp_file_t *amp_cache_open(struct amp_cache_t *cache, const char *path, unsigned int chan, unsigned int rate, unsigned int quality)
+{
+	return cache_get(cache, path, chan, rate, quality, 0, false);
 }
 
-
 /**
- * Open a file in the cache.
+ * Open a file in the cache for streaming. Only the head of the file is kept
+ * in memory, rounded up to a whole block; the remainder is read from disk
+ * by a stream as the file is played.
  *   @cache: The cache.
  *   @path: The path.
  *   @chan: The channel.
  *   @rate: The sample rate.
- *   &returns: The file if successful, false otherwise.
+ *   @quality: The resampling quality.
+ *   @head: The head length in samples, zero to load the whole file.
+ *   &returns: The file, pending until the cache is waited upon.
  */
-struct amp_file_t *amp_cache_open(struct amp_cache_t *cache, const char *path, unsigned int chan, unsigned int rate)
+struct amp_file_t *amp_cache_stream(struct amp_cache_t *cache, const char *path, unsigned int chan, unsigned int rate, unsigned int quality, unsigned int head)
 {
+	return cache_get(cache, path, chan, rate, quality, head, false);
+}
+
+/**
+ * Open a file in the cache decoded into sample buffers, converting files with
+ * a known rate to the sample rate. Every channel is decoded in one pass, so
+ * the channels of a multichannel file share a single cached file. The ACW
+ * buffer of a decoded file is released once decoded.
+ *   @cache: The cache.
+ *   @path: The path.
+ *   @rate: The sample rate.
+ *   &returns: The file, pending until the cache is waited upon.
+ */
+struct amp_file_t *amp_cache_decode(struct amp_cache_t *cache, const char *path, unsigned int rate)
+{
+	return cache_get(cache, path, 0, rate, DSP_SINC_LINEAR, 0, true);
+}
+
+/**
+ * Wait for every pending file to load. Files that failed to load are removed
+ * from the cache, and unreferenced files that were replaced while loading are
+ * freed.
+ *   @cache: The cache.
+ *   &returns: Error, for the first file that failed.
+ */
+char *amp_cache_wait(struct amp_cache_t *cache)
+{
+	char *err = NULL;
 	struct amp_file_t *file;
 
-	file = amp_cache_lookup(cache, path, chan);
-	if(file == NULL) {
-		struct acw_buf_t buf;
+	sys_mutex_lock(&cache->lock);
 
-		if(!chkbool(acw_buf_load(&buf, path)))
-			return NULL;
+	while(cache->npending > 0) {
+		while(cache->done == NULL)
+			sys_cond_wait(&cache->finish, &cache->lock);
 
-		file = malloc(sizeof(struct amp_file_t));
-		file->refcnt = 1;
-		file->buf = buf;
-		file->cache = cache;
-		file->chan = chan;
-		file->path = strdup(path);
-		file->next = cache->file;
-		cache->file = file;
+		file = cache->done;
+		cache->done = file->job;
+		cache->npending--;
+		sys_mutex_unlock(&cache->lock);
+
+		file->pending = false;
+		if(cache->func != NULL)
+			cache->func(cache->arg, file->path, ++cache->nload, cache->ntotal);
+
+		if(file->err != NULL) {
+			if(err == NULL)
+				err = file->err;
+			else
+				free(file->err);
+
+			file->err = NULL;
+			if(file->hashed)
+				cache_unhash(cache, file);
+
+			if(file->refcnt == 0)
+				cache_free(file);
+		}
+		else if(file->refcnt == 0) {
+			if(!file->hashed)
+				cache_free(file);
+			else {
+				list_root_append(&cache->idle, &file->node);
+				cache->nidle += file->off;
+				cache_trim(cache);
+			}
+		}
+
+		sys_mutex_lock(&cache->lock);
 	}
-	else
-		file->refcnt++;
 
-	return file;
+	sys_mutex_unlock(&cache->lock);
+	cache->nload = cache->ntotal = 0;
+
+	return err;
 }
 
 /**
- * Close a file, removing it from the cache.
+ * Close a reference to a file. Once the last reference is closed, the file
+ * is kept as idle, or freed if it has been replaced in the cache. Pending
+ * files are left to 'amp_cache_wait'.
  *   @cache: The cache.
  *   @file: The file.
  */
 void amp_cache_close(struct amp_cache_t *cache, struct amp_file_t *file)
 {
-	struct amp_file_t **ptr;
-
-	for(ptr = &cache->file; *ptr != NULL; *ptr = (*ptr)->next) {
-		if(*ptr != file)
-			continue;
+	if((--file->refcnt > 0) || file->pending)
+		return;
 
-		*ptr = (*ptr)->next;
-		break;
+	if(!file->hashed)
+		cache_free(file);
+	else {
+		list_root_append(&cache->idle, &file->node);
+		cache->nidle += file->off;
+		cache_trim(cache);
 	}
-
-	acw_buf_delete(file->buf);
-	free(file->path);
-	free(file);
 }
 
 
@@ -158,8 +392,7 @@ struct amp_file_t *amp_file_copy(struct amp_file_t *file)
  */
 void amp_file_delete(struct amp_file_t *file)
 {
-	if(--file->refcnt == 0)
-		amp_cache_close(file->cache, file);
+	amp_cache_close(file->cache, file);
 }
 
 
@@ -173,6 +406,709 @@ struct acw_buf_t amp_file_buf(struct amp_file_t *file)
 	return file->buf;
 }
 
+/**
+ * Retrieve the channel played from a file.
+ *   @file: The file.
+ *   &returns: The channel.
+ */
+unsigned int amp_file_chan(struct amp_file_t *file)
+{
+	return file->chan;
+}
+
+/**
+ * Retrieve the resampler table of a file.
+ *   @file: The file.
+ *   &returns: The table, null if the file is played without one.
+ */
+const struct dsp_sinc_t *amp_file_sinc(struct amp_file_t *file)
+{
+	return file->sinc;
+}
+
+/**
+ * Retrieve the number of channels of a file.
+ *   @file: The file.
+ *   &returns: The number of channels, zero if the file failed to load.
+ */
+unsigned int amp_file_nchan(struct amp_file_t *file)
+{
+	return file->buf.info.chan;
+}
+
+/**
+ * Retrieve a decoded channel of a file.
+ *   @file: The file.
+ *   @chan: The channel.
+ *   &returns: The buffer, null unless the file was opened decoded and has
+ *     the channel.
+ */
+const struct dsp_buf_t *amp_file_dsp(struct amp_file_t *file, unsigned int chan)
+{
+	return ((file->dsp != NULL) && (chan < file->buf.info.chan)) ? file->dsp[chan] : NULL;
+}
+
+/**
+ * Check if a file has a tail that must be streamed from disk.
+ *   @file: The file.
+ *   &returns: True if the file has a tail.
+ */
+bool amp_file_tail(struct amp_file_t *file)
+{
+	return file->len < file->buf.info.length;
+}
+
+
+/**
+ * Compute the hash of a file key.
+ *   @path: The path.
+ *   @chan: The channel.
+ *   @rate: The sample rate.
+ *   @quality: The resampling quality.
+ *   @head: The head length.
+ *   @decode: The decode flag.
+ *   &returns: The hash.
+ */
+static uint32_t cache_hash(const char *path, unsigned int chan, unsigned int rate, unsigned int quality, unsigned int head, bool decode)
+{
+	unsigned int i;
+	uint32_t hash = 2166136261u, key[5] = { chan, rate, quality, head, decode };
+
+	while(*path != '\0')
+		hash = (hash ^ (uint8_t)*path++) * 16777619u;
+
+	for(i = 0; i < 5; i++)
+		hash = (hash ^ key[i]) * 16777619u;
+
+	return hash;
+}
+
+/**
+ * Find a file in the cache.
+ *   @cache: The cache.
+ *   @path: The path.
+ *   @chan: The channel.
+ *   @rate: The sample rate.
+ *   @quality: The resampling quality.
+ *   @head: The head length.
+ *   @decode: The decode flag.
+ *   &returns: The file or null.
+ */
+static struct amp_file_t *cache_find(struct amp_cache_t *cache, const char *path, unsigned int chan, unsigned int rate, unsigned int quality, unsigned int head, bool decode)
+{
+	uint32_t hash;
+	struct amp_file_t *file;
+
+	hash = cache_hash(path, chan, rate, quality, head, decode);
+
+	for(file = cache->table[hash & (cache->nbuckets - 1)]; file != NULL; file = file->next) {
+		if((file->hash == hash) && (file->chan == chan) && (file->rate == rate) && (file->quality == quality) && (file->head == head) && (file->decode == decode) && (strcmp(file->path, path) == 0))
+			return file;
+	}
+
+	return NULL;
+}
+
+/**
+ * Retrieve a file from the cache with a new reference, queueing it to the
+ * loader threads if not cached.
+ *   @cache: The cache.
+ *   @path: The path.
+ *   @chan: The channel.
+ *   @rate: The sample rate.
+ *   @quality: The resampling quality.
+ *   @head: The head length.
+ *   @decode: The decode flag.
+ *   &returns: The file.
+ */
+static struct amp_file_t *cache_get(struct amp_cache_t *cache, const char *path, unsigned int chan, unsigned int rate, unsigned int quality, unsigned int head, bool decode)
+{
+	struct amp_file_t *file;
+
+	file = cache_reuse(cache, path, chan, rate, quality, head, decode);
+	if(file != NULL)
+		return file;
+
+	file = cache_add(cache, path, chan, rate, quality, head, decode);
+	file->pending = true;
+	file->job = NULL;
+	cache->ntotal++;
+
+	sys_mutex_lock(&cache->lock);
+
+	if(cache->tail != NULL)
+		cache->tail->job = file;
+	else
+		cache->head = file;
+
+	cache->tail = file;
+	cache->npending++;
+	sys_cond_signal(&cache->cond);
+	sys_mutex_unlock(&cache->lock);
+
+	return file;
+}
+
+/**
+ * Find a file in the cache and add a reference to it. A file that changed
+ * on disk is removed from the cache instead, and freed once unreferenced.
+ *   @cache: The cache.
+ *   @path: The path.
+ *   @chan: The channel.
+ *   @rate: The sample rate.
+ *   @quality: The resampling quality.
+ *   @head: The head length.
+ *   @decode: The decode flag.
+ *   &returns: The file or null.
+ */
+static struct amp_file_t *cache_reuse(struct amp_cache_t *cache, const char *path, unsigned int chan, unsigned int rate, unsigned int quality, unsigned int head, bool decode)
+{
+	int64_t mtime, size;
+	struct amp_file_t *file;
+
+	file = cache_find(cache, path, chan, rate, quality, head, decode);
+	if(file == NULL)
+		return NULL;
+
+	if((file->refcnt == 0) && !file->pending) {
+		list_root_remove(&cache->idle, &file->node);
+		cache->nidle -= file->off;
+	}
+
+	file->refcnt++;
+
+	if(!cache_stat(path, &mtime, &size) || (mtime != file->mtime) || (size != file->size)) {
+		cache_unhash(cache, file);
+		amp_cache_close(cache, file);
+
+		return NULL;
+	}
+
+	return file;
+}
+
+/**
+ * Add an unloaded file to the cache with a single reference.
+ *   @cache: The cache.
+ *   @path: The path.
+ *   @chan: The channel.
+ *   @rate: The sample rate.
+ *   @quality: The resampling quality.
+ *   @head: The head length.
+ *   @decode: The decode flag.
+ *   &returns: The file.
+ */
+static struct amp_file_t *cache_add(struct amp_cache_t *cache, const char *path, unsigned int chan, unsigned int rate, unsigned int quality, unsigned int head, bool decode)
+{
+	unsigned int i, n;
+	struct amp_file_t *file, *next, **table;
+
+	file = malloc(sizeof(struct amp_file_t));
+	file->refcnt = 1;
+	file->buf = (struct acw_buf_t){ .raw = NULL, .map = 0 };
+	file->rate = rate;
+	file->quality = quality;
+	file->sinc = NULL;
+	file->dsp = NULL;
+	file->head = head;
+	file->len = file->off = 0;
+	file->base = 0;
+	file->decode = decode;
+	file->cache = cache;
+	file->chan = chan;
+	file->path = strdup(path);
+	file->hash = cache_hash(path, chan, rate, quality, head, decode);
+	file->hashed = true;
+	file->pending = false;
+	file->err = NULL;
+
+	if(!cache_stat(path, &file->mtime, &file->size))
+		file->mtime = file->size = -1;
+
+	if(++cache->nfiles > cache->nbuckets) {
+		n = 2 * cache->nbuckets;
+		table = calloc(n, sizeof(struct amp_file_t *));
+
+		for(i = 0; i < cache->nbuckets; i++) {
+			for(; cache->table[i] != NULL; cache->table[i] = next) {
+				next = cache->table[i]->next;
+				cache->table[i]->next = table[cache->table[i]->hash & (n - 1)];
+				table[cache->table[i]->hash & (n - 1)] = cache->table[i];
+			}
+		}
+
+		free(cache->table);
+		cache->table = table;
+		cache->nbuckets = n;
+	}
+
+	file->next = cache->table[file->hash & (cache->nbuckets - 1)];
+	cache->table[file->hash & (cache->nbuckets - 1)] = file;
+
+	return file;
+}
+
+/**
+ * Remove a file from the hash table.
+ *   @cache: The cache.
+ *   @file: The file.
+ */
+static void cache_unhash(struct amp_cache_t *cache, struct amp_file_t *file)
+{
+	struct amp_file_t **ptr;
+
+	for(ptr = &cache->table[file->hash & (cache->nbuckets - 1)]; *ptr != file; ptr = &(*ptr)->next)
+		;
+
+	*ptr = file->next;
+	file->hashed = false;
+	cache->nfiles--;
+}
+
+/**
+ * Evict the least recently used idle files until the budget is met.
+ *   @cache: The cache.
+ */
+static void cache_trim(struct amp_cache_t *cache)
+{
+	struct amp_file_t *file;
+
+	while((cache->nidle > cache->budget) && (cache->idle.head != NULL)) {
+		file = list_node_ref(cache->idle.head, offsetof(struct amp_file_t, node));
+		list_root_remove(&cache->idle, &file->node);
+		cache->nidle -= file->off;
+
+		cache_unhash(cache, file);
+		cache_free(file);
+	}
+}
+
+/**
+ * Free a file.
+ *   @file: The file.
+ */
+static void cache_free(struct amp_file_t *file)
+{
+	unsigned int i;
+
+	if(file->sinc != NULL)
+		dsp_sinc_delete(file->sinc);
+
+	if(file->dsp != NULL) {
+		for(i = 0; i < file->buf.info.chan; i++)
+			dsp_buf_delete(file->dsp[i]);
+
+		free(file->dsp);
+	}
+
+	if(file->buf.raw != NULL)
+		acw_buf_delete(file->buf);
+
+	free(file->path);
+	free(file);
+}
+
+/**
+ * Retrieve the modification time and size of a file.
+ *   @path: The path.
+ *   @mtime: Out. The modification time.
+ *   @size: Out. The size.
+ *   &returns: True if successful.
+ */
+static bool cache_stat(const char *path, int64_t *mtime, int64_t *size)
+{
+	struct stat info;
+
+	if(stat(path, &info) < 0)
+		return false;
+
+	*mtime = info.st_mtime;
+	*size = info.st_size;
+
+	return true;
+}
+
+
+/**
+ * Loader thread.
+ *   @arg: The cache.
+ *   &returns: Always null.
+ */
+static void *cache_thread(void *arg)
+{
+	struct amp_cache_t *cache = arg;
+	struct amp_file_t *file;
+
+	sys_mutex_lock(&cache->lock);
+
+	while(true) {
+		while((cache->head == NULL) && !cache->term)
+			sys_cond_wait(&cache->cond, &cache->lock);
+
+		if(cache->head == NULL)
+			break;
+
+		file = cache->head;
+		cache->head = file->job;
+		if(cache->head == NULL)
+			cache->tail = NULL;
+
+		sys_mutex_unlock(&cache->lock);
+		cache_load(cache, file);
+		sys_mutex_lock(&cache->lock);
+
+		file->job = cache->done;
+		cache->done = file;
+		sys_cond_signal(&cache->finish);
+	}
+
+	sys_mutex_unlock(&cache->lock);
+
+	return NULL;
+}
+
+/**
+ * Load a file, called from a loader thread. On failure, the error is set and
+ * the buffer is left empty.
+ *   @cache: The cache.
+ *   @file: The file.
+ */
+static void cache_load(struct amp_cache_t *cache, struct amp_file_t *file)
+{
+	size_t size;
+	struct acw_buf_t buf;
+
+	if(file->head > 0) {
+		file->err = cache_head(&buf, &file->len, &file->off, &file->base, file->path, file->chan, file->head);
+		if(file->err != NULL)
+			return;
+	}
+	else {
+		file->err = acw_buf_map(&buf, file->path, cache->flags);
+		if(file->err != NULL)
+			return;
+
+		if(file->chan >= buf.info.chan) {
+			file->err = mprintf("File '%s' has no channel %u.", file->path, file->chan);
+			acw_buf_delete(buf);
+
+			return;
+		}
+
+		file->len = buf.info.length;
+		file->off = buf.info.nbytes;
+	}
+
+	if(file->decode) {
+		file->dsp = cache_decode(buf, file->rate, &size);
+		file->off = size;
+		acw_buf_delete(buf);
+
+		file->buf = (struct acw_buf_t){ .info = buf.info, .raw = NULL, .map = 0 };
+	}
+	else {
+		file->buf = buf;
+		if((buf.info.rate > 0) && (buf.info.rate != file->rate))
+			file->sinc = dsp_sinc_new(file->quality, (double)buf.info.rate / (double)file->rate);
+	}
+}
+
+/**
+ * Load the head of a channel. Whole blocks are read until the head length is
+ * covered, growing the buffer as they are read, and the buffer is terminated
+ * so that it plays as a complete single channel file.
+ *   @buf: Out. The buffer.
+ *   @len: Out. The number of samples loaded.
+ *   @off: Out. The number of bytes loaded.
+ *   @base: Out. The file offset of the channel's block data.
+ *   @path: The path.
+ *   @chan: The channel.
+ *   @head: The head length.
+ *   &returns: Error.
+ */
+static char *cache_head(struct acw_buf_t *buf, unsigned int *len, unsigned int *off, long *base, const char *path, unsigned int chan, unsigned int head)
+{
+#define onexit fclose(file); free(buf->raw);
+	FILE *file;
+	uint32_t pos = 0;
+	unsigned int size, nsamp, cap;
+
+	file = fopen(path, "r");
+	if(file == NULL)
+		return mprintf("Unable to open '%s'. %s.", path, strerror(errno));
+
+	buf->raw = NULL;
+	buf->map = 0;
+
+	chkfail(acw_info_read(&buf->info, file, path));
+
+	if(chan >= buf->info.chan)
+		fail("File '%s' has no channel %u.", path, chan);
+
+	*base = acw_info_size(buf->info.magic);
+	if(buf->info.magic == ACW_MAGIC_1_2) {
+		if((fseek(file, *base + buf->info.nbytes + chan * sizeof(uint32_t), SEEK_SET) < 0) || (fread(&pos, sizeof(uint32_t), 1, file) < 1))
+			fail("Failed to read from '%s'. Truncated file.", path);
+		else if((pos >= buf->info.nbytes) || (fseek(file, *base + pos, SEEK_SET) < 0))
+			fail("Failed to read from '%s'. Invalid channel.", path);
+
+		*base += pos;
+	}
+
+	buf->info.magic = ACW_MAGIC_1_0;
+	buf->info.chan = 1;
+	*len = *off = 0;
+	cap = 4;
+	buf->raw = malloc(cap);
+
+	while((*len < head) && (*len < buf->info.length)) {
+		if((*off + AMP_STREAM_BLOCK + 4) > cap) {
+			cap = m_min_u(m_max_u(2 * cap, *off + AMP_STREAM_BLOCK + 4), buf->info.nbytes - pos + 4);
+			buf->raw = realloc(buf->raw, cap);
+		}
+
+		if(((pos + *off + 6) > buf->info.nbytes) || (fread(buf->raw + *off, 1, 2, file) < 2))
+			fail("Failed to read from '%s'. Truncated file.", path);
+
+		if((*(uint16_t *)(buf->raw + *off) >> 12) != ACW_24BIT) {
+			if(fread(buf->raw + *off + 2, 1, 4, file) < 4)
+				fail("Failed to read from '%s'. Truncated file.", path);
+
+			size = acw_block_size(buf->raw + *off, &nsamp);
+			if((size == 0) || ((pos + *off + size) > buf->info.nbytes) || (fread(buf->raw + *off + 6, 1, size - 6, file) < (size - 6)))
+				fail("Failed to read from '%s'. Invalid block.", path);
+		}
+		else {
+			size = acw_block_size(buf->raw + *off, &nsamp);
+			if((nsamp == 0) || ((pos + *off + size) > buf->info.nbytes) || (fread(buf->raw + *off + 2, 1, size - 2, file) < (size - 2)))
+				fail("Failed to read from '%s'. Invalid block.", path);
+		}
+
+		*len += nsamp;
+		*off += size;
+	}
+
+	fclose(file);
+
+	*(uint16_t *)(buf->raw + *off) = ACW_24BIT << 12;
+	buf->raw = realloc(buf->raw, *off + 4);
+
+	return NULL;
+#undef onexit
+}
+
+/**
+ * Decode every channel of an ACW buffer into sample buffers in one pass,
+ * converting files with a known rate to the sample rate.
+ *   @buf: The ACW buffer.
+ *   @rate: The sample rate.
+ *   @size: Out. The number of bytes held by the sample buffers.
+ *   &returns: The sample buffer array, one per channel.
+ */
+static struct dsp_buf_t **cache_decode(struct acw_buf_t buf, unsigned int rate, size_t *size)
+{
+	float *tmp;
+	int32_t *pcm;
+	unsigned int i, c, len;
+	struct dsp_buf_t **dsp;
+	bool conv = (buf.info.rate > 0) && (buf.info.rate != rate);
+
+	pcm = acw_buf_pcm32(buf);
+	dsp = malloc(buf.info.chan * sizeof(struct dsp_buf_t *));
+	len = conv ? dsp_rerate(buf.info.length, rate, buf.info.rate) : buf.info.length;
+	tmp = conv ? malloc(buf.info.length * sizeof(float)) : NULL;
+	*size = 0;
+
+	for(c = 0; c < buf.info.chan; c++) {
+		dsp[c] = dsp_buf_new(len);
+
+		for(i = 0; i < buf.info.length; i++)
+			(conv ? tmp : dsp[c]->arr)[i] = (float)pcm[i * buf.info.chan + c] / (float)(1 << 23);
+
+		if(conv)
+			dsp_rerate_f(dsp[c]->arr, len, rate, tmp, buf.info.length, buf.info.rate);
+
+		*size += len * sizeof(float);
+	}
+
+	if(conv)
+		free(tmp);
+
+	free(pcm);
+
+	return dsp;
+}
+
+
+/**
+ * Create a stream. The ring holds 'AMP_STREAM_AHEAD' seconds at the sample
+ * rate, plus room for a kick period and a whole block.
+ *   @io: The I/O manager.
+ *   @rate: The sample rate.
+ *   &returns: The stream.
+ */
+struct amp_stream_t *amp_stream_new(struct amp_io_t *io, unsigned int rate)
+{
+	unsigned int len;
+	struct amp_stream_t *stream;
+
+	len = AMP_STREAM_AHEAD * rate + AMP_STREAM_KICK + AMP_STREAM_NSAMP;
+
+	stream = malloc(sizeof(struct amp_stream_t));
+	stream->len = 1;
+	while(stream->len < len)
+		stream->len *= 2;
+
+	stream->ring = malloc(stream->len * sizeof(float));
+	stream->io = io;
+	stream->file = NULL;
+	stream->req = stream->ack = 0;
+	stream->rd = stream->wr = stream->left = 0;
+	stream->underrun = 0;
+	stream->fp = NULL;
+	amp_io_attach(io, stream);
+
+	return stream;
+}
+
+/**
+ * Delete a stream.
+ *   @stream: The stream.
+ */
+void amp_stream_delete(struct amp_stream_t *stream)
+{
+	amp_io_detach(stream->io, stream);
+
+	if(stream->fp != NULL)
+		fclose(stream->fp);
+
+	free(stream->ring);
+	free(stream);
+}
+
+
+/**
+ * Start streaming the tail of a file. Called from the audio thread.
+ *   @stream: The stream.
+ *   @file: The file.
+ */
+void amp_stream_start(struct amp_stream_t *stream, struct amp_file_t *file)
+{
+	stream->file = file;
+	__atomic_store_n(&stream->rd, 0, __ATOMIC_RELAXED);
+	stream->left = file->buf.info.length - file->len + 1;
+	__atomic_store_n(&stream->req, stream->req + 1, __ATOMIC_RELEASE);
+
+	amp_io_kick(stream->io);
+}
+
+/**
+ * Stop streaming. Called from the audio thread.
+ *   @stream: The stream.
+ */
+void amp_stream_stop(struct amp_stream_t *stream)
+{
+	stream->file = NULL;
+	stream->left = 0;
+	__atomic_store_n(&stream->req, stream->req + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Kick the I/O thread to refill a stream. Called from the audio thread.
+ *   @stream: The stream.
+ */
+void amp_stream_kick(struct amp_stream_t *stream)
+{
+	amp_io_kick(stream->io);
+}
+
+/**
+ * Fill a stream as far as the ring allows. Called from the I/O thread.
+ *   @stream: The stream.
+ */
+void amp_stream_fill(struct amp_stream_t *stream)
+{
+	unsigned int req;
+	struct amp_file_t *file;
+
+	req = __atomic_load_n(&stream->req, __ATOMIC_ACQUIRE);
+	if(req != stream->ack) {
+		if(stream->fp != NULL)
+			fclose(stream->fp);
+
+		file = stream->file;
+		stream->fp = (file != NULL) ? fopen(file->path, "r") : NULL;
+		if((stream->fp != NULL) && (fseek(stream->fp, file->base + file->off, SEEK_SET) < 0))
+			fclose(stream->fp), stream->fp = NULL;
+
+		__atomic_store_n(&stream->wr, 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&stream->ack, req, __ATOMIC_RELEASE);
+	}
+
+	while(stream->fp != NULL) {
+		if((stream->wr - __atomic_load_n(&stream->rd, __ATOMIC_ACQUIRE)) > (stream->len - AMP_STREAM_NSAMP))
+			break;
+
+		if(__atomic_load_n(&stream->req, __ATOMIC_RELAXED) != stream->ack)
+			break;
+
+		if(!stream_block(stream))
+			fclose(stream->fp), stream->fp = NULL;
+	}
+}
+
+/**
+ * Retrieve the number of samples not ready in time.
+ *   @stream: The stream.
+ *   &returns: The underrun count.
+ */
+uint64_t amp_stream_underrun(struct amp_stream_t *stream)
+{
+	return __atomic_load_n(&stream->underrun, __ATOMIC_RELAXED);
+}
+
+
+/**
+ * Decode the next block of a stream into the ring.
+ *   @stream: The stream.
+ *   &returns: True if decoded, false at the end of the file or on error.
+ */
+static bool stream_block(struct amp_stream_t *stream)
+{
+	uint8_t raw[AMP_STREAM_BLOCK];
+	int32_t pcm[AMP_STREAM_NSAMP];
+	unsigned int i, size, nsamp, wr;
+	struct acw_play_t play;
+
+	if(fread(raw, 1, 2, stream->fp) < 2)
+		return false;
+
+	if((*(uint16_t *)raw >> 12) != ACW_24BIT) {
+		if(fread(raw + 2, 1, 4, stream->fp) < 4)
+			return false;
+
+		size = acw_block_size(raw, &nsamp);
+		if((size == 0) || (fread(raw + 6, 1, size - 6, stream->fp) < (size - 6)))
+			return false;
+	}
+	else {
+		size = acw_block_size(raw, &nsamp);
+		if((nsamp == 0) || (fread(raw + 2, 1, size - 2, stream->fp) < (size - 2)))
+			return false;
+	}
+
+	play = acw_play_init(raw);
+	acw_play_read(&play, pcm, nsamp);
+	wr = stream->wr;
+
+	for(i = 0; i < nsamp; i++)
+		stream->ring[(wr + i) & (stream->len - 1)] = (float)pcm[i] / (float)(1 << 23);
+
+	__atomic_store_n(&stream->wr, wr + nsamp, __ATOMIC_RELEASE);
+
+	return true;
+}
+
 
 #if 0
 /**
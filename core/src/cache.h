@@ -1,6 +1,23 @@
 #ifndef CACHE_H
 #define CACHE_H
 
+/**
+ * Cache definitions.
+ *   @AMP_CACHE_BUDGET: The default number of bytes held by idle files.
+ *   @AMP_CACHE_THREADS: The minimum number of loader threads.
+ */
+#define AMP_CACHE_BUDGET (256*1024*1024)
+#define AMP_CACHE_THREADS 4
+
+/**
+ * Cache progress callback.
+ *   @arg: The argument.
+ *   @path: The path of the file loaded.
+ *   @done: The number of files loaded.
+ *   @total: The number of files being loaded.
+ */
+typedef void (*amp_cache_f)(void *arg, const char *path, unsigned int done, unsigned int total);
+
 /*
  * cache declarations
  */
@@ -9,9 +26,16 @@ struct amp_cache_t;
 struct amp_cache_t *amp_cache_new(void);
 void amp_cache_delete(struct amp_cache_t *cache);
 
-struct amp_file_t *amp_cache_lookup(struct amp_cache_t *cache, const char *path, unsigned int chan);
+void amp_cache_prefault(struct amp_cache_t *cache, bool enable);
+void amp_cache_budget(struct amp_cache_t *cache, size_t budget);
+void amp_cache_progress(struct amp_cache_t *cache, amp_cache_f func, void *arg);
 
-struct amp_file_t *amp_cache_open(struct amp_cache_t *cache, const char *path, unsigned int chan, unsigned int rate);
+struct amp_file_t *amp_cache_lookup(struct amp_cache_t *cache, const char *path, unsigned int chan, unsigned int rate, unsigned int quality);
+
+struct amp_file_t *amp_cache_open(struct amp_cache_t *cache, const char *path, unsigned int chan, unsigned int rate, unsigned int quality);
+struct amp_file_t *amp_cache_stream(struct amp_cache_t *cache, const char *path, unsigned int chan, unsigned int rate, unsigned int quality, unsigned int head);
+struct amp_file_t *amp_cache_decode(struct amp_cache_t *cache, const char *path, unsigned int rate);
+char *amp_cache_wait(struct amp_cache_t *cache);
 void amp_cache_close(struct amp_cache_t *cache, struct amp_file_t *file);
 
 /*
@@ -23,16 +47,149 @@ struct amp_file_t *amp_file_copy(struct amp_file_t *file);
 void amp_file_delete(struct amp_file_t *file);
 
 struct acw_buf_t amp_file_buf(struct amp_file_t *file);
+unsigned int amp_file_chan(struct amp_file_t *file);
+const struct dsp_sinc_t *amp_file_sinc(struct amp_file_t *file);
+unsigned int amp_file_nchan(struct amp_file_t *file);
+const struct dsp_buf_t *amp_file_dsp(struct amp_file_t *file, unsigned int chan);
+bool amp_file_tail(struct amp_file_t *file);
+
+
+/**
+ * Stream definitions.
+ *   @AMP_STREAM_AHEAD: The time decoded ahead of playback in seconds.
+ *   @AMP_STREAM_KICK: The number of samples read between kicks.
+ *   @AMP_STREAM_NSAMP: The largest number of samples in an ACW block.
+ *   @AMP_STREAM_BLOCK: The largest ACW block in bytes.
+ */
+#define AMP_STREAM_AHEAD 0.1
+#define AMP_STREAM_KICK 1024
+#define AMP_STREAM_NSAMP 0x1000
+#define AMP_STREAM_BLOCK (2 + 3 * 0x0FFF + 4)
+
+/**
+ * Stream structure. The tail of a streamed file is decoded by the I/O thread
+ * into the ring, which the audio thread reads without locking. The request
+ * counter is only written by the audio thread, and the acknowledgement and
+ * write index only by the I/O thread.
+ *   @io: The I/O manager.
+ *   @file: The requested file.
+ *   @req, ack: The request and acknowledged request counters.
+ *   @rd, wr, left: The read index, write index, and samples left to read,
+ *     including the final end of stream read.
+ *   @underrun: The number of samples not ready in time.
+ *   @fp: The open file, I/O thread only.
+ *   @len, ring: The ring length, a power of two, and the sample ring.
+ *   @node: The I/O list node.
+ */
+struct amp_stream_t {
+	struct amp_io_t *io;
+	struct amp_file_t *file;
+
+	unsigned int req, ack;
+	unsigned int rd, wr, left;
+	uint64_t underrun;
+
+	FILE *fp;
+	unsigned int len;
+	float *ring;
+
+	struct list_node_t node;
+};
+
+/*
+ * stream declarations
+ */
+struct amp_stream_t *amp_stream_new(struct amp_io_t *io, unsigned int rate);
+void amp_stream_delete(struct amp_stream_t *stream);
+
+void amp_stream_start(struct amp_stream_t *stream, struct amp_file_t *file);
+void amp_stream_stop(struct amp_stream_t *stream);
+void amp_stream_kick(struct amp_stream_t *stream);
+void amp_stream_fill(struct amp_stream_t *stream);
+uint64_t amp_stream_underrun(struct amp_stream_t *stream);
+
+/**
+ * Read the next sample from a stream. If the sample has not been decoded yet,
+ * silence is returned and the underrun is counted. As with an in-memory
+ * player, the end is reached by reading one sample past the last.
+ *   @stream: The stream.
+ *   &returns: The sample.
+ */
+static inline float amp_stream_next(struct amp_stream_t *stream)
+{
+	float val;
+
+	if(stream->left <= 1) {
+		stream->left = 0;
+
+		return 0.0f;
+	}
+
+	if((__atomic_load_n(&stream->ack, __ATOMIC_ACQUIRE) != stream->req) || (stream->rd == __atomic_load_n(&stream->wr, __ATOMIC_ACQUIRE))) {
+		if((__atomic_add_fetch(&stream->underrun, 1, __ATOMIC_RELAXED) % AMP_STREAM_KICK) == 1)
+			amp_stream_kick(stream);
+
+		return 0.0f;
+	}
+
+	val = stream->ring[stream->rd & (stream->len - 1)];
+	__atomic_store_n(&stream->rd, stream->rd + 1, __ATOMIC_RELEASE);
+	stream->left--;
+
+	if((stream->rd % AMP_STREAM_KICK) == 0)
+		amp_stream_kick(stream);
+
+	return val;
+}
 
+/**
+ * Check if a stream has reached the end.
+ *   @stream: The stream.
+ *   &returns: True if at the end.
+ */
+static inline bool amp_stream_eos(struct amp_stream_t *stream)
+{
+	return stream->left == 0;
+}
+
+
+/**
+ * Player definitions.
+ *   @AMP_PLAY_CHUNK: The number of samples decoded at once.
+ */
+#define AMP_PLAY_CHUNK 64
 
 /**
- * Player structure.
+ * Player structure. Samples are decoded a chunk at a time and read from the
+ * chunk into a history window, which is doubled so that the last 'ntaps'
+ * samples are always contiguous. Files with a resampler table are played
+ * through it, and all others are linearly interpolated.
  *   @acw: The ACW player.
- *   @
+ *   @stream: Optional. The stream for files with a tail on disk.
+ *   @tail: Flag indicating the tail is read from the stream.
+ *   @done: Flag indicating the ACW player has been read past its end.
+ *   @rd, cnt: The read index and number of samples in the chunk.
+ *   @chunk: The decoded chunk.
+ *   @sinc: The resampler table, null for linear interpolation.
+ *   @ntaps, wr, pad: The window length, write index, and number of samples
+ *     still to read after the end.
+ *   @frac, ratio: The position in the window and the rate ratio.
+ *   @hist: The history window.
+ *   @vol, mul: The volume and decay multiplier.
  */
 struct amp_play_t {
 	struct acw_play_t acw;
-	float idx, ratio, prev, next;
+	struct amp_stream_t *stream;
+	bool tail, done;
+
+	unsigned int rd, cnt;
+	int32_t chunk[AMP_PLAY_CHUNK];
+
+	const struct dsp_sinc_t *sinc;
+	unsigned int ntaps, wr, pad;
+	float frac, ratio;
+	float hist[2 * DSP_SINC_MAX];
+
 	float vol, mul;
 };
 
@@ -45,67 +202,161 @@ static inline void amp_play_init(struct amp_play_t *play, unsigned int n)
 {
 	unsigned int i;
 
-	for(i = 0; i < n; i++)
+	for(i = 0; i < n; i++) {
 		play[i].vol = 0.0;
+		play[i].stream = NULL;
+		play[i].tail = false;
+	}
 }
 
 /**
- * Add to a playback.
- *   @play: The playback array.
- *   @n: The number of players.
- *   @buf: The buffer.
+ * Start a player on a file. If the file has a tail on disk and the player
+ * has a stream, the stream is started to continue after the head. Files with
+ * an unknown rate are played at the given rate.
+ *   @play: The player.
+ *   @file: The file.
  *   @vol: The initial volume.
  *   @rate: The sample rate.
- *   &returns: The allocated number.
  */
-static inline unsigned int amp_play_add(struct amp_play_t *play, unsigned int n, struct acw_buf_t buf, float vol, float rate)
+static inline void amp_play_start(struct amp_play_t *play, struct amp_file_t *file, float vol, float rate)
 {
-	double min = INFINITY;
-	unsigned int i, sel = 0;
+	struct acw_buf_t buf;
 
-	for(i = 0; i < n; i++) {
-		if(play[i].vol < min)
-			sel = i, min = play[i].vol;
+	if(play->tail)
+		amp_stream_stop(play->stream);
+
+	buf = amp_file_buf(file);
+	play->acw = acw_play_init(acw_buf_chan(buf, amp_file_chan(file)));
+	play->tail = play->done = false;
+	play->rd = play->cnt = 0;
+	play->sinc = amp_file_sinc(file);
+	play->ntaps = (play->sinc != NULL) ? play->sinc->ntaps : 2;
+	play->pad = (play->sinc != NULL) ? dsp_sinc_delay(play->sinc) : 0;
+	play->wr = 0;
+	play->frac = 0.0f;
+	play->ratio = (buf.info.rate > 0) ? (buf.info.rate / rate) : 1.0f;
+	play->vol = vol;
+	play->mul = 1.0f;
+	dsp_zero_f(play->hist, 2 * play->ntaps);
+
+	if((play->stream != NULL) && amp_file_tail(file)) {
+		play->tail = true;
+		amp_stream_start(play->stream, file);
 	}
+}
+
+/**
+ * Fetch the next source sample for a player.
+ *   @play: The player.
+ *   &returns: The sample.
+ */
+static inline float amp_play_fetch(struct amp_play_t *play)
+{
+	if(play->rd == play->cnt) {
+		if(!play->done) {
+			play->rd = 0;
+			play->cnt = acw_play_read(&play->acw, play->chunk, AMP_PLAY_CHUNK);
+			play->done = (play->cnt == 0);
+		}
 
-	buf.info.rate = 44100;
-	play[sel] = (struct amp_play_t){ acw_play_init(buf.raw), 0.0f, buf.info.rate / rate, 0.0f, 0.0f, vol, 1.0f };
+		if(play->done)
+			return play->tail ? amp_stream_next(play->stream) : 0.0f;
+	}
 
-	return sel;
+	return (float)play->chunk[play->rd++] / (float)(1 << 23);
 }
 
 /**
- * Process the playback.
- *   @play: The playback array.
- *   @n: The number of players.
- *   &returns: The value.
+ * Check if a player has reached the end of its source.
+ *   @play: The player.
+ *   &returns: True if at the end.
  */
-static inline double amp_play_proc(struct amp_play_t *play, unsigned int n)
+static inline bool amp_play_eos(struct amp_play_t *play)
 {
-	unsigned int i;
-	double v = 0.0;
+	return play->done && (!play->tail || amp_stream_eos(play->stream));
+}
 
-	for(i = 0; i < n; i++) {
-		if(play[i].vol == 0.0)
-			continue;
+/**
+ * Check if a player has finished, having played out the end of its source
+ * through the resampler.
+ *   @play: The player.
+ *   &returns: True if finished.
+ */
+static inline bool amp_play_finished(struct amp_play_t *play)
+{
+	return amp_play_eos(play) && (play->pad == 0);
+}
 
-		if(floorf(play[i].idx * play[i].ratio) != floorf((play[i].idx-1.0f) * play[i].ratio)) {
-			play[i].prev = play[i].next;
-			play[i].next = (float)acw_play_next(&play[i].acw) / (float)(1 << 23);
+/**
+ * Compute the next output of a player, reading as many source samples into
+ * the history window as the rate ratio requires.
+ *   @play: The player.
+ *   &returns: The value.
+ */
+static inline float amp_play_next(struct amp_play_t *play)
+{
+	float val;
+	const float *x;
+
+	for(play->frac += play->ratio; play->frac >= 1.0f; play->frac -= 1.0f) {
+		if(!amp_play_eos(play))
+			val = amp_play_fetch(play);
+		else {
+			val = 0.0f;
+			if(play->pad > 0)
+				play->pad--;
 		}
 
-		float r = play[i].idx - floorf(play[i].idx);
-		float val = play[i].prev * (1.0 - r) + r * play[i].next;
+		play->hist[play->wr] = play->hist[play->wr + play->ntaps] = val;
+		if(++play->wr == play->ntaps)
+			play->wr = 0;
+	}
+
+	x = play->hist + play->wr;
+	if(play->sinc != NULL)
+		return dsp_sinc_eval(play->sinc, x, play->frac);
+	else
+		return x[0] + play->frac * (x[1] - x[0]);
+}
+
+/**
+ * Stop a player, releasing its stream.
+ *   @play: The player.
+ */
+static inline void amp_play_stop(struct amp_play_t *play)
+{
+	play->vol = 0.0f;
+
+	if(play->tail) {
+		play->tail = false;
+		amp_stream_stop(play->stream);
+	}
+}
+
+/**
+ * Process a player over a run, adding into the buffer. The player is
+ * stopped once finished or silent.
+ *   @play: The player.
+ *   @buf: The buffer.
+ *   @len: The length.
+ *   &returns: True if still playing.
+ */
+static inline bool amp_play_run(struct amp_play_t *play, dsp_sample_t *buf, unsigned int len)
+{
+	unsigned int i;
+
+	for(i = 0; i < len; i++) {
+		buf[i] += play->vol * amp_play_next(play);
 
-		v += play[i].vol * val;
+		play->vol *= play->mul;
+		if(amp_play_finished(play) || (play->vol < 0.001)) {
+			amp_play_stop(play);
 
-		play[i].idx++;
-		play[i].vol *= play[i].mul;
-		if(acw_play_eos(&play[i].acw) || (play[i].vol < 0.001))
-			play[i].vol = 0.0f;
+			return false;
+		}
 	}
-	
-	return v;
+
+	return true;
 }
 
 #endif
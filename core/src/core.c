@@ -97,7 +97,9 @@ static const struct pair_t list[] = {
 	{ "BpcfV",    amp_bpcf_make },
 	{ "Bpcf2V",   amp_bpcf2_make },
 	{ "CombV",    amp_comb_make },
+	{ "Conv",     amp_conv_make },
 	{ "DelayV",   amp_delay_make },
+	{ "Fdn",      amp_fdn_make },
 	{ "LpcfV",    amp_lpcf_make },
 	{ "RescfV",   amp_rescf_make },
 	/* polymorphic */
@@ -132,8 +134,10 @@ struct amp_core_t *amp_core_new(unsigned int rate)
 
 	core = malloc(sizeof(struct amp_core_t));
 	core->env = ml_env_new();
-	//core->io = amp_io_new();
+	core->io = amp_io_new();
 	core->cache = amp_cache_new();
+	core->pool = amp_pool_new(amp_pool_ncpu() - 1);
+	core->prof = amp_prof_new();
 	core->plugin = NULL;
 
 	ml_env_add(&core->env, strdup("amp.rate"), ml_value_num(rate, ml_tag_copy(ml_tag_null)));
@@ -219,7 +223,9 @@ void amp_core_delete(struct amp_core_t *core)
 
 	ml_env_delete(core->env);
 	amp_cache_delete(core->cache);
-	//amp_io_delete(core->io);
+	amp_pool_delete(core->pool);
+	amp_prof_delete(core->prof);
+	amp_io_delete(core->io);
 	free(core);
 }
 
@@ -262,6 +268,95 @@ unsigned int amp_core_rate(struct ml_env_t *env)
 	return value->data.num;
 }
 
+/**
+ * Retrieve the stream head length from the environment. Sample libraries
+ * only keep this many seconds of each file in memory when set.
+ *   @env: The environment.
+ *   &returns: The head length in seconds, zero if streaming is disabled.
+ */
+double amp_core_stream(struct ml_env_t *env)
+{
+	struct ml_value_t *value;
+
+	value = ml_env_lookup(env, "amp.stream");
+	if((value == NULL) || !ml_value_isnum(value))
+		return 0.0;
+
+	return fmax(ml_value_getflt(value), 0.0);
+}
+
+/**
+ * Retrieve the resampling quality from the environment. Samples recorded at
+ * another rate are played through a resampler of this quality.
+ *   @env: The environment.
+ *   &returns: The quality, medium if unset.
+ */
+unsigned int amp_core_quality(struct ml_env_t *env)
+{
+	struct ml_value_t *value;
+
+	value = ml_env_lookup(env, "amp.quality");
+	if((value == NULL) || !ml_value_isnum(value))
+		return DSP_SINC_MED;
+
+	return fmin(fmax(ml_value_getflt(value), DSP_SINC_LINEAR), DSP_SINC_HIGH);
+}
+
+/**
+ * Retrieve the voice stealing policy from the environment.
+ *   @env: The environment.
+ *   @def: The default policy if unset.
+ *   &returns: The policy.
+ */
+enum amp_steal_e amp_core_steal(struct ml_env_t *env, enum amp_steal_e def)
+{
+	enum amp_steal_e steal;
+	struct ml_value_t *value;
+
+	value = ml_env_lookup(env, "amp.steal");
+	if((value == NULL) || (value->type != ml_value_str_v))
+		return def;
+
+	if(!amp_steal_get(value->data.str, &steal))
+		return fprintf(stderr, "Unknown stealing policy '%s'.\n", value->data.str), def;
+
+	return steal;
+}
+
+/**
+ * Retrieve the control period from the environment. Modulated filters compute
+ * their coefficients once per period and ramp them in between.
+ *   @env: The environment.
+ *   &returns: The period in samples, one for audio rate.
+ */
+unsigned int amp_core_control(struct ml_env_t *env)
+{
+	struct ml_value_t *value;
+
+	value = ml_env_lookup(env, "amp.control");
+	if((value == NULL) || !ml_value_isnum(value))
+		return DSP_COEF_LEN;
+
+	return fmin(fmax(ml_value_getflt(value), 1.0), AMP_CONTROL_MAX);
+}
+
+/**
+ * Retrieve the offload flag from the environment. Convolutions compute the
+ * later stages of their impulse response on a worker thread when set.
+ *   @env: The environment.
+ *   &returns: The flag, set by default on machines with more than one core.
+ */
+bool amp_core_offload(struct ml_env_t *env)
+{
+	struct ml_value_t *value;
+
+	value = ml_env_lookup(env, "amp.offload");
+	if((value == NULL) || (value->type != ml_value_bool_v))
+		return amp_pool_ncpu() > 1;
+
+	return value->data.flag;
+}
+
 /**
  * Retrieve the cache from the environment.
  *   @env: The environment.
@@ -283,7 +378,8 @@ struct amp_cache_t *amp_core_cache(struct ml_env_t *env)
 
 
 /**
- * Evaluate an expression from file.
+ * Evaluate an expression from file. Files opened during evaluation load in
+ * parallel and have all finished loading on return.
  *   @core; The core.
  *   @path: The path.
  *   @err: The error.
@@ -296,6 +392,11 @@ struct ml_env_t *amp_core_eval(struct amp_core_t *core, const char *path, char *
 	env = ml_env_copy(core->env);
 
 	*err = ml_parse_file(&env, path);
+	if(*err == NULL)
+		*err = amp_cache_wait(core->cache);
+	else
+		chkbool(amp_cache_wait(core->cache));
+
 	if(*err == NULL)
 		return env;
 
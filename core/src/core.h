@@ -6,12 +6,16 @@
  *   @env: The environment.
  *   @io: The I/O manager.
  *   @cache: The file cache.
+ *   @pool: The worker pool.
+ *   @prof: The profiler.
  *   @plugin: The plugin list.
  */
 struct amp_core_t {
 	struct ml_env_t *env;
 	struct amp_io_t *io;
 	struct amp_cache_t *cache;
+	struct amp_pool_t *pool;
+	struct amp_prof_t *prof;
 	struct amp_plugin_t *plugin;
 };
 
@@ -31,6 +35,12 @@ struct amp_plugin_t {
  */
 typedef void (*amp_plugin_f)(struct amp_core_t *core);
 
+/**
+ * Core definitions.
+ *   @AMP_CONTROL_MAX: The maximum control period in samples.
+ */
+#define AMP_CONTROL_MAX 4096
+
 
 /*
  * core declarations
@@ -43,6 +53,11 @@ char *amp_core_plugin(struct amp_core_t *core, const char *path);
 
 struct amp_core_t *amp_core_get(struct ml_env_t *env);
 unsigned int amp_core_rate(struct ml_env_t *env);
+double amp_core_stream(struct ml_env_t *env);
+unsigned int amp_core_quality(struct ml_env_t *env);
+enum amp_steal_e amp_core_steal(struct ml_env_t *env, enum amp_steal_e def);
+unsigned int amp_core_control(struct ml_env_t *env);
+bool amp_core_offload(struct ml_env_t *env);
 struct amp_cache_t *amp_core_cache(struct ml_env_t *env);
 
 struct ml_box_t amp_box_ref(void *ref);
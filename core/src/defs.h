@@ -6,6 +6,13 @@
  */
 #include <acw.h>
 
+/*
+ * profiler prototypes
+ */
+struct amp_prof_t;
+
+extern struct amp_prof_t *amp_prof;
+
 
 /**
  * Time structure.
@@ -86,7 +86,7 @@ void amp_bias_info(struct amp_bias_t *bias, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_bias_proc(struct amp_bias_t *bias, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_bias_proc(struct amp_bias_t *bias, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	unsigned int i;
 
@@ -97,7 +97,7 @@ bool amp_bias_proc(struct amp_bias_t *bias, double *buf, struct amp_time_t *time
 			buf[i] += val;
 	}
 	else {
-		double val[len];
+		dsp_sample_t val[len];
 
 		amp_param_proc(bias->value, val, time, len, queue);
 
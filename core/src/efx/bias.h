@@ -21,6 +21,6 @@ void amp_bias_delete(struct amp_bias_t *bias);
 char *amp_bias_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 
 void amp_bias_info(struct amp_bias_t *bias, struct amp_info_t info);
-bool amp_bias_proc(struct amp_bias_t *bias, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_bias_proc(struct amp_bias_t *bias, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 #endif
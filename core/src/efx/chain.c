@@ -159,7 +159,7 @@ void amp_chain_info(struct amp_chain_t *chain, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_chain_proc(struct amp_chain_t *chain, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_chain_proc(struct amp_chain_t *chain, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	bool cont = false;
 	struct amp_chain_inst_t *inst;
@@ -34,6 +34,6 @@ void amp_chain_append(struct amp_chain_t *chain, struct amp_effect_t effect);
 char *amp_chain_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 
 void amp_chain_info(struct amp_chain_t *chain, struct amp_info_t info);
-bool amp_chain_proc(struct amp_chain_t *chain, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_chain_proc(struct amp_chain_t *chain, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 #endif
@@ -13,7 +13,7 @@ const struct amp_effect_i amp_chorus_iface = {
 
 /**
  * Create a chorus effect.
- *   @len: The length in samples.
+ *   @len: The maximum delay in samples.
  *   @osc: Consumed. The oscillator.
  *   @feedback: Consumed. The feedback path.
  *   &returns: The chorus.
@@ -24,7 +24,7 @@ struct amp_chorus_t *amp_chorus_new(unsigned int len, struct amp_param_t *osc, s
 
 	chorus = malloc(sizeof(struct amp_chorus_t));
 	chorus->osc = osc;
-	chorus->ring = dsp_ring_new(len);
+	chorus->ring = dsp_ring_new(m_max_u(len, 1));
 	chorus->feedback = feedback;
 
 	return chorus;
@@ -86,7 +86,10 @@ void amp_chorus_info(struct amp_chorus_t *chorus, struct amp_info_t info)
 }
 
 /**
- * Process a chorus.
+ * Process a chorus. The oscillator crossfades between the oldest sample in
+ * the delay line at zero and the newest at one. The buffer is processed in
+ * runs no longer than the delay, so the oldest samples of a run are read as
+ * a single span.
  *   @chorus: The chorus.
  *   @buf: The buffer.
  *   @time: The time.
@@ -94,23 +97,32 @@ void amp_chorus_info(struct amp_chorus_t *chorus, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_chorus_proc(struct amp_chorus_t *chorus, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_chorus_proc(struct amp_chorus_t *chorus, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
-	unsigned int i;
-	double delay[len], feedback[len];
+	unsigned int i, j, m;
+	dsp_sample_t osc[len], feedback[len];
+	double v[len], x;
 	bool cont = false;
 	struct dsp_ring_t *ring = chorus->ring;
 
-	cont |= amp_param_proc(chorus->osc, delay, time, len, queue);
+	cont |= amp_param_proc(chorus->osc, osc, time, len, queue);
 	cont |= amp_param_proc(chorus->feedback, feedback, time, len, queue);
 
-	for(i = 0; i < len; i++) {
-		double x, v;
+	for(i = 0; i < len; i += m) {
+		m = m_min_u(len - i, ring->len);
+		x = dsp_ring_get(ring, 1);
+		dsp_ring_read(ring, ring->len, v, m);
 
-		v = dsp_ring_getf(ring, dsp_clamp(delay[i], 0.0, 1.0));
-		x = buf[i] + dsp_clamp(feedback[i], 0.0, 0.999) * v;
-		dsp_ring_put(ring, x);
-		buf[i] = v;
+		for(j = 0; j < m; j++) {
+			double r = dsp_clamp(osc[i + j], 0.0, 1.0);
+			double y = v[j] * (1.0 - r) + r * x;
+
+			x = buf[i + j] + dsp_clamp(feedback[i + j], 0.0, 0.999) * y;
+			buf[i + j] = y;
+			v[j] = x;
+		}
+
+		dsp_ring_write(ring, v, m);
 	}
 
 	return cont;
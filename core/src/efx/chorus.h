@@ -23,6 +23,6 @@ void amp_chorus_delete(struct amp_chorus_t *chorus);
 char *amp_chorus_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 
 void amp_chorus_info(struct amp_chorus_t *chorus, struct amp_info_t info);
-bool amp_chorus_proc(struct amp_chorus_t *chorus, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_chorus_proc(struct amp_chorus_t *chorus, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 #endif
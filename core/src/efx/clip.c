@@ -187,7 +187,7 @@ void amp_clip_info(struct amp_clipt *clip, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_clip_proc(struct amp_clipt *clip, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_clip_proc(struct amp_clipt *clip, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	unsigned int i;
 	bool cont = false;
@@ -205,7 +205,7 @@ bool amp_clip_proc(struct amp_clipt *clip, double *buf, struct amp_time_t *time,
 			}
 		}
 		else {
-			double sat[len];
+			dsp_sample_t sat[len];
 
 			cont |= amp_param_proc(clip->sat, sat, time, len, queue);
 
@@ -231,7 +231,7 @@ bool amp_clip_proc(struct amp_clipt *clip, double *buf, struct amp_time_t *time,
 			}
 		}
 		else {
-			double sat[len], dist[len];
+			dsp_sample_t sat[len], dist[len];
 
 			cont |= amp_param_proc(clip->sat, sat, time, len, queue);
 			cont |= amp_param_proc(clip->dist, dist, time, len, queue);
@@ -258,7 +258,7 @@ bool amp_clip_proc(struct amp_clipt *clip, double *buf, struct amp_time_t *time,
 			}
 		}
 		else {
-			double sat[len], dist[len];
+			dsp_sample_t sat[len], dist[len];
 
 			cont |= amp_param_proc(clip->sat, sat, time, len, queue);
 			cont |= amp_param_proc(clip->dist, dist, time, len, queue);
@@ -285,7 +285,7 @@ bool amp_clip_proc(struct amp_clipt *clip, double *buf, struct amp_time_t *time,
 			}
 		}
 		else {
-			double sat[len], dist[len];
+			dsp_sample_t sat[len], dist[len];
 
 			cont |= amp_param_proc(clip->sat, sat, time, len, queue);
 			cont |= amp_param_proc(clip->dist, dist, time, len, queue);
@@ -312,7 +312,7 @@ bool amp_clip_proc(struct amp_clipt *clip, double *buf, struct amp_time_t *time,
 			}
 		}
 		else {
-			double sat[len], dist[len];
+			dsp_sample_t sat[len], dist[len];
 
 			cont |= amp_param_proc(clip->sat, sat, time, len, queue);
 			cont |= amp_param_proc(clip->dist, dist, time, len, queue);
@@ -47,7 +47,7 @@ char *amp_logclip_sym(struct ml_value_t **ret, struct ml_value_t *value, struct
 char *amp_logclip_neg(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 
 void amp_clip_info(struct amp_clipt *clip, struct amp_info_t info);
-bool amp_clip_proc(struct amp_clipt *clip, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_clip_proc(struct amp_clipt *clip, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 
 /**
@@ -118,7 +118,7 @@ void amp_comp_info(struct amp_comp_t *comp, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_comp_proc(struct amp_comp_t *comp, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_comp_proc(struct amp_comp_t *comp, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	double vol, ctrl;
 	unsigned int i;
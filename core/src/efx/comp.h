@@ -11,6 +11,6 @@ void amp_comp_delete(struct amp_comp_t *comp);
 char *amp_comp_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 
 void amp_comp_info(struct amp_comp_t *comp, struct amp_info_t info);
-bool amp_comp_proc(struct amp_comp_t *comp, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_comp_proc(struct amp_comp_t *comp, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 #endif
@@ -88,7 +88,7 @@ void amp_cont_info(struct amp_cont_t *cont, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_cont_proc(struct amp_cont_t *cont, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_cont_proc(struct amp_cont_t *cont, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	unsigned int i;
 	bool flag= false;
@@ -15,6 +15,6 @@ void amp_cont_delete(struct amp_cont_t *cont);
 char *amp_cont_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 
 void amp_cont_info(struct amp_cont_t *cont, struct amp_info_t info);
-bool amp_cont_proc(struct amp_cont_t *cont, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_cont_proc(struct amp_cont_t *cont, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 #endif
@@ -0,0 +1,254 @@
+#include "../common.h"
+
+
+/**
+ * Convolution structure.
+ *   @file: The impulse response file.
+ *   @chan: The channel of the file.
+ *   @offload: Flag indicating deferred stages run on a worker thread.
+ *   @ir: The partitioned impulse response.
+ *   @conv: The convolution.
+ *   @quiet: The number of samples since the last nonzero input.
+ *   @term, kick: The terminate and kick flags.
+ *   @lock: The worker lock.
+ *   @cond: The worker condition variable.
+ *   @thread: The worker thread.
+ */
+struct amp_conv_t {
+	struct amp_file_t *file;
+	unsigned int chan;
+	bool offload;
+
+	struct dsp_ir_t *ir;
+	struct dsp_conv_t *conv;
+	unsigned int quiet;
+
+	bool term, kick;
+	sys_mutex_t lock;
+	sys_cond_t cond;
+	sys_thread_t thread;
+};
+
+
+/*
+ * local declarations
+ */
+static void conv_kick(struct amp_conv_t *conv);
+static void *conv_thread(void *arg);
+
+
+/*
+ * global variables
+ */
+const struct amp_effect_i amp_conv_iface = {
+	(amp_info_f)amp_conv_info,
+	(amp_effect_f)amp_conv_proc,
+	(amp_copy_f)amp_conv_copy,
+	(amp_delete_f)amp_conv_delete
+};
+
+
+/**
+ * Create a convolution effect. The impulse response is partitioned once the
+ * effect is initialized.
+ *   @file: Consumed. The impulse response file.
+ *   @chan: The channel.
+ *   @offload: Flag to run deferred stages on a worker thread.
+ *   &returns: The convolution.
+ */
+struct amp_conv_t *amp_conv_new(struct amp_file_t *file, unsigned int chan, bool offload)
+{
+	struct amp_conv_t *conv;
+
+	conv = malloc(sizeof(struct amp_conv_t));
+	conv->file = file;
+	conv->chan = chan;
+	conv->offload = offload;
+	conv->ir = NULL;
+	conv->conv = NULL;
+	conv->quiet = UINT_MAX;
+	conv->term = conv->kick = false;
+
+	return conv;
+}
+
+/**
+ * Copy a convolution effect.
+ *   @conv: The original convolution.
+ *   &returns: The copied convolution.
+ */
+struct amp_conv_t *amp_conv_copy(struct amp_conv_t *conv)
+{
+	return amp_conv_new(amp_file_copy(conv->file), conv->chan, conv->offload);
+}
+
+/**
+ * Delete a convolution effect.
+ *   @conv: The convolution.
+ */
+void amp_conv_delete(struct amp_conv_t *conv)
+{
+	if(conv->conv != NULL) {
+		if(conv->offload) {
+			sys_mutex_lock(&conv->lock);
+			conv->term = true;
+			sys_cond_signal(&conv->cond);
+			sys_mutex_unlock(&conv->lock);
+
+			sys_thread_join(&conv->thread);
+			sys_mutex_destroy(&conv->lock);
+			sys_cond_destroy(&conv->cond);
+		}
+
+		dsp_conv_delete(conv->conv);
+		dsp_ir_delete(conv->ir);
+	}
+
+	amp_file_delete(conv->file);
+	free(conv);
+}
+
+
+/**
+ * Create a convolution from a value.
+ *   @ret: Ref. The returned value.
+ *   @value: The value.
+ *   @env: The environment.
+ *   &returns: Error.
+ */
+char *amp_conv_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env)
+{
+#define onexit
+	char *path;
+	int chan = 0;
+	struct amp_file_t *file;
+
+	if(value->type == ml_value_str_v)
+		chkfail(amp_match_unpack(value, "s", &path));
+	else
+		chkfail(amp_match_unpack(value, "(s,d)", &path, &chan));
+
+	if(chan < 0) {
+		free(path);
+		fail("%C: Invalid channel %d.", ml_tag_chunk(&value->tag), chan);
+	}
+
+	file = amp_cache_decode(amp_core_cache(env), path, amp_core_rate(env));
+	free(path);
+
+	*ret = amp_pack_effect(amp_conv_effect(amp_conv_new(file, chan, amp_core_offload(env))));
+	return NULL;
+#undef onexit
+}
+
+
+/**
+ * Handle information on a convolution.
+ *   @conv: The convolution.
+ *   @info: The information.
+ */
+void amp_conv_info(struct amp_conv_t *conv, struct amp_info_t info)
+{
+	const struct dsp_buf_t *buf;
+
+	if(info.type != amp_info_init_e)
+		return;
+
+	if(conv->conv != NULL)
+		return;
+
+	buf = amp_file_dsp(conv->file, conv->chan);
+	if(buf == NULL) {
+		if(amp_file_nchan(conv->file) > 0)
+			fprintf(stderr, "Impulse response has no channel %u.\n", conv->chan);
+
+		return;
+	}
+
+	conv->ir = dsp_ir_new(buf->arr, buf->len, DSP_CONV_BLOCK);
+	conv->conv = dsp_conv_new(conv->ir, conv->offload);
+
+	if(conv->offload) {
+		conv->lock = sys_mutex_init(0);
+		conv->cond = sys_cond_init(0);
+		conv->thread = sys_thread_create(0, conv_thread, conv);
+	}
+}
+
+/**
+ * Process a convolution. The buffer is replaced by the convolved signal.
+ *   @conv: The convolution.
+ *   @buf: The buffer.
+ *   @time: The time.
+ *   @len: The length.
+ *   @queue: The action queue.
+ *   &returns: The continuation flag, set while the response rings out.
+ */
+bool amp_conv_proc(struct amp_conv_t *conv, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+{
+	unsigned int i;
+
+	if(conv->conv == NULL) {
+		dsp_zero_s(buf, len);
+		return false;
+	}
+
+	for(i = len; i > 0; i--) {
+		if(buf[i - 1] != 0.0)
+			break;
+	}
+
+	if(i > 0)
+		conv->quiet = len - i;
+	else if(conv->quiet < UINT_MAX - len)
+		conv->quiet += len;
+	else
+		conv->quiet = UINT_MAX;
+
+	if(dsp_conv_proc(conv->conv, buf, len) && conv->offload)
+		conv_kick(conv);
+
+	return conv->quiet < conv->ir->len;
+}
+
+
+/**
+ * Kick the worker thread. This function never blocks; a kick lost to a busy
+ * lock only delays the work until the audio thread computes it.
+ *   @conv: The convolution.
+ */
+static void conv_kick(struct amp_conv_t *conv)
+{
+	__atomic_store_n(&conv->kick, true, __ATOMIC_RELEASE);
+
+	if(sys_mutex_trylock(&conv->lock)) {
+		sys_cond_signal(&conv->cond);
+		sys_mutex_unlock(&conv->lock);
+	}
+}
+
+/**
+ * Worker thread callback.
+ *   @arg: The convolution.
+ *   &returns: Always null.
+ */
+static void *conv_thread(void *arg)
+{
+	struct amp_conv_t *conv = arg;
+
+	sys_mutex_lock(&conv->lock);
+
+	while(!conv->term) {
+		if(__atomic_exchange_n(&conv->kick, false, __ATOMIC_ACQUIRE)) {
+			sys_mutex_unlock(&conv->lock);
+			dsp_conv_work(conv->conv);
+			sys_mutex_lock(&conv->lock);
+		}
+		else
+			sys_cond_wait(&conv->cond, &conv->lock);
+	}
+
+	sys_mutex_unlock(&conv->lock);
+
+	return NULL;
+}
@@ -0,0 +1,31 @@
+#ifndef EFX_CONV_H
+#define EFX_CONV_H
+
+/*
+ * convolution declarations
+ */
+struct amp_conv_t;
+
+extern const struct amp_effect_i amp_conv_iface;
+
+struct amp_conv_t *amp_conv_new(struct amp_file_t *file, unsigned int chan, bool offload);
+struct amp_conv_t *amp_conv_copy(struct amp_conv_t *conv);
+void amp_conv_delete(struct amp_conv_t *conv);
+
+char *amp_conv_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
+
+void amp_conv_info(struct amp_conv_t *conv, struct amp_info_t info);
+bool amp_conv_proc(struct amp_conv_t *conv, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+
+
+/**
+ * Cast a convolution to an effect.
+ *   @conv: The convolution.
+ *   &returns: The effect.
+ */
+static inline struct amp_effect_t amp_conv_effect(struct amp_conv_t *conv)
+{
+	return (struct amp_effect_t){ conv, &amp_conv_iface };
+}
+
+#endif
@@ -107,7 +107,7 @@ void amp_crush_info(struct amp_crush_t *crush, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_crush_proc(struct amp_crush_t *crush, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_crush_proc(struct amp_crush_t *crush, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	bool cont = false;
 	unsigned int i;
@@ -115,7 +115,8 @@ bool amp_crush_proc(struct amp_crush_t *crush, double *buf, struct amp_time_t *t
 	switch(crush->type) {
 	case amp_crush_bit_v:
 		if(!amp_param_isfast(crush->bits)) {
-			double t, inc[len];
+			double t;
+			dsp_sample_t inc[len];
 
 			cont = amp_param_proc(crush->bits, inc, time, len, queue);
 
@@ -134,7 +135,7 @@ bool amp_crush_proc(struct amp_crush_t *crush, double *buf, struct amp_time_t *t
 
 	case amp_crush_exp_v:
 		if(!amp_param_isfast(crush->bits)) {
-			double bits[len];
+			dsp_sample_t bits[len];
 
 			cont = amp_param_proc(crush->bits, bits, time, len, queue);
 
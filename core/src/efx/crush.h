@@ -25,7 +25,7 @@ char *amp_bitcrush_make(struct ml_value_t **ret, struct ml_value_t *value, struc
 char *amp_expcrush_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 
 void amp_crush_info(struct amp_crush_t *crush, struct amp_info_t info);
-bool amp_crush_proc(struct amp_crush_t *crush, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_crush_proc(struct amp_crush_t *crush, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 
 /**
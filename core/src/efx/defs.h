@@ -10,7 +10,7 @@
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-typedef bool (*amp_effect_f)(void *ref, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+typedef bool (*amp_effect_f)(void *ref, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 /**
  * Effect interface.
@@ -51,6 +51,11 @@ static inline void amp_effect_info(struct amp_effect_t effect, struct amp_info_t
 	effect.iface->info(effect.ref, info);
 }
 
+/*
+ * profiler declarations
+ */
+bool amp_prof_effect(struct amp_effect_t effect, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+
 /**
  * Process an effect.
  *   @effect: The effect.
@@ -60,8 +65,11 @@ static inline void amp_effect_info(struct amp_effect_t effect, struct amp_info_t
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-static inline bool amp_effect_proc(struct amp_effect_t effect, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+static inline bool amp_effect_proc(struct amp_effect_t effect, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
+	if(__atomic_load_n(&amp_prof, __ATOMIC_RELAXED) != NULL)
+		return amp_prof_effect(effect, buf, time, len, queue);
+
 	return effect.iface->proc(effect.ref, buf, time, len, queue);
 }
 
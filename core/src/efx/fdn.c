@@ -0,0 +1,124 @@
+#include "../common.h"
+
+
+/**
+ * Feedback delay network structure.
+ *   @n: The number of lines.
+ *   @len, decay, freq, rate: The longest delay, the decay time, the damping
+ *     frequency and the sample rate.
+ *   @fdn: The network.
+ */
+struct amp_fdn_t {
+	unsigned int n;
+	double len, decay, freq, rate;
+
+	struct dsp_fdn_t *fdn;
+};
+
+
+/*
+ * global variables
+ */
+const struct amp_effect_i amp_fdn_iface = {
+	(amp_info_f)amp_fdn_info,
+	(amp_effect_f)amp_fdn_proc,
+	(amp_copy_f)amp_fdn_copy,
+	(amp_delete_f)amp_fdn_delete
+};
+
+
+/**
+ * Create a feedback delay network effect.
+ *   @n: The number of lines.
+ *   @len: The longest delay in seconds.
+ *   @decay: The time to decay by 60dB in seconds.
+ *   @freq: The damping frequency.
+ *   @rate: The sample rate.
+ *   &returns: The network.
+ */
+struct amp_fdn_t *amp_fdn_new(unsigned int n, double len, double decay, double freq, double rate)
+{
+	struct amp_fdn_t *fdn;
+
+	fdn = malloc(sizeof(struct amp_fdn_t));
+	fdn->n = n;
+	fdn->len = len;
+	fdn->decay = decay;
+	fdn->freq = freq;
+	fdn->rate = rate;
+	fdn->fdn = dsp_fdn_new(n, len * rate, decay, fmin(freq, 0.45 * rate), rate);
+
+	return fdn;
+}
+
+/**
+ * Copy a feedback delay network effect.
+ *   @fdn: The original network.
+ *   &returns: The copied network.
+ */
+struct amp_fdn_t *amp_fdn_copy(struct amp_fdn_t *fdn)
+{
+	return amp_fdn_new(fdn->n, fdn->len, fdn->decay, fdn->freq, fdn->rate);
+}
+
+/**
+ * Delete a feedback delay network effect.
+ *   @fdn: The network.
+ */
+void amp_fdn_delete(struct amp_fdn_t *fdn)
+{
+	dsp_fdn_delete(fdn->fdn);
+	free(fdn);
+}
+
+
+/**
+ * Create a feedback delay network from a value.
+ *   @ret: Ref. The returned value.
+ *   @value: The value.
+ *   @env: The environment.
+ *   &returns: Error.
+ */
+char *amp_fdn_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env)
+{
+#define onexit
+	int n;
+	double len, decay, freq;
+
+	chkfail(amp_match_unpack(value, "(d,f,f,f)", &n, &len, &decay, &freq));
+
+	if((n < 1) || (n > DSP_FDN_MAX))
+		fail("%C: Fdn requires between 1 and %u lines.", ml_tag_chunk(&value->tag), DSP_FDN_MAX);
+
+	if((len <= 0.0) || (decay <= 0.0) || (freq <= 0.0))
+		fail("%C: Fdn requires a positive length, decay and frequency.", ml_tag_chunk(&value->tag));
+
+	*ret = amp_pack_effect(amp_fdn_effect(amp_fdn_new(n, len, decay, freq, amp_core_rate(env))));
+	return NULL;
+#undef onexit
+}
+
+
+/**
+ * Handle information on a feedback delay network.
+ *   @fdn: The network.
+ *   @info: The information.
+ */
+void amp_fdn_info(struct amp_fdn_t *fdn, struct amp_info_t info)
+{
+}
+
+/**
+ * Process a feedback delay network. The network continues until its tail has
+ * decayed into silence.
+ *   @fdn: The network.
+ *   @buf: The buffer.
+ *   @time: The time.
+ *   @len: The length.
+ *   @queue: The action queue.
+ *   &returns: The continuation flag.
+ */
+bool amp_fdn_proc(struct amp_fdn_t *fdn, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+{
+	return dsp_fdn_proc(fdn->fdn, buf, len);
+}
@@ -0,0 +1,31 @@
+#ifndef EFX_FDN_H
+#define EFX_FDN_H
+
+/*
+ * feedback delay network declarations
+ */
+struct amp_fdn_t;
+
+extern const struct amp_effect_i amp_fdn_iface;
+
+struct amp_fdn_t *amp_fdn_new(unsigned int n, double len, double decay, double freq, double rate);
+struct amp_fdn_t *amp_fdn_copy(struct amp_fdn_t *fdn);
+void amp_fdn_delete(struct amp_fdn_t *fdn);
+
+char *amp_fdn_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
+
+void amp_fdn_info(struct amp_fdn_t *fdn, struct amp_info_t info);
+bool amp_fdn_proc(struct amp_fdn_t *fdn, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+
+
+/**
+ * Cast a feedback delay network to an effect.
+ *   @fdn: The network.
+ *   &returns: The effect.
+ */
+static inline struct amp_effect_t amp_fdn_effect(struct amp_fdn_t *fdn)
+{
+	return (struct amp_effect_t){ fdn, &amp_fdn_iface };
+}
+
+#endif
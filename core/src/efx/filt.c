@@ -16,6 +16,11 @@ const struct amp_effect_i amp_filt_iface = {
  */
 typedef struct amp_filt_t *amp_butter_f(struct amp_param_t *, double);
 
+/*
+ * local declarations
+ */
+static struct amp_filt_t *filt_control(struct amp_filt_t *filt, struct ml_env_t *env);
+
 
 /**
  * Create a blank filter.
@@ -32,6 +37,7 @@ struct amp_filt_t *amp_filt_new(enum amp_filt_e type, double rate)
 	filt->type = type;
 	filt->rate = rate;
 	filt->fast = true;
+	filt->coef = dsp_coef_init(DSP_COEF_LEN);
 	dsp_zero_d(filt->s, 8);
 
 	for(i = 0; i < amp_filt_opt_n; i++)
@@ -54,6 +60,7 @@ struct amp_filt_t *amp_filt_copy(struct amp_filt_t *filt)
 	copy->type = filt->type;
 	copy->rate = filt->rate;
 	copy->fast = filt->fast;
+	copy->coef = dsp_coef_init(filt->coef.len);
 	dsp_zero_d(copy->s, 8);
 
 	for(i = 0; i < amp_filt_opt_n; i++)
@@ -343,8 +350,10 @@ void amp_filt_info(struct amp_filt_t *filt, struct amp_info_t info)
 	unsigned int i;
 
 	if(info.type == amp_info_note_e) {
-		if(info.data.note->init)
+		if(info.data.note->init) {
 			dsp_zero_d(filt->s, 8);
+			dsp_coef_reset(&filt->coef);
+		}
 	}
 
 	for(i = 0; i < amp_filt_opt_n; i++)
@@ -360,7 +369,7 @@ void amp_filt_info(struct amp_filt_t *filt, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_filt_proc(struct amp_filt_t *filt, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_filt_proc(struct amp_filt_t *filt, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	bool cont = false;
 	unsigned int i;
@@ -368,12 +377,11 @@ bool amp_filt_proc(struct amp_filt_t *filt, double *buf, struct amp_time_t *time
 	switch(filt->type) {
 	case amp_filt_lpf_e:
 		if(!filt->fast) {
-			double freq[len];
+			dsp_sample_t freq[len];
 
 			cont |= amp_param_proc(filt->param[amp_filt_opt_freq_e], freq, time, len, queue);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_lpf_proc(buf[i], dsp_lpf_init(freq[i], filt->rate), filt->s);
+			dsp_coef_run(&filt->coef, buf, len, struct dsp_lpf_t, dsp_lpf_init(freq[j - 1], filt->rate), dsp_lpf_proc(buf[i], c, filt->s), freq[j - 1]);
 		}
 		else {
 			struct dsp_lpf_t c = dsp_lpf_init(filt->param[amp_filt_opt_freq_e]->flt, filt->rate);
@@ -386,12 +394,11 @@ bool amp_filt_proc(struct amp_filt_t *filt, double *buf, struct amp_time_t *time
 
 	case amp_filt_hpf_e:
 		if(!filt->fast) {
-			double freq[len];
+			dsp_sample_t freq[len];
 
 			cont |= amp_param_proc(filt->param[amp_filt_opt_freq_e], freq, time, len, queue);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_hpf_proc(buf[i], dsp_hpf_init(freq[i], filt->rate), filt->s);
+			dsp_coef_run(&filt->coef, buf, len, struct dsp_hpf_t, dsp_hpf_init(freq[j - 1], filt->rate), dsp_hpf_proc(buf[i], c, filt->s), freq[j - 1]);
 		}
 		else {
 			struct dsp_hpf_t c = dsp_hpf_init(filt->param[amp_filt_opt_freq_e]->flt, filt->rate);
@@ -404,13 +411,12 @@ bool amp_filt_proc(struct amp_filt_t *filt, double *buf, struct amp_time_t *time
 
 	case amp_filt_svlpf_e:
 		if(!filt->fast) {
-			double freq[len], res[len];
+			dsp_sample_t freq[len], res[len];
 
 			cont |= amp_param_proc(filt->param[amp_filt_opt_freq_e], freq, time, len, queue);
 			cont |= amp_param_proc(filt->param[amp_filt_opt_res_e], res, time, len, queue);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_svf_low(buf[i], dsp_svf_init(freq[i], res[i], filt->rate), filt->s);
+			dsp_coef_run(&filt->coef, buf, len, struct dsp_svf_t, dsp_svf_init(freq[j - 1], res[j - 1], filt->rate), dsp_svf_low(buf[i], c, filt->s), freq[j - 1], res[j - 1]);
 		}
 		else {
 			struct dsp_svf_t c = dsp_svf_init(filt->param[amp_filt_opt_freq_e]->flt, filt->param[amp_filt_opt_res_e]->flt, filt->rate);
@@ -423,13 +429,12 @@ bool amp_filt_proc(struct amp_filt_t *filt, double *buf, struct amp_time_t *time
 
 	case amp_filt_svhpf_e:
 		if(!filt->fast) {
-			double freq[len], res[len];
+			dsp_sample_t freq[len], res[len];
 
 			cont |= amp_param_proc(filt->param[amp_filt_opt_freq_e], freq, time, len, queue);
 			cont |= amp_param_proc(filt->param[amp_filt_opt_res_e], res, time, len, queue);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_svf_high(buf[i], dsp_svf_init(freq[i], res[i], filt->rate), filt->s);
+			dsp_coef_run(&filt->coef, buf, len, struct dsp_svf_t, dsp_svf_init(freq[j - 1], res[j - 1], filt->rate), dsp_svf_high(buf[i], c, filt->s), freq[j - 1], res[j - 1]);
 		}
 		else {
 			struct dsp_svf_t c = dsp_svf_init(filt->param[amp_filt_opt_freq_e]->flt, filt->param[amp_filt_opt_res_e]->flt, filt->rate);
@@ -442,14 +447,14 @@ bool amp_filt_proc(struct amp_filt_t *filt, double *buf, struct amp_time_t *time
 
 	case amp_filt_peak_e:
 		if(!filt->fast) {
-			double freq[len], gain[len], qual[len], rate = filt->rate;
+			double rate = filt->rate;
+			dsp_sample_t freq[len], gain[len], qual[len];
 
 			cont |= amp_param_proc(filt->param[amp_filt_opt_freq_e], freq, time, len, queue);
 			cont |= amp_param_proc(filt->param[amp_filt_opt_gain_e], gain, time, len, queue);
-			cont |= amp_param_proc(filt->param[amp_filt_opt_gain_e], qual, time, len, queue);
+			cont |= amp_param_proc(filt->param[amp_filt_opt_qual_e], qual, time, len, queue);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_peak_proc(buf[i], dsp_peak_init(freq[i], gain[i], qual[i], rate), filt->s);
+			dsp_coef_run(&filt->coef, buf, len, struct dsp_peak_t, dsp_peak_init(freq[j - 1], gain[j - 1], qual[j - 1], rate), dsp_peak_proc(buf[i], c, filt->s), freq[j - 1], gain[j - 1], qual[j - 1]);
 		}
 		else {
 			struct dsp_peak_t c = dsp_peak_init(filt->param[amp_filt_opt_freq_e]->flt, filt->param[amp_filt_opt_gain_e]->flt, filt->param[amp_filt_opt_qual_e]->flt, filt->rate);
@@ -462,13 +467,13 @@ bool amp_filt_proc(struct amp_filt_t *filt, double *buf, struct amp_time_t *time
 
 	case amp_filt_res_e:
 		if(!filt->fast) {
-			double freq[len], qual[len], rate = filt->rate;
+			double rate = filt->rate;
+			dsp_sample_t freq[len], qual[len];
 
 			cont |= amp_param_proc(filt->param[amp_filt_opt_freq_e], freq, time, len, queue);
 			cont |= amp_param_proc(filt->param[amp_filt_opt_qual_e], qual, time, len, queue);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_res_proc(buf[i], dsp_res_init(freq[i], qual[i], rate), filt->s);
+			dsp_coef_run(&filt->coef, buf, len, struct dsp_svf_t, dsp_res_init(freq[j - 1], qual[j - 1], rate), dsp_res_proc(buf[i], c, filt->s), freq[j - 1], qual[j - 1]);
 		}
 		else {
 			struct dsp_svf_t c = dsp_res_init(filt->param[amp_filt_opt_freq_e]->flt, filt->param[amp_filt_opt_qual_e]->flt, filt->rate);
@@ -481,22 +486,14 @@ bool amp_filt_proc(struct amp_filt_t *filt, double *buf, struct amp_time_t *time
 
 	case amp_filt_ringf_v:
 		if(!filt->fast) {
-			double gain[len], freq[len], tau[len], rate = filt->rate;
-			struct dsp_ringf_t c;
+			double rate = filt->rate;
+			dsp_sample_t gain[len], freq[len], tau[len];
 
 			cont |= amp_param_proc(filt->param[amp_filt_opt_gain_e], gain, time, len, queue);
 			cont |= amp_param_proc(filt->param[amp_filt_opt_freq_e], freq, time, len, queue);
 			cont |= amp_param_proc(filt->param[amp_filt_opt_tau_v], tau, time, len, queue);
 
-			c = dsp_ringf_init(gain[0], freq[0], tau[0], rate);
-			buf[0] = dsp_ringf_proc(buf[0], c, filt->s);
-
-			for(i = 1; i < len; i++) {
-				if((gain[i] != gain[i-1]) && (freq[i] != freq[i-1]) && (tau[i] != tau[i-1]))
-					c = dsp_ringf_init(gain[i], freq[i], tau[i], rate);
-
-				buf[i] = dsp_ringf_proc(buf[i], c, filt->s);
-			}
+			dsp_coef_run(&filt->coef, buf, len, struct dsp_ringf_t, dsp_ringf_init(gain[j - 1], freq[j - 1], tau[j - 1], rate), dsp_ringf_proc(buf[i], c, filt->s), gain[j - 1], freq[j - 1], tau[j - 1]);
 		}
 		else {
 			struct dsp_ringf_t c = dsp_ringf_init(filt->param[amp_filt_opt_gain_e]->flt, filt->param[amp_filt_opt_freq_e]->flt, filt->param[amp_filt_opt_tau_v]->flt, filt->rate);
@@ -508,13 +505,12 @@ bool amp_filt_proc(struct amp_filt_t *filt, double *buf, struct amp_time_t *time
 
 	case amp_filt_moog_e:
 		if(!filt->fast) {
-			double freq[len], res[len];
+			dsp_sample_t freq[len], res[len];
 
 			cont |= amp_param_proc(filt->param[amp_filt_opt_freq_e], freq, time, len, queue);
 			cont |= amp_param_proc(filt->param[amp_filt_opt_res_e], res, time, len, queue);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_moog_proc(buf[i], dsp_moog_init(freq[i], res[i], filt->rate), filt->s);
+			dsp_coef_run(&filt->coef, buf, len, struct dsp_moog_t, dsp_moog_init(freq[j - 1], res[j - 1], filt->rate), dsp_moog_proc(buf[i], c, filt->s), freq[j - 1], res[j - 1]);
 		}
 		else {
 			struct dsp_moog_t c = dsp_moog_init(filt->param[amp_filt_opt_freq_e]->flt, filt->param[amp_filt_opt_res_e]->flt, filt->rate);
@@ -527,12 +523,11 @@ bool amp_filt_proc(struct amp_filt_t *filt, double *buf, struct amp_time_t *time
 
 	case amp_filt_butter2low_e:
 		if(!filt->fast) {
-			double freq[len];
+			dsp_sample_t freq[len];
 
 			cont |= amp_param_proc(filt->param[amp_filt_opt_freq_e], freq, time, len, queue);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_butter2low_proc(buf[i], dsp_butter2low_init(freq[i], filt->rate), filt->s);
+			dsp_coef_run(&filt->coef, buf, len, struct dsp_butter2low_t, dsp_butter2low_init(freq[j - 1], filt->rate), dsp_butter2low_proc(buf[i], c, filt->s), freq[j - 1]);
 		}
 		else {
 			struct dsp_butter2low_t c = dsp_butter2low_init(filt->param[amp_filt_opt_freq_e]->flt, filt->rate);
@@ -545,12 +540,11 @@ bool amp_filt_proc(struct amp_filt_t *filt, double *buf, struct amp_time_t *time
 
 	case amp_filt_butter2high_e:
 		if(!filt->fast) {
-			double freq[len];
+			dsp_sample_t freq[len];
 
 			cont |= amp_param_proc(filt->param[amp_filt_opt_freq_e], freq, time, len, queue);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_butter2high_proc(buf[i], dsp_butter2high_init(freq[i], filt->rate), filt->s);
+			dsp_coef_run(&filt->coef, buf, len, struct dsp_butter2high_t, dsp_butter2high_init(freq[j - 1], filt->rate), dsp_butter2high_proc(buf[i], c, filt->s), freq[j - 1]);
 		}
 		else {
 			struct dsp_butter2high_t c = dsp_butter2high_init(filt->param[amp_filt_opt_freq_e]->flt, filt->rate);
@@ -563,12 +557,11 @@ bool amp_filt_proc(struct amp_filt_t *filt, double *buf, struct amp_time_t *time
 
 	case amp_filt_butter3low_e:
 		if(!filt->fast) {
-			double freq[len];
+			dsp_sample_t freq[len];
 
 			cont |= amp_param_proc(filt->param[amp_filt_opt_freq_e], freq, time, len, queue);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_butter3low_proc(buf[i], dsp_butter3low_init(freq[i], filt->rate), filt->s);
+			dsp_coef_run(&filt->coef, buf, len, struct dsp_butter3low_t, dsp_butter3low_init(freq[j - 1], filt->rate), dsp_butter3low_proc(buf[i], c, filt->s), freq[j - 1]);
 		}
 		else {
 			struct dsp_butter3low_t c = dsp_butter3low_init(filt->param[amp_filt_opt_freq_e]->flt, filt->rate);
@@ -581,12 +574,11 @@ bool amp_filt_proc(struct amp_filt_t *filt, double *buf, struct amp_time_t *time
 
 	case amp_filt_butter3high_e:
 		if(!filt->fast) {
-			double freq[len];
+			dsp_sample_t freq[len];
 
 			cont |= amp_param_proc(filt->param[amp_filt_opt_freq_e], freq, time, len, queue);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_butter3high_proc(buf[i], dsp_butter3high_init(freq[i], filt->rate), filt->s);
+			dsp_coef_run(&filt->coef, buf, len, struct dsp_butter3high_t, dsp_butter3high_init(freq[j - 1], filt->rate), dsp_butter3high_proc(buf[i], c, filt->s), freq[j - 1]);
 		}
 		else {
 			struct dsp_butter3high_t c = dsp_butter3high_init(filt->param[amp_filt_opt_freq_e]->flt, filt->rate);
@@ -599,12 +591,11 @@ bool amp_filt_proc(struct amp_filt_t *filt, double *buf, struct amp_time_t *time
 
 	case amp_filt_butter4low_e:
 		if(!filt->fast) {
-			double freq[len];
+			dsp_sample_t freq[len];
 
 			cont |= amp_param_proc(filt->param[amp_filt_opt_freq_e], freq, time, len, queue);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_butter4low_proc(buf[i], dsp_butter4low_init(freq[i], filt->rate), filt->s);
+			dsp_coef_run(&filt->coef, buf, len, struct dsp_butter4low_t, dsp_butter4low_init(freq[j - 1], filt->rate), dsp_butter4low_proc(buf[i], c, filt->s), freq[j - 1]);
 		}
 		else {
 			struct dsp_butter4low_t c = dsp_butter4low_init(filt->param[amp_filt_opt_freq_e]->flt, filt->rate);
@@ -617,12 +608,11 @@ bool amp_filt_proc(struct amp_filt_t *filt, double *buf, struct amp_time_t *time
 
 	case amp_filt_butter4high_e:
 		if(!filt->fast) {
-			double freq[len];
+			dsp_sample_t freq[len];
 
 			cont |= amp_param_proc(filt->param[amp_filt_opt_freq_e], freq, time, len, queue);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_butter4high_proc(buf[i], dsp_butter4high_init(freq[i], filt->rate), filt->s);
+			dsp_coef_run(&filt->coef, buf, len, struct dsp_butter4high_t, dsp_butter4high_init(freq[j - 1], filt->rate), dsp_butter4high_proc(buf[i], c, filt->s), freq[j - 1]);
 		}
 		else {
 			struct dsp_butter4high_t c = dsp_butter4high_init(filt->param[amp_filt_opt_freq_e]->flt, filt->rate);
@@ -652,7 +642,7 @@ char *amp_lpf_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_
 
 	chkfail(amp_match_unpack(value, "P", &freq));
 
-	*ret = amp_pack_effect((struct amp_effect_t){ amp_filt_lpf(freq, amp_core_rate(env)), &amp_filt_iface });
+	*ret = amp_pack_effect(amp_filt_effect(filt_control(amp_filt_lpf(freq, amp_core_rate(env)), env)));
 	return NULL;
 #undef onexit
 }
@@ -671,7 +661,7 @@ char *amp_hpf_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_
 
 	chkfail(amp_match_unpack(value, "P", &freq));
 
-	*ret = amp_pack_effect((struct amp_effect_t){ amp_filt_hpf(freq, amp_core_rate(env)), &amp_filt_iface });
+	*ret = amp_pack_effect(amp_filt_effect(filt_control(amp_filt_hpf(freq, amp_core_rate(env)), env)));
 	return NULL;
 #undef onexit
 }
@@ -690,7 +680,7 @@ char *amp_svlpf_make(struct ml_value_t **ret, struct ml_value_t *value, struct m
 
 	chkfail(amp_match_unpack(value, "(P,P)", &freq, &res));
 
-	*ret = amp_pack_effect(amp_filt_effect(amp_filt_svlpf(freq, res, amp_core_rate(env))));
+	*ret = amp_pack_effect(amp_filt_effect(filt_control(amp_filt_svlpf(freq, res, amp_core_rate(env)), env)));
 	return NULL;
 #undef onexit
 }
@@ -709,7 +699,7 @@ char *amp_svhpf_make(struct ml_value_t **ret, struct ml_value_t *value, struct m
 
 	chkfail(amp_match_unpack(value, "(P,P)", &freq, &res));
 
-	*ret = amp_pack_effect(amp_filt_effect(amp_filt_svhpf(freq, res, amp_core_rate(env))));
+	*ret = amp_pack_effect(amp_filt_effect(filt_control(amp_filt_svhpf(freq, res, amp_core_rate(env)), env)));
 	return NULL;
 #undef onexit
 }
@@ -728,7 +718,7 @@ char *amp_peak_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml
 
 	chkfail(amp_match_unpack(value, "(P,P,P)", &freq, &gain, &qual));
 
-	*ret = amp_pack_effect(amp_filt_effect(amp_filt_peak(freq, gain, qual, amp_core_rate(env))));
+	*ret = amp_pack_effect(amp_filt_effect(filt_control(amp_filt_peak(freq, gain, qual, amp_core_rate(env)), env)));
 	return NULL;
 #undef onexit
 }
@@ -747,7 +737,7 @@ char *amp_res_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_
 
 	chkfail(amp_match_unpack(value, "(P,P)", &freq, &qual));
 
-	*ret = amp_pack_effect(amp_filt_effect(amp_filt_res(freq, qual, amp_core_rate(env))));
+	*ret = amp_pack_effect(amp_filt_effect(filt_control(amp_filt_res(freq, qual, amp_core_rate(env)), env)));
 	return NULL;
 #undef onexit
 }
@@ -766,7 +756,7 @@ char *amp_ring_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml
 
 	chkfail(amp_match_unpack(value, "(P,P,P)", &freq, &gain, &tau));
 
-	*ret = amp_pack_effect(amp_filt_effect(amp_filt_ringf(freq, gain, tau, amp_core_rate(env))));
+	*ret = amp_pack_effect(amp_filt_effect(filt_control(amp_filt_ringf(freq, gain, tau, amp_core_rate(env)), env)));
 	return NULL;
 #undef onexit
 }
@@ -785,7 +775,7 @@ char *amp_moog_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml
 
 	chkfail(amp_match_unpack(value, "(P,P)", &freq, &res));
 
-	*ret = amp_pack_effect(amp_filt_effect(amp_filt_moog(freq, res, amp_core_rate(env))));
+	*ret = amp_pack_effect(amp_filt_effect(filt_control(amp_filt_moog(freq, res, amp_core_rate(env)), env)));
 	return NULL;
 #undef onexit
 }
@@ -805,7 +795,7 @@ char *amp_butter_make(struct ml_value_t **ret, struct ml_value_t *value, struct
 
 	chkfail(amp_match_unpack(value, "P", &freq));
 
-	*ret = amp_pack_effect(amp_filt_effect(func(freq, amp_core_rate(env))));
+	*ret = amp_pack_effect(amp_filt_effect(filt_control(func(freq, amp_core_rate(env)), env)));
 	return NULL;
 #undef onexit
 }
@@ -856,3 +846,17 @@ const char *amp_filt_name(enum amp_filt_e type)
 
 	fatal("Invalid filter type.");
 }
+
+
+/**
+ * Set the control period of a filter from the environment.
+ *   @filt: The filter.
+ *   @env: The environment.
+ *   &returns: The filter.
+ */
+static struct amp_filt_t *filt_control(struct amp_filt_t *filt, struct ml_env_t *env)
+{
+	filt->coef = dsp_coef_init(amp_core_control(env));
+
+	return filt;
+}
@@ -66,6 +66,7 @@ enum amp_filt_opt_e {
  *   @type: The type.
  *   @param: The parameter array.
  *   @fast: Static parameter flag.
+ *   @coef: The coefficient ramp for modulated parameters.
  *   @s, rate: The state and sample rate.
  */
 struct amp_filt_t {
@@ -73,6 +74,7 @@ struct amp_filt_t {
 	struct amp_param_t *param[amp_filt_opt_n];
 
 	bool fast;
+	struct dsp_coef_t coef;
 	double s[8], rate;
 };
 
@@ -102,7 +104,7 @@ struct amp_filt_t *amp_filt_butter4low(struct amp_param_t *freq, double rate);
 struct amp_filt_t *amp_filt_butter4high(struct amp_param_t *freq, double rate);
 
 void amp_filt_info(struct amp_filt_t *filt, struct amp_info_t info);
-bool amp_filt_proc(struct amp_filt_t *filt, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_filt_proc(struct amp_filt_t *filt, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 char *amp_lpf_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 char *amp_hpf_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
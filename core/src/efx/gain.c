@@ -136,7 +136,7 @@ void amp_gain_info(struct amp_gain_t *gain, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_gain_proc(struct amp_gain_t *gain, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_gain_proc(struct amp_gain_t *gain, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	unsigned int i;
 
@@ -149,7 +149,7 @@ bool amp_gain_proc(struct amp_gain_t *gain, double *buf, struct amp_time_t *time
 					buf[i] *= scale;
 		}
 		else {
-			double scale[len];
+			dsp_sample_t scale[len];
 
 			amp_param_proc(gain->scale, scale, time, len, queue);
 
@@ -167,12 +167,18 @@ bool amp_gain_proc(struct amp_gain_t *gain, double *buf, struct amp_time_t *time
 				buf[i] *= scale;
 		}
 		else {
-			double scale[len];
+			dsp_sample_t scale[len];
+			double amp[len];
 
 			amp_param_proc(gain->scale, scale, time, len, queue);
 
 			for(i = 0; i < len; i++)
-				buf[i] *= dsp_db2amp_f(scale[i]);
+				amp[i] = scale[i] * (M_LN10 / 20.0);
+
+			dsp_exp_v(amp, amp, len);
+
+			for(i = 0; i < len; i++)
+				buf[i] *= amp[i];
 		}
 
 		break;
@@ -185,12 +191,18 @@ bool amp_gain_proc(struct amp_gain_t *gain, double *buf, struct amp_time_t *time
 				buf[i] *= scale;
 		}
 		else {
-			double scale[len];
+			dsp_sample_t scale[len];
+			double amp[len];
 
 			amp_param_proc(gain->scale, scale, time, len, queue);
 
 			for(i = 0; i < len; i++)
-				buf[i] *= dsp_db2amp_f(-scale[i]);
+				amp[i] = -scale[i] * (M_LN10 / 20.0);
+
+			dsp_exp_v(amp, amp, len);
+
+			for(i = 0; i < len; i++)
+				buf[i] *= amp[i];
 		}
 
 		break;
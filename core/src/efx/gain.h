@@ -28,6 +28,6 @@ char *amp_boost_make(struct ml_value_t **ret, struct ml_value_t *value, struct m
 char *amp_cut_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 
 void amp_gain_info(struct amp_gain_t *gain, struct amp_info_t info);
-bool amp_gain_proc(struct amp_gain_t *gain, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_gain_proc(struct amp_gain_t *gain, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 #endif
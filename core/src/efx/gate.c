@@ -90,16 +90,16 @@ void amp_gate_info(struct amp_gate_t *gate, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_gate_proc(struct amp_gate_t *gate, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_gate_proc(struct amp_gate_t *gate, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	unsigned int i;
 	bool cont = false;
-	double left[len], right[len];
+	dsp_sample_t left[len], right[len];
 
-	dsp_copy_d(left, buf, len);
+	dsp_copy_s(left, buf, len);
 	cont |= amp_effect_proc(gate->left, left, time, len, queue);
 
-	dsp_copy_d(right, buf, len);
+	dsp_copy_s(right, buf, len);
 	cont |= amp_effect_proc(gate->right, right, time, len, queue);
 
 	for(i = 0; i < len; i++)
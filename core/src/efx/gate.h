@@ -21,6 +21,6 @@ void amp_gate_delete(struct amp_gate_t *gate);
 char *amp_gate_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 
 void amp_gate_info(struct amp_gate_t *gate, struct amp_info_t info);
-bool amp_gate_proc(struct amp_gate_t *gate, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_gate_proc(struct amp_gate_t *gate, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 #endif
@@ -11,6 +11,6 @@ void amp_gen_delete(struct amp_gen_t *gen);
 char *amp_gen_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 
 void amp_gen_info(struct amp_gen_t *gen, struct amp_info_t info);
-bool amp_gen_proc(struct amp_gen_t *gen, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_gen_proc(struct amp_gen_t *gen, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 #endif
@@ -140,23 +140,18 @@ void amp_loop_info(struct amp_loop_t *loop, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_loop_proc(struct amp_loop_t *loop, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_loop_proc(struct amp_loop_t *loop, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	struct amp_time_t left, right;
-	unsigned int i, j, n = 0;
+	unsigned int i, j, end, n = 0;
+	struct amp_event_t *event;
 
 	left = amp_time_mod(time[0], loop->mod);
-	for(i = 0; i < len; i++) {
-		struct amp_event_t *event;
-
+	for(i = 0; i < len; ) {
 		while((event = amp_queue_event(queue, &n, i)) != NULL) {
-			if((event->dev == loop->rec.dev) && (event->key == loop->rec.key))
-				break;
-		}
-
-		right = amp_time_mod(time[i+1], loop->mod);
+			if((event->dev != loop->rec.dev) || (event->key != loop->rec.key))
+				continue;
 
-		if(event != NULL) {
 			if(event->val > 0) {
 				loop->on = true;
 				loop->wr = 0;
@@ -170,30 +165,34 @@ bool amp_loop_proc(struct amp_loop_t *loop, double *buf, struct amp_time_t *time
 				loop->on = false;
 		}
 
-		if(!amp_time_isequal(left, right)) {
-			if(amp_time_between(loop->off, left, right) && (loop->wr > 0)) {
-				loop->sel = (loop->sel - 1 + AMP_LOOP_CNT) % AMP_LOOP_CNT;
-				loop->rd[loop->sel] = 0;
+		for(end = amp_queue_split(queue, n, len); i < end; i++) {
+			right = amp_time_mod(time[i+1], loop->mod);
+
+			if(!amp_time_isequal(left, right)) {
+				if(amp_time_between(loop->off, left, right) && (loop->wr > 0)) {
+					loop->sel = (loop->sel - 1 + AMP_LOOP_CNT) % AMP_LOOP_CNT;
+					loop->rd[loop->sel] = 0;
+				}
 			}
-		}
 
-		if(loop->on) {
-			if(loop->wr < loop->buf->len)
-				loop->buf->arr[loop->wr++] = buf[i];
-			else
-				loop->on = false;
-		}
+			if(loop->on) {
+				if(loop->wr < loop->buf->len)
+					loop->buf->arr[loop->wr++] = buf[i];
+				else
+					loop->on = false;
+			}
 
-		for(j = 0; j < AMP_LOOP_CNT; j++) {
-			unsigned int idx = (j + loop->sel) % AMP_LOOP_CNT;
+			for(j = 0; j < AMP_LOOP_CNT; j++) {
+				unsigned int idx = (j + loop->sel) % AMP_LOOP_CNT;
 
-			if(loop->rd[idx] >= loop->wr)
-				break;
+				if(loop->rd[idx] >= loop->wr)
+					break;
 
-			buf[i] += loop->buf->arr[loop->rd[idx]++];
-		}
+				buf[i] += loop->buf->arr[loop->rd[idx]++];
+			}
 
-		left = right;
+			left = right;
+		}
 	}
 
 	return false;
@@ -13,6 +13,6 @@ void amp_loop_delete(struct amp_loop_t *loop);
 char *amp_loop_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 
 void amp_loop_info(struct amp_loop_t *loop, struct amp_info_t info);
-bool amp_loop_proc(struct amp_loop_t *loop, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_loop_proc(struct amp_loop_t *loop, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 #endif
@@ -121,7 +121,7 @@ void amp_math_info(struct amp_math_t *math, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The mathinuation flag.
  */
-bool amp_math_proc(struct amp_math_t *math, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_math_proc(struct amp_math_t *math, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	unsigned int i;
 
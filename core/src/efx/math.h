@@ -23,6 +23,6 @@ char *amp_exp_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_
 char *amp_hz2sec_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 
 void amp_math_info(struct amp_math_t *math, struct amp_info_t info);
-bool amp_math_proc(struct amp_math_t *math, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_math_proc(struct amp_math_t *math, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 #endif
@@ -91,13 +91,13 @@ void amp_mix_info(struct amp_mix_t *mix, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_mix_proc(struct amp_mix_t *mix, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_mix_proc(struct amp_mix_t *mix, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	unsigned int i;
-	double tmp[len];
+	dsp_sample_t tmp[len];
 	bool cont = false;
 
-	dsp_copy_d(tmp, buf, len);
+	dsp_copy_s(tmp, buf, len);
 	cont |= amp_effect_proc(mix->effect, tmp, time, len, queue);
 
 	if(amp_param_isfast(mix->ratio)) {
@@ -107,7 +107,8 @@ bool amp_mix_proc(struct amp_mix_t *mix, double *buf, struct amp_time_t *time, u
 			buf[i] = ratio * tmp[i] + (1.0 - ratio) * buf[i];
 	}
 	else {
-		double t, ratio[len];
+		double t;
+		dsp_sample_t ratio[len];
 
 		cont |= amp_param_proc(mix->ratio, ratio, time, len, queue);
 
@@ -240,7 +240,7 @@ void amp_octave_info(struct amp_octave_t *octave, struct amp_info_t info)
  *   &returns: The continuation flag.
  */
 
-bool amp_octave_proc(struct amp_octave_t *octave, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_octave_proc(struct amp_octave_t *octave, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	bool pos;
 	double thresh, out;
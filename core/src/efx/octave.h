@@ -13,6 +13,6 @@ void amp_octave_delete(struct amp_octave_t *octave);
 char *amp_octave_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 
 void amp_octave_info(struct amp_octave_t *octave, struct amp_info_t info);
-bool amp_octave_proc(struct amp_octave_t *octave, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_octave_proc(struct amp_octave_t *octave, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 #endif
@@ -24,6 +24,7 @@ enum opt_e {
  *   @type: The type.
  *   @vary, param: The varying parameter and parameter array.
  *   @fast, fixed: Fast and fixed parameter flag.
+ *   @coef: The coefficient ramp for modulated filters.
  *   @s, rate: The state and sample rate.
  *   @ring: The ring buffer.
  */
@@ -32,6 +33,7 @@ struct amp_reverb_t {
 	struct amp_param_t *vary, *param[opt_n];
 
 	bool fast, fixed;
+	struct dsp_coef_t coef;
 	double i, s[8], rate;
 	struct dsp_ring_t *ring;
 };
@@ -47,6 +49,31 @@ const struct amp_effect_i amp_reverb_iface = {
 	(amp_delete_f)amp_reverb_delete
 };
 
+/*
+ * local declarations
+ */
+static struct amp_reverb_t *reverb_control(struct amp_reverb_t *reverb, struct ml_env_t *env);
+
+/**
+ * Process the buffer in runs no longer than the delay. The delayed samples of
+ * each run are read as a block into 'v', replaced by the values to write
+ * back, and written as a block.
+ *   @...: The statement for the sample 'buf[i + j]' and delayed sample 'v[j]'.
+ */
+#define reverb_run(...) \
+	do { \
+		double v[len]; \
+		unsigned int j, m; \
+		for(i = 0; i < len; i += m) { \
+			m = m_min_u(len - i, ring->len); \
+			dsp_ring_read(ring, ring->len, v, m); \
+			for(j = 0; j < m; j++) { \
+				__VA_ARGS__; \
+			} \
+			dsp_ring_write(ring, v, m); \
+		} \
+	} while(0)
+
 
 /**
  * Create a blank reverb.
@@ -68,6 +95,7 @@ struct amp_reverb_t *amp_reverb_new(enum amp_reverb_e type, double len, struct a
 	reverb->vary = vary;
 	reverb->ring = dsp_ring_new(len * rate);
 	reverb->fixed = (reverb->vary->type == amp_param_flt_e) && (reverb->vary->flt == len);
+	reverb->coef = dsp_coef_init(DSP_COEF_LEN);
 	reverb->i = 0.0;
 	dsp_zero_d(reverb->s, 8);
 
@@ -94,6 +122,7 @@ struct amp_reverb_t *amp_reverb_copy(struct amp_reverb_t *reverb)
 	copy->ring = dsp_ring_new(reverb->ring->len);
 	copy->vary = amp_param_copy(reverb->vary);
 	copy->fixed = reverb->fixed;
+	copy->coef = dsp_coef_init(reverb->coef.len);
 	copy->i = 0.0;
 	dsp_zero_d(copy->s, 8);
 
@@ -274,6 +303,9 @@ void amp_reverb_info(struct amp_reverb_t *reverb, struct amp_info_t info)
 {
 	unsigned int i;
 
+	if((info.type == amp_info_init_e) || ((info.type == amp_info_note_e) && info.data.note->init))
+		dsp_coef_reset(&reverb->coef);
+
 	amp_param_info(reverb->vary, info);
 
 	for(i = 0; i < opt_n; i++)
@@ -289,7 +321,7 @@ void amp_reverb_info(struct amp_reverb_t *reverb, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_reverb_proc(struct amp_reverb_t *reverb, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_reverb_proc(struct amp_reverb_t *reverb, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	unsigned int i;
 	bool cont = false;
@@ -303,18 +335,16 @@ bool amp_reverb_proc(struct amp_reverb_t *reverb, double *buf, struct amp_time_t
 		if(!reverb->fixed) {
 		}
 		else if(!reverb->fast) {
-			double gain[len];
+			dsp_sample_t gain[len];
 
-			cont |= amp_param_proc(reverb->param[opt_gain_e], buf, time, len, queue);
+			cont |= amp_param_proc(reverb->param[opt_gain_e], gain, time, len, queue);
 
-			for(i = 0; i < len; i++)
-				buf[i] = gain[i] * dsp_ring_proc(ring, buf[i]);
+			reverb_run(double y = v[j]; v[j] = buf[i + j]; buf[i + j] = gain[i + j] * y);
 		}
 		else {
 			double gain = reverb->param[opt_gain_e]->flt;
 
-			for(i = 0; i < len; i++)
-				buf[i] = gain * dsp_ring_proc(ring, buf[i]);
+			reverb_run(double y = v[j]; v[j] = buf[i + j]; buf[i + j] = gain * y);
 		}
 
 		break;
@@ -323,25 +353,24 @@ bool amp_reverb_proc(struct amp_reverb_t *reverb, double *buf, struct amp_time_t
 		if(!reverb->fixed) {
 		}
 		else if(!reverb->fast) {
-			double gain[len];
+			dsp_sample_t gain[len];
 
-			cont |= amp_param_proc(reverb->param[opt_gain_e], buf, time, len, queue);
+			cont |= amp_param_proc(reverb->param[opt_gain_e], gain, time, len, queue);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_reverb_allpass(buf[i], ring, gain[i]);
+			reverb_run(double x = buf[i + j] - gain[i + j] * v[j]; buf[i + j] = v[j] + gain[i + j] * x; v[j] = x);
 		}
 		else {
 			double gain = reverb->param[opt_gain_e]->flt;
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_reverb_allpass(buf[i], ring, gain);
+			reverb_run(double x = buf[i + j] - gain * v[j]; buf[i + j] = v[j] + gain * x; v[j] = x);
 		}
 
 		break;
 
 	case amp_reverb_comb_e:
 		if(!reverb->fixed) {
-			double gain[len], vary[len], rate = reverb->rate;
+			double rate = reverb->rate;
+			dsp_sample_t gain[len], vary[len];
 
 			cont |= amp_param_proc(reverb->vary, vary, time, len, queue);
 			cont |= amp_param_proc(reverb->param[opt_gain_e], gain, time, len, queue);
@@ -350,135 +379,130 @@ bool amp_reverb_proc(struct amp_reverb_t *reverb, double *buf, struct amp_time_t
 				buf[i] = dsp_vary_comb(buf[i], ring, rate * vary[i], &reverb->i, gain[i]);
 		}
 		else if(!reverb->fast) {
-			double gain[len];
+			dsp_sample_t gain[len];
 
-			cont |= amp_param_proc(reverb->param[opt_gain_e], buf, time, len, queue);
+			cont |= amp_param_proc(reverb->param[opt_gain_e], gain, time, len, queue);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_reverb_comb(buf[i], ring, gain[i]);
+			reverb_run(double y = gain[i + j] * v[j]; v[j] = y + buf[i + j]; buf[i + j] = y);
 		}
 		else {
 			double gain = reverb->param[opt_gain_e]->flt;
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_reverb_comb(buf[i], ring, gain);
+			reverb_run(double y = gain * v[j]; v[j] = y + buf[i + j]; buf[i + j] = y);
 		}
 
 		break;
 
 	case amp_reverb_lpcf_e:
 		if(!reverb->fixed) {
-			double *s = reverb->s, vary[len], gain[len], freq[len], rate = reverb->rate;
+			double *s = reverb->s, rate = reverb->rate;
+			dsp_sample_t vary[len], gain[len], freq[len];
 
 			cont |= amp_param_proc(reverb->vary, vary, time, len, queue);
 			cont |= amp_param_proc(reverb->param[opt_gain_e], gain, time, len, queue);
 			cont |= amp_param_proc(reverb->param[opt_freq_e], freq, time, len, queue);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_vary_lpcf(buf[i], ring, rate * vary[i], &reverb->i, gain[i], dsp_lpf_init(freq[i], rate), s);
+			dsp_coef_run(&reverb->coef, buf, len, struct dsp_lpf_t, dsp_lpf_init(freq[j - 1], rate), dsp_vary_lpcf(buf[i], ring, rate * vary[i], &reverb->i, gain[i], c, s), freq[j - 1]);
 		}
 		else if(!reverb->fast) {
-			double *s = reverb->s, gain[len], freq[len], rate = reverb->rate;
+			double *s = reverb->s, rate = reverb->rate;
+			dsp_sample_t gain[len], freq[len];
 
 			cont |= amp_param_proc(reverb->param[opt_gain_e], gain, time, len, queue);
 			cont |= amp_param_proc(reverb->param[opt_freq_e], freq, time, len, queue);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_reverb_lpcf(buf[i], ring, gain[i], dsp_lpf_init(freq[i], rate), s);
+			dsp_coef_run(&reverb->coef, buf, len, struct dsp_lpf_t, dsp_lpf_init(freq[j - 1], rate), dsp_reverb_lpcf(buf[i], ring, gain[i], c, s), freq[j - 1]);
 		}
 		else {
 			double *s = reverb->s, gain = reverb->param[opt_gain_e]->flt;
 			struct dsp_lpf_t lpf = dsp_lpf_init(reverb->param[opt_freq_e]->flt, reverb->rate);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_reverb_lpcf(buf[i], ring, gain, lpf, s);
+			reverb_run(double y = dsp_lpf_proc(gain * v[j], lpf, s); v[j] = y + buf[i + j]; buf[i + j] = y);
 		}
 
 		break;
 
 	case amp_reverb_bpcf_e:
 		if(!reverb->fixed) {
-			double *s = reverb->s, vary[len], gain[len], freqlo[len], freqhi[len], rate = reverb->rate;
+			double *s = reverb->s, rate = reverb->rate;
+			dsp_sample_t vary[len], gain[len], freqlo[len], freqhi[len];
 
 			cont |= amp_param_proc(reverb->vary, vary, time, len, queue);
 			cont |= amp_param_proc(reverb->param[opt_gain_e], gain, time, len, queue);
 			cont |= amp_param_proc(reverb->param[opt_freqlo_e], freqlo, time, len, queue);
 			cont |= amp_param_proc(reverb->param[opt_freqhi_e], freqhi, time, len, queue);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_vary_bpcf(buf[i], ring, rate * vary[i], &reverb->i, gain[i], dsp_bpf_init(freqlo[i], freqhi[i], rate), s);
+			dsp_coef_run(&reverb->coef, buf, len, struct dsp_bpf_t, dsp_bpf_init(freqlo[j - 1], freqhi[j - 1], rate), dsp_vary_bpcf(buf[i], ring, rate * vary[i], &reverb->i, gain[i], c, s), freqlo[j - 1], freqhi[j - 1]);
 		}
 		else if(!reverb->fast) {
-			double *s = reverb->s, gain[len], freqlo[len], freqhi[len], rate = reverb->rate;
+			double *s = reverb->s, rate = reverb->rate;
+			dsp_sample_t gain[len], freqlo[len], freqhi[len];
 
 			cont |= amp_param_proc(reverb->param[opt_gain_e], gain, time, len, queue);
 			cont |= amp_param_proc(reverb->param[opt_freqlo_e], freqlo, time, len, queue);
 			cont |= amp_param_proc(reverb->param[opt_freqhi_e], freqhi, time, len, queue);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_reverb_bpcf(buf[i], ring, gain[i], dsp_bpf_init(freqlo[i], freqhi[i], rate), s);
+			dsp_coef_run(&reverb->coef, buf, len, struct dsp_bpf_t, dsp_bpf_init(freqlo[j - 1], freqhi[j - 1], rate), dsp_reverb_bpcf(buf[i], ring, gain[i], c, s), freqlo[j - 1], freqhi[j - 1]);
 		}
 		else {
 			double *s = reverb->s, gain = reverb->param[opt_gain_e]->flt;
 			struct dsp_bpf_t bpf = dsp_bpf_init(reverb->param[opt_freqlo_e]->flt, reverb->param[opt_freqhi_e]->flt, reverb->rate);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_reverb_bpcf(buf[i], ring, gain, bpf, s);
+			reverb_run(double y = dsp_bpf_proc(gain * v[j], bpf, s); v[j] = y + buf[i + j]; buf[i + j] = y);
 		}
 		break;
 
 	case amp_reverb_bpcf2_e:
 		if(!reverb->fixed) {
-			double *s = reverb->s, vary[len], gain[len], freqlo[len], freqhi[len], rate = reverb->rate;
+			double *s = reverb->s, rate = reverb->rate;
+			dsp_sample_t vary[len], gain[len], freqlo[len], freqhi[len];
 
 			cont |= amp_param_proc(reverb->vary, vary, time, len, queue);
 			cont |= amp_param_proc(reverb->param[opt_gain_e], gain, time, len, queue);
 			cont |= amp_param_proc(reverb->param[opt_freqlo_e], freqlo, time, len, queue);
 			cont |= amp_param_proc(reverb->param[opt_freqhi_e], freqhi, time, len, queue);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_vary_bpcf2(buf[i], ring, rate * vary[i], &reverb->i, gain[i], dsp_bpf2_init(freqlo[i], freqhi[i], rate), s);
+			dsp_coef_run(&reverb->coef, buf, len, struct dsp_bpf2_t, dsp_bpf2_init(freqlo[j - 1], freqhi[j - 1], rate), dsp_vary_bpcf2(buf[i], ring, rate * vary[i], &reverb->i, gain[i], c, s), freqlo[j - 1], freqhi[j - 1]);
 		}
 		else if(!reverb->fast) {
-			double *s = reverb->s, gain[len], freqlo[len], freqhi[len], rate = reverb->rate;
+			double *s = reverb->s, rate = reverb->rate;
+			dsp_sample_t gain[len], freqlo[len], freqhi[len];
 
 			cont |= amp_param_proc(reverb->param[opt_gain_e], gain, time, len, queue);
 			cont |= amp_param_proc(reverb->param[opt_freqlo_e], freqlo, time, len, queue);
 			cont |= amp_param_proc(reverb->param[opt_freqhi_e], freqhi, time, len, queue);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_reverb_bpcf2(buf[i], ring, gain[i], dsp_bpf2_init(freqlo[i], freqhi[i], rate), s);
+			dsp_coef_run(&reverb->coef, buf, len, struct dsp_bpf2_t, dsp_bpf2_init(freqlo[j - 1], freqhi[j - 1], rate), dsp_reverb_bpcf2(buf[i], ring, gain[i], c, s), freqlo[j - 1], freqhi[j - 1]);
 		}
 		else {
 			double *s = reverb->s, gain = reverb->param[opt_gain_e]->flt;
 			struct dsp_bpf2_t bpf = dsp_bpf2_init(reverb->param[opt_freqlo_e]->flt, reverb->param[opt_freqhi_e]->flt, reverb->rate);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_reverb_bpcf2(buf[i], ring, gain, bpf, s);
+			reverb_run(double y = dsp_bpf2_proc(gain * v[j], bpf, s); v[j] = y + buf[i + j]; buf[i + j] = y);
 		}
 		break;
 
 	case amp_reverb_rescf_v:
 		if(!reverb->fixed) {
-			double *s = reverb->s, vary[len], gain[len], freq[len], qual[len], rate = reverb->rate;
+			double *s = reverb->s, rate = reverb->rate;
+			dsp_sample_t vary[len], gain[len], freq[len], qual[len];
 
 			cont |= amp_param_proc(reverb->vary, vary, time, len, queue);
 			cont |= amp_param_proc(reverb->param[opt_gain_e], gain, time, len, queue);
 			cont |= amp_param_proc(reverb->param[opt_freq_e], freq, time, len, queue);
 			cont |= amp_param_proc(reverb->param[opt_qual_v], qual, time, len, queue);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_reverb_rescf(buf[i], ring, rate * vary[i], &reverb->i, gain[i], dsp_res_init(freq[i], qual[i], rate), s);
+			dsp_coef_run(&reverb->coef, buf, len, struct dsp_svf_t, dsp_res_init(freq[j - 1], qual[j - 1], rate), dsp_reverb_rescf(buf[i], ring, rate * vary[i], &reverb->i, gain[i], c, s), freq[j - 1], qual[j - 1]);
 		}
 		else if(!reverb->fast) {
-			double *s = reverb->s, gain[len], freq[len], qual[len], rate = reverb->rate;
+			double *s = reverb->s, rate = reverb->rate;
+			dsp_sample_t gain[len], freq[len], qual[len];
 
 			cont |= amp_param_proc(reverb->param[opt_gain_e], gain, time, len, queue);
 			cont |= amp_param_proc(reverb->param[opt_freq_e], freq, time, len, queue);
 			cont |= amp_param_proc(reverb->param[opt_qual_v], qual, time, len, queue);
 
-			for(i = 0; i < len; i++)
-				buf[i] = dsp_reverb_rescf(buf[i], ring, ring->len, &reverb->i, gain[i], dsp_res_init(freq[i], qual[i], rate), s);
+			dsp_coef_run(&reverb->coef, buf, len, struct dsp_svf_t, dsp_res_init(freq[j - 1], qual[j - 1], rate), dsp_reverb_rescf(buf[i], ring, ring->len, &reverb->i, gain[i], c, s), freq[j - 1], qual[j - 1]);
 		}
 		else {
 			double *s = reverb->s, gain = reverb->param[opt_gain_e]->flt, rate = reverb->rate;
@@ -569,7 +593,7 @@ char *amp_lpcf_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml
 
 	chkfail(amp_match_unpack(value, "(f,P,P,P)", &len, &vary, &gain, &freq));
 
-	*ret = amp_pack_effect(amp_reverb_effect(amp_reverb_lpcf(len, vary, gain, freq, amp_core_rate(env))));
+	*ret = amp_pack_effect(amp_reverb_effect(reverb_control(amp_reverb_lpcf(len, vary, gain, freq, amp_core_rate(env)), env)));
 	return NULL;
 #undef onexit
 }
@@ -589,7 +613,7 @@ char *amp_bpcf_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml
 
 	chkfail(amp_match_unpack(value, "(f,P,P,P,P)", &len, &vary, &gain, &freqlo, &freqhi));
 
-	*ret = amp_pack_effect(amp_reverb_effect(amp_reverb_bpcf(len, vary, gain, freqlo, freqhi, amp_core_rate(env))));
+	*ret = amp_pack_effect(amp_reverb_effect(reverb_control(amp_reverb_bpcf(len, vary, gain, freqlo, freqhi, amp_core_rate(env)), env)));
 	return NULL;
 #undef onexit
 }
@@ -609,7 +633,7 @@ char *amp_bpcf2_make(struct ml_value_t **ret, struct ml_value_t *value, struct m
 
 	chkfail(amp_match_unpack(value, "(f,P,P,P,P)", &len, &vary, &gain, &freqlo, &freqhi));
 
-	*ret = amp_pack_effect(amp_reverb_effect(amp_reverb_bpcf2(len, vary, gain, freqlo, freqhi, amp_core_rate(env))));
+	*ret = amp_pack_effect(amp_reverb_effect(reverb_control(amp_reverb_bpcf2(len, vary, gain, freqlo, freqhi, amp_core_rate(env)), env)));
 	return NULL;
 #undef onexit
 }
@@ -629,7 +653,21 @@ char *amp_rescf_make(struct ml_value_t **ret, struct ml_value_t *value, struct m
 
 	chkfail(amp_match_unpack(value, "(f,P,P,P,P)", &len, &vary, &gain, &freq, &qual));
 
-	*ret = amp_pack_effect(amp_reverb_effect(amp_reverb_rescf(len, vary, gain, freq, qual, amp_core_rate(env))));
+	*ret = amp_pack_effect(amp_reverb_effect(reverb_control(amp_reverb_rescf(len, vary, gain, freq, qual, amp_core_rate(env)), env)));
 	return NULL;
 #undef onexit
 }
+
+
+/**
+ * Set the control period of a reverb from the environment.
+ *   @reverb: The reverb.
+ *   @env: The environment.
+ *   &returns: The reverb.
+ */
+static struct amp_reverb_t *reverb_control(struct amp_reverb_t *reverb, struct ml_env_t *env)
+{
+	reverb->coef = dsp_coef_init(amp_core_control(env));
+
+	return reverb;
+}
@@ -40,7 +40,7 @@ struct amp_reverb_t *amp_reverb_bpcf2(double len, struct amp_param_t *vary, stru
 struct amp_reverb_t *amp_reverb_rescf(double len, struct amp_param_t *vary, struct amp_param_t *gain, struct amp_param_t *freq, struct amp_param_t *qual, double rate);
 
 void amp_reverb_info(struct amp_reverb_t *reverb, struct amp_info_t info);
-bool amp_reverb_proc(struct amp_reverb_t *reverb, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_reverb_proc(struct amp_reverb_t *reverb, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 char *amp_delay_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 char *amp_allpass_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
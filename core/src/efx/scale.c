@@ -99,7 +99,7 @@ void amp_scale_info(struct amp_scale_t *scale, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_scale_proc(struct amp_scale_t *scale, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_scale_proc(struct amp_scale_t *scale, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	unsigned int i;
 
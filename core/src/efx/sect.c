@@ -158,22 +158,22 @@ void amp_sect_info(struct amp_sect_t *sect, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_sect_proc(struct amp_sect_t *sect, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_sect_proc(struct amp_sect_t *sect, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	bool cont = false;
 	struct amp_sect_inst_t *inst;
-	double in[len], out[len];
+	dsp_sample_t in[len], out[len];
 
-	dsp_copy_d(in, buf, len);
-	dsp_zero_d(out, len);
+	dsp_copy_s(in, buf, len);
+	dsp_zero_s(out, len);
 
 	for(inst = sect->head; inst != NULL; inst = inst->next) {
-		dsp_copy_d(buf, in, len);
+		dsp_copy_s(buf, in, len);
 		cont |= amp_effect_proc(inst->effect, buf, time, len, queue);
-		dsp_add_d(out, buf, len);
+		dsp_add_s(out, buf, len);
 	}
 
-	dsp_copy_d(buf, out, len);
+	dsp_copy_s(buf, out, len);
 
 	return cont;
 }
@@ -36,6 +36,6 @@ void amp_sect_append(struct amp_sect_t *sect, struct amp_effect_t effect);
 char *amp_sect_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 
 void amp_sect_info(struct amp_sect_t *sect, struct amp_info_t info);
-bool amp_sect_proc(struct amp_sect_t *sect, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_sect_proc(struct amp_sect_t *sect, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 #endif
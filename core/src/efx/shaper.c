@@ -110,7 +110,7 @@ void amp_shaper_info(struct amp_shaper_t *shaper, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_shaper_proc(struct amp_shaper_t *shaper, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_shaper_proc(struct amp_shaper_t *shaper, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 
 	return false;
@@ -13,6 +13,6 @@ void amp_shaper_delete(struct amp_shaper_t *shaper);
 char *amp_shaper_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 
 void amp_shaper_info(struct amp_shaper_t *shaper, struct amp_info_t info);
-bool amp_shaper_proc(struct amp_shaper_t *shaper, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_shaper_proc(struct amp_shaper_t *shaper, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 #endif
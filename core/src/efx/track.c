@@ -70,7 +70,7 @@ void amp_track_delete(struct amp_track_t *track)
  *   @idx: The starting index.
  *   @len: The buffer length.
  */
-void amp_track_read(struct amp_track_t *track, double *buf, int idx, unsigned int len)
+void amp_track_read(struct amp_track_t *track, dsp_sample_t *buf, int idx, unsigned int len)
 {
 	unsigned int sel;
 	struct amp_track_data_t *data;
@@ -94,7 +94,7 @@ void amp_track_read(struct amp_track_t *track, double *buf, int idx, unsigned in
  *   @idx: The starting index.
  *   @len: The buffer length.
  */
-void amp_track_write(struct amp_track_t *track, const double *buf, int idx, unsigned int len)
+void amp_track_write(struct amp_track_t *track, const dsp_sample_t *buf, int idx, unsigned int len)
 {
 	unsigned int sel;
 	struct amp_track_data_t *data;
@@ -171,7 +171,7 @@ void amp_track_info(struct amp_track_t *track, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_track_proc(struct amp_track_t *track, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_track_proc(struct amp_track_t *track, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	return false;
 }
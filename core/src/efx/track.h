@@ -39,10 +39,10 @@ struct amp_track_t *amp_track_new(char *path);
 struct amp_track_t *amp_track_copy(struct amp_track_t *track);
 void amp_track_delete(struct amp_track_t *track);
 
-void amp_track_read(struct amp_track_t *track, double *buf, int idx, unsigned int len);
-void amp_track_write(struct amp_track_t *track, const double *buf, int idx, unsigned int len);
+void amp_track_read(struct amp_track_t *track, dsp_sample_t *buf, int idx, unsigned int len);
+void amp_track_write(struct amp_track_t *track, const dsp_sample_t *buf, int idx, unsigned int len);
 
 void amp_track_info(struct amp_track_t *track, struct amp_info_t info);
-bool amp_track_proc(struct amp_track_t *track, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_track_proc(struct amp_track_t *track, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 #endif
@@ -89,7 +89,7 @@ void amp_vol_info(struct amp_vol_t *vol, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_vol_proc(struct amp_vol_t *vol, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_vol_proc(struct amp_vol_t *vol, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	bool cont = false;
 	unsigned int i;
@@ -101,7 +101,7 @@ bool amp_vol_proc(struct amp_vol_t *vol, double *buf, struct amp_time_t *time, u
 			buf[i] = dsp_lpf_proc(fabs(buf[i] * (M_PI / 2.0)), lpf, &vol->s);
 	}
 	else {
-		double freq[len];
+		dsp_sample_t freq[len];
 
 		cont = amp_param_proc(vol->lpf, freq, time, len, queue);
 
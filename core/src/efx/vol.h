@@ -25,6 +25,6 @@ void amp_vol_delete(struct amp_vol_t *vol);
 char *amp_vol_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 
 void amp_vol_info(struct amp_vol_t *vol, struct amp_info_t info);
-bool amp_vol_proc(struct amp_vol_t *vol, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_vol_proc(struct amp_vol_t *vol, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 #endif
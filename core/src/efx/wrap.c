@@ -98,7 +98,7 @@ static inline double dsp_wrap_d(double v, double limit)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_wrap_proc(struct amp_wrap_t *wrap, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_wrap_proc(struct amp_wrap_t *wrap, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	unsigned int i;
 	bool cont = false;
@@ -110,7 +110,7 @@ bool amp_wrap_proc(struct amp_wrap_t *wrap, double *buf, struct amp_time_t *time
 			buf[i] = dsp_wrap_d(buf[i], limit);
 	}
 	else {
-		double limit[len];
+		dsp_sample_t limit[len];
 
 		cont |= amp_param_proc(wrap->limit, limit, time, len, queue);
 
@@ -21,6 +21,6 @@ void amp_wrap_delete(struct amp_wrap_t *wrap);
 char *amp_wrap_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 
 void amp_wrap_info(struct amp_wrap_t *wrap, struct amp_info_t info);
-bool amp_wrap_proc(struct amp_wrap_t *wrap, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_wrap_proc(struct amp_wrap_t *wrap, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 #endif
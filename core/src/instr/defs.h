@@ -10,7 +10,7 @@
  *   @queue: Action queue.
  *   &returns: The continuation flag.
  */
-typedef bool (*amp_instr_f)(void *ref, double **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+typedef bool (*amp_instr_f)(void *ref, dsp_sample_t **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 /**
  * Instrument interface.
@@ -46,6 +46,11 @@ static inline void amp_instr_info(struct amp_instr_t instr, struct amp_info_t in
 	instr.iface->info(instr.ref, info);
 }
 
+/*
+ * profiler declarations
+ */
+bool amp_prof_instr(struct amp_instr_t instr, dsp_sample_t **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+
 /**
  * Process an instrument.
  *   @instr: The instrument.
@@ -55,8 +60,11 @@ static inline void amp_instr_info(struct amp_instr_t instr, struct amp_info_t in
  *   @queue: Action queue.
  *   &returns: The continuation flag.
  */
-static inline bool amp_instr_proc(struct amp_instr_t instr, double **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+static inline bool amp_instr_proc(struct amp_instr_t instr, dsp_sample_t **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
+	if(__atomic_load_n(&amp_prof, __ATOMIC_RELAXED) != NULL)
+		return amp_prof_instr(instr, buf, time, len, queue);
+
 	return instr.iface->proc(instr.ref, buf, time, len, queue);
 }
 
@@ -1,9 +1,29 @@
 #include "../common.h"
 
 
+/**
+ * Branch structure.
+ *   @arr: The instance array.
+ *   @buf: The input buffer.
+ *   @scratch: The scratch buffers, four channels of capacity length per slot.
+ *   @time: The time.
+ *   @len, cap: The length and the slot capacity.
+ *   @queue: The action queue.
+ */
+struct amp_mixer_branch_t {
+	struct amp_mixer_inst_t **arr;
+	dsp_sample_t **buf, *scratch;
+	struct amp_time_t *time;
+	unsigned int len, cap;
+	struct amp_queue_t *queue;
+};
+
+
 /*
  * local declarations
  */
+static void mixer_branch(void *arg, unsigned int idx, unsigned int slot);
+
 struct amp_instr_i amp_mixer_iface = {
 	(amp_info_f)amp_mixer_info,
 	(amp_instr_f)amp_mixer_proc,
@@ -14,14 +34,20 @@ struct amp_instr_i amp_mixer_iface = {
 
 /**
  * Create a new mixer.
+ *   @pool: Optional. The worker pool used to process instances in parallel.
  *   &returns: The mixer.
  */
-struct amp_mixer_t *amp_mixer_new(void)
+struct amp_mixer_t *amp_mixer_new(struct amp_pool_t *pool)
 {
 	struct amp_mixer_t *mixer;
 
 	mixer = malloc(sizeof(struct amp_mixer_t));
+	mixer->pool = pool;
+	mixer->len = 0;
 	mixer->head = mixer->tail = NULL;
+	mixer->nslots = amp_pool_nslots(pool, UINT_MAX);
+	mixer->cap = AMP_MIXER_CAP;
+	mixer->scratch = malloc(4 * mixer->nslots * mixer->cap * sizeof(dsp_sample_t));
 
 	return mixer;
 }
@@ -36,7 +62,7 @@ struct amp_mixer_t *amp_mixer_copy(struct amp_mixer_t *mixer)
 	struct amp_mixer_inst_t *inst;
 	struct amp_mixer_t *copy;
 
-	copy = amp_mixer_new();
+	copy = amp_mixer_new(mixer->pool);
 
 	for(inst = mixer->head; inst != NULL; inst = inst->next)
 		amp_mixer_append(copy, amp_instr_copy(inst->instr));
@@ -59,6 +85,7 @@ void amp_mixer_delete(struct amp_mixer_t *mixer)
 		free(cur);
 	}
 
+	free(mixer->scratch);
 	free(mixer);
 }
 
@@ -76,7 +103,7 @@ char *amp_mixer_make(struct ml_value_t **ret, struct ml_value_t *value, struct m
 	struct amp_mixer_t *mixer;
 	struct ml_link_t *link;
 
-	mixer = amp_mixer_new();
+	mixer = amp_mixer_new(amp_core_get(env)->pool);
 
 	if(value->type != ml_value_list_v)
 		fail("%C: Type error. Instrument mixer requires a list of instrument as input.", ml_tag_chunk(&value->tag));
@@ -111,6 +138,7 @@ void amp_mixer_prepend(struct amp_mixer_t *mixer, struct amp_instr_t instr)
 	inst->prev = NULL;
 	*(mixer->head ? &mixer->head->prev : &mixer->tail) = inst;
 	mixer->head = inst;
+	mixer->len++;
 }
 
 /**
@@ -128,6 +156,7 @@ void amp_mixer_append(struct amp_mixer_t *mixer, struct amp_instr_t instr)
 	inst->next = NULL;
 	*(mixer->tail ? &mixer->tail->next : &mixer->head) = inst;
 	mixer->tail = inst;
+	mixer->len++;
 }
 
 
@@ -145,34 +174,81 @@ void amp_mixer_info(struct amp_mixer_t *mixer, struct amp_info_t info)
 }
 
 /**
- * Process a mixer.
+ * Process a mixer. Every instance receives a copy of the input and of the
+ * action queue, so instances are independent and may be processed in
+ * parallel on the worker pool before being summed. The scratch buffers are
+ * only reallocated when the block length exceeds every previous block.
  *   @mixer: The mixer.
  *   @buf: The buffer.
  *   @time: The time.
  *   @len: The length.
  *   @queue: The action queue.
  */
-void amp_mixer_proc(struct amp_mixer_t *mixer, double **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+void amp_mixer_proc(struct amp_mixer_t *mixer, dsp_sample_t **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
-	double in[2][len], out[2][len];
-	struct amp_mixer_inst_t *inst;
+	unsigned int i, n, nslots;
+	dsp_sample_t *acc;
+	struct amp_mixer_inst_t *inst, *arr[mixer->len ?: 1];
 
-	dsp_copy_d(in[0], buf[0], len);
-	dsp_copy_d(in[1], buf[1], len);
+	if(len > mixer->cap) {
+		while(len > mixer->cap)
+			mixer->cap *= 2;
 
-	dsp_zero_d(out[0], len);
-	dsp_zero_d(out[1], len);
+		free(mixer->scratch);
+		mixer->scratch = malloc(4 * mixer->nslots * mixer->cap * sizeof(dsp_sample_t));
+	}
 
-	for(inst = mixer->head; inst != NULL; inst = inst->next) {
-		dsp_copy_d(buf[0], in[0], len);
-		dsp_copy_d(buf[1], in[1], len);
+	for(inst = mixer->head, n = 0; inst != NULL; inst = inst->next)
+		arr[n++] = inst;
 
-		amp_instr_proc(inst->instr, buf, time, len, queue);
+	nslots = amp_pool_nslots(mixer->pool, n);
+	for(i = 0; i < nslots; i++) {
+		acc = mixer->scratch + 4 * mixer->cap * i;
+		dsp_zero_s(acc, len);
+		dsp_zero_s(acc + mixer->cap, len);
+	}
+
+	struct amp_mixer_branch_t branch = { arr, buf, mixer->scratch, time, len, mixer->cap, queue };
 
-		dsp_add_d(out[0], buf[0], len);
-		dsp_add_d(out[1], buf[1], len);
+	if(nslots > 1)
+		amp_pool_exec(mixer->pool, mixer_branch, &branch, n);
+	else {
+		for(i = 0; i < n; i++)
+			mixer_branch(&branch, i, 0);
 	}
 
-	dsp_copy_d(buf[0], out[0], len);
-	dsp_copy_d(buf[1], out[1], len);
+	acc = mixer->scratch;
+	for(i = 1; i < nslots; i++) {
+		dsp_add_s(acc, acc + 4 * mixer->cap * i, len);
+		dsp_add_s(acc + mixer->cap, acc + 4 * mixer->cap * i + mixer->cap, len);
+	}
+
+	dsp_copy_s(buf[0], acc, len);
+	dsp_copy_s(buf[1], acc + mixer->cap, len);
+}
+
+/**
+ * Process a single mixer branch.
+ *   @arg: The branch structure.
+ *   @idx: The instance index.
+ *   @slot: The accumulator slot.
+ */
+static void mixer_branch(void *arg, unsigned int idx, unsigned int slot)
+{
+	struct amp_mixer_branch_t *branch = arg;
+	unsigned int len = branch->len, cap = branch->cap;
+	dsp_sample_t *buf[2], *acc;
+	struct amp_queue_t queue;
+
+	acc = branch->scratch + 4 * cap * slot;
+	buf[0] = acc + 2 * cap;
+	buf[1] = acc + 3 * cap;
+	dsp_copy_s(buf[0], branch->buf[0], len);
+	dsp_copy_s(buf[1], branch->buf[1], len);
+	amp_queue_copy(&queue, branch->queue);
+
+	amp_instr_proc(branch->arr[idx]->instr, buf, branch->time, len, &queue);
+
+	dsp_add_s(acc, buf[0], len);
+	dsp_add_s(acc + cap, buf[1], len);
 }
@@ -1,12 +1,27 @@
 #ifndef INSTR_MIXER_H
 #define INSTR_MIXER_H
 
+/**
+ * Initial block capacity of the mixer scratch buffers.
+ */
+#define AMP_MIXER_CAP 1024
+
 /**
  * Mixer structure.
+ *   @pool: Optional. The worker pool.
+ *   @len: The number of instances.
  *   @head, tail: The head and tail instances.
+ *   @nslots, cap: The number of slots and the block capacity per slot.
+ *   @scratch: The scratch buffers, an accumulator and working pair per slot.
  */
 struct amp_mixer_t {
+	struct amp_pool_t *pool;
+
+	unsigned int len;
 	struct amp_mixer_inst_t *head, *tail;
+
+	unsigned int nslots, cap;
+	dsp_sample_t *scratch;
 };
 
 /**
@@ -25,7 +40,7 @@ struct amp_mixer_inst_t {
  */
 extern struct amp_instr_i amp_mixer_iface;
 
-struct amp_mixer_t *amp_mixer_new(void);
+struct amp_mixer_t *amp_mixer_new(struct amp_pool_t *pool);
 struct amp_mixer_t *amp_mixer_copy(struct amp_mixer_t *mixer);
 void amp_mixer_delete(struct amp_mixer_t *mixer);
 
@@ -35,7 +50,7 @@ void amp_mixer_prepend(struct amp_mixer_t *mixer, struct amp_instr_t instr);
 void amp_mixer_append(struct amp_mixer_t *mixer, struct amp_instr_t instr);
 
 void amp_mixer_info(struct amp_mixer_t *mixer, struct amp_info_t info);
-void amp_mixer_proc(struct amp_mixer_t *mixer, double **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+void amp_mixer_proc(struct amp_mixer_t *mixer, dsp_sample_t **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 struct amp_mixer_inst_t *amp_mixer_first(struct amp_mixer_t *mixer);
 struct amp_mixer_inst_t *amp_mixer_last(struct amp_mixer_t *mixer);
@@ -154,7 +154,7 @@ void amp_series_info(struct amp_series_t *series, struct amp_info_t info)
  *   @len: The length.
  *   @queue: The action queue.
  */
-void amp_series_proc(struct amp_series_t *series, double **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+void amp_series_proc(struct amp_series_t *series, dsp_sample_t **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	struct amp_series_inst_t *inst;
 
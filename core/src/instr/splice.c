@@ -85,16 +85,16 @@ void amp_splice_info(struct amp_splice_t *splice, struct amp_info_t info)
  *   @time: The time.
  *   @len: The length.
  */
-void amp_splice_proc(struct amp_splice_t *splice, double **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+void amp_splice_proc(struct amp_splice_t *splice, dsp_sample_t **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	unsigned int i;
-	double tmp[len];
+	dsp_sample_t tmp[len];
 
 	for(i = 0; i < len; i++)
 		tmp[i] = buf[0][i] + buf[1][i];
 
 	amp_effect_proc(splice->effect, tmp, time, len, queue);
 
-	dsp_copy_d(buf[0], tmp, len);
-	dsp_copy_d(buf[1], tmp, len);
+	dsp_copy_s(buf[0], tmp, len);
+	dsp_copy_s(buf[1], tmp, len);
 }
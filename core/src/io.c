@@ -1,5 +1,9 @@
 #include "common.h"
 
+#ifndef WINDOWS
+#	include <sys/mman.h>
+#endif
+
 /*****************************************************************************
  * The I/O manager enables components to asynchronously read and write data to
  * the real time thread. The I/O manager is composed to two pieces: 1) the
@@ -9,27 +13,34 @@
  * are split into two halves, and once one half is filled, the asynchronous
  * thread is woken up to process the data at a relatively slow pace; the
  * thread must finish processing data before the next buffer half is filled.
+ *
+ * The thread also services sample streams (see 'cache.c'). Streams are
+ * refilled whenever the thread is kicked; the audio thread only ever attempts
+ * the lock, so a missed kick is retried on a later block instead of blocking.
  ****************************************************************************/
 
 
 /**
  * I/O manager structure.
- *   @terminate flag.
+ *   @term: Terminate flag.
+ *   @flip, kick, mlock: The buffer flip, kick, and memory lock flags.
  *   @lock: The lock.
  *   @cond: The condition variable.
  *   @thread: Processing thread.
  *   @idx, sel: The index and buffer selector.
- *   @read, write: The read and write lists.
+ *   @read, write, stream: The read, write, and stream lists.
+ *   @underrun: The underrun count of deleted streams.
  */
 struct amp_io_t {
-	bool term;
+	bool term, flip, kick, mlock;
 	sys_mutex_t lock;
 	sys_cond_t cond;
 	sys_thread_t thread;
 
 	unsigned int idx, sel;
 
-	struct list_root_t read, write;
+	struct list_root_t read, write, stream;
+	uint64_t underrun;
 };
 
 /**
@@ -45,7 +56,7 @@ struct amp_read_t {
 	struct amp_io_t *io;
 
 	unsigned int idx;
-	double buf[AMP_IO_LEN];
+	dsp_sample_t buf[AMP_IO_LEN];
 
 	amp_read_f func;
 	void *arg;
@@ -66,7 +77,7 @@ struct amp_write_t {
 	struct amp_io_t *io;
 
 	unsigned int idx;
-	double buf[AMP_IO_LEN];
+	dsp_sample_t buf[AMP_IO_LEN];
 
 	amp_write_f func;
 	void *arg;
@@ -90,10 +101,13 @@ struct amp_io_t *amp_io_new(void)
 	struct amp_io_t *io;
 
 	io = malloc(sizeof(struct amp_io_t));
+	io->term = io->flip = io->kick = io->mlock = false;
+	io->idx = io->sel = 0;
 	io->lock = sys_mutex_init(0);
 	io->cond = sys_cond_init(0);
+	io->read = io->write = io->stream = list_root_init();
+	io->underrun = 0;
 	io->thread = sys_thread_create(0, callback, io);
-	io->read = io->write = list_root_init();
 
 	return io;
 }
@@ -104,8 +118,8 @@ struct amp_io_t *amp_io_new(void)
  */
 void amp_io_delete(struct amp_io_t *io)
 {
-	io->term = true;
 	sys_mutex_lock(&io->lock);
+	io->term = true;
 	sys_cond_signal(&io->cond);
 	sys_mutex_unlock(&io->lock);
 
@@ -150,10 +164,60 @@ void amp_io_proc(struct amp_io_t *io, unsigned int len)
 	//}
 
 	sys_mutex_lock(&io->lock);
+	io->flip = true;
 	sys_cond_signal(&io->cond);
 	sys_mutex_unlock(&io->lock);
 }
 
+/**
+ * Kick the I/O thread to refill its streams. This function never blocks and
+ * may be called from the audio thread.
+ *   @io: The I/O manager.
+ */
+void amp_io_kick(struct amp_io_t *io)
+{
+	__atomic_store_n(&io->kick, true, __ATOMIC_RELEASE);
+
+	if(sys_mutex_trylock(&io->lock)) {
+		sys_cond_signal(&io->cond);
+		sys_mutex_unlock(&io->lock);
+	}
+}
+
+/**
+ * Set whether stream rings are locked into memory as they are attached.
+ * Rings are never unlocked, since their pages may be shared with other
+ * locked allocations.
+ *   @io: The I/O manager.
+ *   @enable: The enable flag.
+ */
+void amp_io_lock(struct amp_io_t *io, bool enable)
+{
+	io->mlock = enable;
+}
+
+/**
+ * Retrieve the number of stream samples that were not ready in time, summed
+ * over every stream of the I/O manager.
+ *   @io: The I/O manager.
+ *   &returns: The underrun count.
+ */
+uint64_t amp_io_underrun(struct amp_io_t *io)
+{
+	uint64_t sum;
+	struct list_node_t *node;
+
+	sys_mutex_lock(&io->lock);
+
+	sum = io->underrun;
+	for(node = io->stream.head; node != NULL; node = node->next)
+		sum += amp_stream_underrun(getparent(node, struct amp_stream_t, node));
+
+	sys_mutex_unlock(&io->lock);
+
+	return sum;
+}
+
 /**
  * Prepare an I/O manager.
  *   @io: The I/O manager.
@@ -197,24 +261,30 @@ static void *callback(void *arg)
 {
 	struct amp_read_t *read;
 	struct amp_write_t *write;
+	struct list_node_t *node;
 	struct amp_io_t *io = arg;
 	unsigned int sel = 0;
 
 	sys_mutex_lock(&io->lock);
 
-	while(true) {
-		sys_cond_wait(&io->cond, &io->lock);
-
-		if(io->term)
-			break;
+	while(!io->term) {
+		if(io->flip) {
+			io->flip = false;
 
-		for(read = amp_read_first(io); read != NULL; read = amp_read_next(read))
-			read->func(read->buf + sel * AMP_IO_LEN, AMP_IO_LEN, read->arg);
+			for(read = amp_read_first(io); read != NULL; read = amp_read_next(read))
+				read->func(read->buf + sel * (AMP_IO_LEN / 2), AMP_IO_LEN / 2, read->arg);
 
-		for(write = amp_write_first(io); write != NULL; write = amp_write_next(write))
-			write->func(write->buf + sel * AMP_IO_LEN, AMP_IO_LEN, write->arg);
+			for(write = amp_write_first(io); write != NULL; write = amp_write_next(write))
+				write->func(write->buf + sel * (AMP_IO_LEN / 2), AMP_IO_LEN / 2, write->arg);
 
-		sel = 1 - sel;
+			sel = 1 - sel;
+		}
+		else if(__atomic_exchange_n(&io->kick, false, __ATOMIC_ACQUIRE)) {
+			for(node = io->stream.head; node != NULL; node = node->next)
+				amp_stream_fill(getparent(node, struct amp_stream_t, node));
+		}
+		else
+			sys_cond_wait(&io->cond, &io->lock);
 	}
 
 	sys_mutex_unlock(&io->lock);
@@ -223,6 +293,38 @@ static void *callback(void *arg)
 }
 
 
+/**
+ * Add a stream to the I/O manager.
+ *   @io: The I/O manager.
+ *   @stream: The stream.
+ */
+void amp_io_attach(struct amp_io_t *io, struct amp_stream_t *stream)
+{
+#ifndef WINDOWS
+	if(io->mlock && (mlock(stream->ring, stream->len * sizeof(float)) < 0))
+		fprintf(stderr, "Failed to lock stream ring. %s.\n", strerror(errno));
+#endif
+
+	sys_mutex_lock(&io->lock);
+	list_root_append(&io->stream, &stream->node);
+	sys_mutex_unlock(&io->lock);
+}
+
+/**
+ * Remove a stream from the I/O manager. Once returned, the I/O thread no
+ * longer accesses the stream.
+ *   @io: The I/O manager.
+ *   @stream: The stream.
+ */
+void amp_io_detach(struct amp_io_t *io, struct amp_stream_t *stream)
+{
+	sys_mutex_lock(&io->lock);
+	list_root_remove(&io->stream, &stream->node);
+	io->underrun += amp_stream_underrun(stream);
+	sys_mutex_unlock(&io->lock);
+}
+
+
 /**
  * Create a new reader.
  *   @io: The I/O manager.
@@ -261,7 +363,7 @@ void amp_read_delete(struct amp_read_t *read)
  *   @buf: The buffer.
  *   @len: The length.
  */
-void amp_read_proc(struct amp_read_t *read, double *buf, unsigned int len)
+void amp_read_proc(struct amp_read_t *read, dsp_sample_t *buf, unsigned int len)
 {
 	while(len-- > 0) {
 		*(buf++) += read->buf[read->idx];
@@ -334,7 +436,7 @@ void amp_write_delete(struct amp_write_t *write)
  *   @buf: The buffer.
  *   @len: The length.
  */
-void amp_write_proc(struct amp_write_t *write, const double *buf, unsigned int len)
+void amp_write_proc(struct amp_write_t *write, const dsp_sample_t *buf, unsigned int len)
 {
 	while(len-- > 0) {
 		write->buf[write->idx] = *(buf++);
@@ -12,7 +12,7 @@
  *   @len: The buffer length.
  *   @arg: The argument.
  */
-typedef void (*amp_read_f)(double *buf, unsigned int len, void *arg);
+typedef void (*amp_read_f)(dsp_sample_t *buf, unsigned int len, void *arg);
 
 /**
  * Write callback.
@@ -20,7 +20,7 @@ typedef void (*amp_read_f)(double *buf, unsigned int len, void *arg);
  *   @len: The buffer length.
  *   @arg: The argument.
  */
-typedef void (*amp_write_f)(const double *buf, unsigned int len, void *arg);
+typedef void (*amp_write_f)(const dsp_sample_t *buf, unsigned int len, void *arg);
 
 /*
  * io declarations
@@ -28,8 +28,15 @@ typedef void (*amp_write_f)(const double *buf, unsigned int len, void *arg);
 struct amp_io_t *amp_io_new(void);
 void amp_io_delete(struct amp_io_t *io);
 
+void amp_io_proc(struct amp_io_t *io, unsigned int len);
 void amp_io_prep(struct amp_io_t *io);
 void amp_io_flush(struct amp_io_t *io);
+void amp_io_kick(struct amp_io_t *io);
+void amp_io_lock(struct amp_io_t *io, bool enable);
+uint64_t amp_io_underrun(struct amp_io_t *io);
+
+void amp_io_attach(struct amp_io_t *io, struct amp_stream_t *stream);
+void amp_io_detach(struct amp_io_t *io, struct amp_stream_t *stream);
 
 /*
  * reader declarations
@@ -37,9 +44,9 @@ void amp_io_flush(struct amp_io_t *io);
 struct amp_read_t *amp_read_new(struct amp_io_t *io, amp_read_f func, void *arg);
 void amp_read_delete(struct amp_read_t *read);
 
-void amp_read_proc(struct amp_read_t *read, double *buf, unsigned int len);
+void amp_read_proc(struct amp_read_t *read, dsp_sample_t *buf, unsigned int len);
 struct amp_read_t *amp_read_first(struct amp_io_t *io);
-struct amp_read_t *amp_read_next(struct amp_read_t *read);;
+struct amp_read_t *amp_read_next(struct amp_read_t *read);
 
 /*
  * writer declarations
@@ -47,7 +54,7 @@ struct amp_read_t *amp_read_next(struct amp_read_t *read);;
 struct amp_write_t *amp_write_new(struct amp_io_t *io, amp_write_f func, void *arg);
 void amp_write_delete(struct amp_write_t *write);
 
-void amp_write_proc(struct amp_write_t *write, const double *buf, unsigned int len);
+void amp_write_proc(struct amp_write_t *write, const dsp_sample_t *buf, unsigned int len);
 struct amp_write_t *amp_write_first(struct amp_io_t *io);
 struct amp_write_t *amp_write_next(struct amp_write_t *write);
 
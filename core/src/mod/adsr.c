@@ -135,15 +135,15 @@ void amp_adsr_info(struct amp_adsr_t *adsr, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_adsr_proc(struct amp_adsr_t *adsr, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_adsr_proc(struct amp_adsr_t *adsr, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	double v;
-	unsigned int i, n = 0;
+	unsigned int i, end, n = 0;
 	struct amp_event_t *event;
 
 	v = adsr->v;
 
-	for(i = 0; i < len; i++) {
+	for(i = 0; i < len; ) {
 		while((event = amp_queue_event(queue, &n, i)) != NULL) {
 			double vel;
 
@@ -160,22 +160,29 @@ bool amp_adsr_proc(struct amp_adsr_t *adsr, double *buf, struct amp_time_t *time
 			adsr->target[1] = fmax(vel * adsr->sus, 0.01);
 		}
 
-		if(v < adsr->target[0]) {
-			v *= adsr->atk;
-			if(v >= adsr->target[0]) {
-				v = adsr->target[0];
-				adsr->target[0] = adsr->target[1];
+		for(end = amp_queue_split(queue, n, len); i < end; i++) {
+			if(v < adsr->target[0]) {
+				v *= adsr->atk;
+				if(v >= adsr->target[0]) {
+					v = adsr->target[0];
+					adsr->target[0] = adsr->target[1];
+				}
 			}
-		}
-		else if(v > adsr->target[0]) {
-			v *= adsr->on ? adsr->rel : adsr->decay;
-			if(v <= adsr->target[0]) {
-				v = adsr->target[0];
-				adsr->target[0] = adsr->target[1];
+			else if(v > adsr->target[0]) {
+				v *= adsr->on ? adsr->rel : adsr->decay;
+				if(v <= adsr->target[0]) {
+					v = adsr->target[0];
+					adsr->target[0] = adsr->target[1];
+				}
 			}
+			else
+				break;
+
+			buf[i] = v - 0.01;
 		}
 
-		buf[i] = v - 0.01;
+		for(; i < end; i++)
+			buf[i] = v - 0.01;
 	}
 
 	adsr->v = v;
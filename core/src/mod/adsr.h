@@ -15,6 +15,6 @@ void amp_adsr_delete(struct amp_adsr_t *adsr);
 char *amp_adsr_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 
 void amp_adsr_info(struct amp_adsr_t *adsr, struct amp_info_t info);
-bool amp_adsr_proc(struct amp_adsr_t *adsr, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_adsr_proc(struct amp_adsr_t *adsr, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 #endif
@@ -10,7 +10,7 @@
  *   @queue: The action queue.
  *   @cont: The continuation flag.
  */
-typedef bool (*amp_module_f)(void *ref, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+typedef bool (*amp_module_f)(void *ref, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 /**
  * Module interface.
@@ -51,6 +51,11 @@ static inline void amp_module_info(struct amp_module_t module, struct amp_info_t
 	module.iface->info(module.ref, info);
 }
 
+/*
+ * profiler declarations
+ */
+bool amp_prof_module(struct amp_module_t module, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+
 /**
  * Process a module.
  *   @module: The module.
@@ -60,8 +65,11 @@ static inline void amp_module_info(struct amp_module_t module, struct amp_info_t
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-static inline bool amp_module_proc(struct amp_module_t module, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+static inline bool amp_module_proc(struct amp_module_t module, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
+	if(__atomic_load_n(&amp_prof, __ATOMIC_RELAXED) != NULL)
+		return amp_prof_module(module, buf, time, len, queue);
+
 	return module.iface->proc(module.ref, buf, time, len, queue);
 }
 
@@ -200,31 +200,31 @@ void amp_fold_info(struct amp_fold_t *fold, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_fold_proc(struct amp_fold_t *fold, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_fold_proc(struct amp_fold_t *fold, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	bool cont = false;
 	struct inst_t *inst;
-	double tmp[len];
+	dsp_sample_t tmp[len];
 
 	switch(fold->type) {
 	case amp_fold_add_v:
-		dsp_zero_d(buf, len);
+		dsp_zero_s(buf, len);
 
 		for(inst = fold->head; inst != NULL; inst = inst->next) {
-			dsp_zero_d(tmp, len);
+			dsp_zero_s(tmp, len);
 			cont |= amp_param_proc(inst->param, tmp, time, len, queue);
-			dsp_add_d(buf, tmp, len);
+			dsp_add_s(buf, tmp, len);
 		}
 
 		break;
 
 	case amp_fold_mul_v:
-		dsp_one_d(buf, len);
+		dsp_one_s(buf, len);
 
 		for(inst = fold->head; inst != NULL; inst = inst->next) {
-			dsp_zero_d(tmp, len);
+			dsp_zero_s(tmp, len);
 			cont |= amp_param_proc(inst->param, tmp, time, len, queue);
-			dsp_mul_d(buf, tmp, len);
+			dsp_mul_s(buf, tmp, len);
 		}
 
 		break;
@@ -31,6 +31,6 @@ void amp_fold_prepend(struct amp_fold_t *fold, struct amp_param_t *param);
 void amp_fold_append(struct amp_fold_t *fold, struct amp_param_t *param);
 
 void amp_fold_info(struct amp_fold_t *fold, struct amp_info_t info);
-bool amp_fold_proc(struct amp_fold_t *fold, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_fold_proc(struct amp_fold_t *fold, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 #endif
@@ -100,11 +100,11 @@ void amp_mul_info(struct amp_mul_t *mul, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_mul_proc(struct amp_mul_t *mul, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_mul_proc(struct amp_mul_t *mul, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	unsigned int i;
 	bool cont = false;
-	double left[len], right[len];
+	dsp_sample_t left[len], right[len];
 
 	cont |= amp_param_proc(mul->left, left, time, len, queue);
 	cont |= amp_param_proc(mul->right, right, time, len, queue);
@@ -15,6 +15,6 @@ void amp_mul_delete(struct amp_mul_t *mul);
 char *amp_mul_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 
 void amp_mul_info(struct amp_mul_t *mul, struct amp_info_t info);
-bool amp_mul_proc(struct amp_mul_t *mul, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_mul_proc(struct amp_mul_t *mul, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 #endif
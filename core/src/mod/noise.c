@@ -91,7 +91,7 @@ void amp_noise_info(struct amp_noise_t *noise, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_noise_proc(struct amp_noise_t *noise, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_noise_proc(struct amp_noise_t *noise, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	unsigned int i;
 	
@@ -15,6 +15,6 @@ void amp_noise_delete(struct amp_noise_t *noise);
 char *amp_noise_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 
 void amp_noise_info(struct amp_noise_t *noise, struct amp_info_t info);
-bool amp_noise_proc(struct amp_noise_t *noise, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_noise_proc(struct amp_noise_t *noise, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 #endif
@@ -163,10 +163,10 @@ void amp_osc_info(struct amp_osc_t *osc, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_osc_proc(struct amp_osc_t *osc, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_osc_proc(struct amp_osc_t *osc, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	bool cont;
-	double phase[len];
+	dsp_sample_t phase[len];
 	unsigned int i;
 
 	cont = amp_module_proc(osc->phase, phase, time, len, queue);
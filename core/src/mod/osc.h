@@ -33,7 +33,7 @@ char *amp_square_make(struct ml_value_t **ret, struct ml_value_t *value, struct
 char *amp_impulse_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 
 void amp_osc_info(struct amp_osc_t *osc, struct amp_info_t info);
-bool amp_osc_proc(struct amp_osc_t *osc, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_osc_proc(struct amp_osc_t *osc, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 int amp_osc_type(const char *str);
 
@@ -103,7 +103,7 @@ void amp_patch_info(struct amp_patch_t *patch, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_patch_proc(struct amp_patch_t *patch, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_patch_proc(struct amp_patch_t *patch, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	bool cont = false;
 
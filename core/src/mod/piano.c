@@ -15,35 +15,36 @@ struct amp_piano_vel_t {
 
 /**
  * Piano key structure.
- *   @idx: The play index.
  *   @n: The number of velocities.
  *   @vel: The velocity array.
  */
 struct amp_piano_key_t {
-	int idx;
 	unsigned int n;
 	struct amp_piano_vel_t *vel;
 };
 
 /**
  * Piano structure.
- *   @mul, rate: The decay multiplier and sample rate.
+ *   @mul, rate, fade: The decay multiplier, sample rate, and fade multiplier.
  *   @dev, pedal: The device and pedal key.
  *   @key: The keys array.
  *   @on: The pedal on flag.
- *   @n: The play count.
- *   @play: The playback array.
- *   @state: The state array.
+ *   @n: The number of simultaneous voices.
+ *   @voices: The voice manager.
+ *   @play: The playback array, one per voice slot.
+ *   @io: Optional. The I/O manager, used to stream files.
  */
 struct amp_piano_t {
-	float mul, rate;
+	float mul, rate, fade;
 	uint16_t dev, pedal;
 	struct amp_piano_key_t key[128];
 
 	bool on;
 	unsigned int n;
+	struct amp_voices_t *voices;
 	struct amp_play_t *play;
-	int8_t *state;
+
+	struct amp_io_t *io;
 };
 
 
@@ -59,13 +60,16 @@ const struct amp_module_i amp_piano_iface = {
 
 
 /**
- * Create a piano.
+ * Create a piano. When streaming, every playback is given its own stream so
+ * that memory use follows the number of voices and not the library size.
  *   @dev: The device.
  *   @simul: The number of simultaneous playback.
  *   @rate: The sample rate.
+ *   @io: Optional. The I/O manager for streaming.
+ *   @steal: The voice stealing policy.
  *   &returns: The piano.
  */
-struct amp_piano_t *amp_piano_new(uint16_t dev, unsigned int simul, float rate)
+struct amp_piano_t *amp_piano_new(uint16_t dev, unsigned int simul, float rate, struct amp_io_t *io, enum amp_steal_e steal)
 {
 	struct amp_piano_t *piano;
 	unsigned int i;
@@ -76,16 +80,20 @@ struct amp_piano_t *amp_piano_new(uint16_t dev, unsigned int simul, float rate)
 	piano->n = simul;
 	piano->mul = 0.0f;
 	piano->rate = rate;
+	piano->fade = amp_voice_fade(rate);
 	piano->on = false;
-	piano->play = malloc(simul * sizeof(struct amp_play_t));
-	amp_play_init(piano->play, simul);
-
-	piano->state = malloc(simul * sizeof(int8_t));
-	for(i = 0; i < simul; i++)
-		piano->state[i] = -1;
+	piano->io = io;
+	piano->voices = amp_voices_new(simul, steal);
+	piano->play = malloc(piano->voices->total * sizeof(struct amp_play_t));
+	amp_play_init(piano->play, piano->voices->total);
+
+	if(io != NULL) {
+		for(i = 0; i < piano->voices->total; i++)
+			piano->play[i].stream = amp_stream_new(io, rate);
+	}
 
 	for(i = 0; i < 128; i++)
-		piano->key[i] = (struct amp_piano_key_t){ 0, 0, malloc(0) };
+		piano->key[i] = (struct amp_piano_key_t){ 0, malloc(0) };
 
 	return piano;
 }
@@ -101,7 +109,7 @@ struct amp_piano_t *amp_piano_copy(struct amp_piano_t *piano)
 	unsigned int i, j, k;
 	struct amp_piano_vel_t *vel;
 	
-	copy = amp_piano_new(piano->dev, piano->n, piano->rate);
+	copy = amp_piano_new(piano->dev, piano->n, piano->rate, piano->io, piano->voices->steal);
 	copy->mul = piano->mul;
 	copy->pedal = piano->pedal;
 
@@ -136,8 +144,13 @@ void amp_piano_delete(struct amp_piano_t *piano)
 		free(piano->key[i].vel);
 	}
 
+	if(piano->io != NULL) {
+		for(i = 0; i < piano->voices->total; i++)
+			amp_stream_delete(piano->play[i].stream);
+	}
+
 	free(piano->play);
-	free(piano->state);
+	amp_voices_delete(piano->voices);
 	free(piano);
 }
 
@@ -153,6 +166,7 @@ char *amp_piano_make(struct ml_value_t **ret, struct ml_value_t *value, struct m
 {
 #define onexit if(piano != NULL) amp_piano_delete(piano);
 	int dev, idx = 0;
+	unsigned int head;
 	struct ml_link_t *iter1, *iter2, *link;
 	struct ml_value_t *list, *opt;
 	struct amp_piano_t *piano = NULL;
@@ -161,7 +175,8 @@ char *amp_piano_make(struct ml_value_t **ret, struct ml_value_t *value, struct m
 	struct amp_cache_t *cache = amp_core_cache(env);
 
 	chkfail(amp_match_unpack(value, "(d,O,O)", &dev, &list, &opt));
-	piano = amp_piano_new(dev, 24, amp_core_rate(env));
+	head = amp_core_stream(env) * amp_core_rate(env);
+	piano = amp_piano_new(dev, 24, amp_core_rate(env), (head > 0) ? amp_core_get(env)->io : NULL, amp_core_steal(env, amp_steal_quiet_v));
 
 	if(list->type != ml_value_list_v)
 		fail("%C: Type mismatch.", ml_tag_chunk(&value->tag));
@@ -189,10 +204,7 @@ char *amp_piano_make(struct ml_value_t **ret, struct ml_value_t *value, struct m
 				if(link->value->type != ml_value_str_v)
 					fail("%C: Type mismatch.", ml_tag_chunk(&value->tag));
 
-				file = amp_cache_open(cache, link->value->data.str, 0, amp_core_rate(env));
-				if(file == NULL)
-					fail("%C: Unable to open file '%s'.", ml_tag_chunk(&value->tag), link->value->data.str);
-
+				file = amp_cache_stream(cache, link->value->data.str, 0, amp_core_rate(env), amp_core_quality(env), head);
 				amp_piano_rr(vel, file);
 			}
 		}
@@ -253,7 +265,7 @@ void amp_piano_info(struct amp_piano_t *piano, struct amp_info_t info)
 }
 
 /**
- * Process a piano.
+ * Process a piano. Striking a key releases the voice already playing it.
  *   @piano: The piano.
  *   @buf: The buffer.
  *   @time: The time.
@@ -261,17 +273,19 @@ void amp_piano_info(struct amp_piano_t *piano, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_piano_proc(struct amp_piano_t *piano, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_piano_proc(struct amp_piano_t *piano, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	bool on;
-	unsigned int i, n = 0;
+	int idx, stolen;
+	unsigned int i, k, end, cnt, n = 0;
+	const unsigned int *live;
 	struct amp_event_t *event;
 
-	dsp_zero_d(buf, len);
+	dsp_zero_s(buf, len);
 
 	on = piano->on;
 
-	for(i = 0; i < len; i++) {
+	for(i = 0; i < len; i = end) {
 		while((event = amp_queue_event(queue, &n, i)) != NULL) {
 			struct amp_piano_key_t *key;
 
@@ -279,15 +293,12 @@ bool amp_piano_proc(struct amp_piano_t *piano, double *buf, struct amp_time_t *t
 				continue;
 
 			if(event->key == piano->pedal) {
-				int sel;
-				unsigned int k;
-
 				on = (event->val > (UINT16_MAX / 2));
 
-				for(k = 0; k < piano->n; k++) {
-					sel = piano->state[k];
-					if(sel == -1)
-						piano->play[k].mul = on ? 1.0 : 0.9994f; // TODO
+				live = amp_voices_live(piano->voices, &cnt);
+				for(k = 0; k < cnt; k++) {
+					if(!piano->voices->voice[live[k]].held && !piano->voices->voice[live[k]].fade)
+						piano->play[live[k]].mul = on ? 1.0 : 0.9994f; // TODO
 				}
 			}
 
@@ -299,37 +310,39 @@ bool amp_piano_proc(struct amp_piano_t *piano, double *buf, struct amp_time_t *t
 				continue;
 
 			if(event->val > 0) {
-				int idx, sel;
 				unsigned int vel;
-				struct acw_buf_t buf;
 
 				vel = key->n;
 				vel = event->val / ((UINT16_MAX + vel) / vel);
 
-				if(key->idx >= 0) {
-					//piano->state[key->idx] = -2;
-					//piano->play[key->idx].mul = 0.9994f;
-				}
-				buf = amp_file_buf(key->vel[vel].rr[0]);
-				idx = amp_play_add(piano->play, piano->n, buf, 1.0f, piano->rate);
-				sel = piano->state[idx];
-				if(sel >= 0) {
-					piano->play[piano->key[sel].idx].mul = 0.9994f; // TODO
-					piano->key[sel].idx = -1;
-				}
+				idx = amp_voices_release(piano->voices, event->key);
+				if(idx >= 0)
+					piano->play[idx].mul = on ? 1.0 : 0.9994f; // TODO
 
-				key->idx = idx;
-				piano->state[idx] = event->key;
+				idx = amp_voices_alloc(piano->voices, event->key, &stolen);
+				if(stolen >= 0)
+					piano->play[stolen].mul = piano->fade;
 
-				printf("vel: %d %.1f\n", vel, amp_key_freq_f(event->key));
+				amp_play_start(&piano->play[idx], key->vel[vel].rr[0], 1.0f, piano->rate);
 			}
-			else if(key->idx >= 0) {
-				piano->state[key->idx] = -1;
-				piano->play[key->idx].mul = on ? 1.0 : 0.9994f; // TODO :decay constant
+			else {
+				idx = amp_voices_release(piano->voices, event->key);
+				if(idx >= 0)
+					piano->play[idx].mul = on ? 1.0 : 0.9994f; // TODO :decay constant
 			}
 		}
 
-		buf[i] = amp_play_proc(piano->play, piano->n);
+		end = amp_queue_split(queue, n, len);
+
+		live = amp_voices_live(piano->voices, &cnt);
+		for(k = cnt; k-- > 0; ) {
+			idx = live[k];
+
+			if(amp_play_run(&piano->play[idx], buf + i, end - i))
+				amp_voices_level(piano->voices, idx, piano->play[idx].vol);
+			else
+				amp_voices_free(piano->voices, idx);
+		}
 	}
 
 	piano->on  = on;
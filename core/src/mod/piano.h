@@ -4,7 +4,7 @@
 /*
  * piano declarations
  */
-struct amp_piano_t *amp_piano_new(uint16_t dev, unsigned int simul, float rate);
+struct amp_piano_t *amp_piano_new(uint16_t dev, unsigned int simul, float rate, struct amp_io_t *io, enum amp_steal_e steal);
 struct amp_piano_t *amp_piano_copy(struct amp_piano_t *piano);
 void amp_piano_delete(struct amp_piano_t *piano);
 
@@ -15,6 +15,6 @@ struct amp_piano_vel_t *amp_piano_vel(struct amp_piano_key_t *key);
 void amp_piano_rr(struct amp_piano_vel_t *vel, struct amp_file_t *file);
 
 void amp_piano_info(struct amp_piano_t *piano, struct amp_info_t info);
-bool amp_piano_proc(struct amp_piano_t *piano, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_piano_proc(struct amp_piano_t *piano, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 #endif
@@ -129,7 +129,7 @@ void amp_ramp_info(struct amp_ramp_t *ramp, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_ramp_proc(struct amp_ramp_t *ramp, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_ramp_proc(struct amp_ramp_t *ramp, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	unsigned int i;
 	bool cont = false;
@@ -149,7 +149,7 @@ bool amp_ramp_proc(struct amp_ramp_t *ramp, double *buf, struct amp_time_t *time
 					buf[i] = v = dsp_osc_inc(v, inc);
 			}
 			else {
-				double freq[len];
+				dsp_sample_t freq[len];
 
 				cont |= amp_param_proc(ramp->freq, freq, time, len, queue);
 
@@ -170,7 +170,7 @@ bool amp_ramp_proc(struct amp_ramp_t *ramp, double *buf, struct amp_time_t *time
 					buf[i] = fmod(time[i].beat / freq, 1.0);
 			}
 			else {
-				double freq[len];
+				dsp_sample_t freq[len];
 
 				cont |= amp_param_proc(ramp->freq, freq, time, len, queue);
 
@@ -4,30 +4,35 @@
 /**
  * Play structure.
  *   @buf: The buffer.
- *   @vol: The volume.
+ *   @vol, mul: The volume and decay multiplier.
  *   @idx: The index.
  */
 struct play_t {
-	struct dsp_buf_t *buf;
-	double vol;
-	int idx;
+	const struct dsp_buf_t *buf;
+	double vol, mul;
+	unsigned int idx;
 };
 
 /**
  * Sample structure.
- *   @decay: The decay rate.
+ *   @decay, fade: The decay rate and fade multiplier.
+ *   @rate: The sample rate.
  *   @len: The velocity array length.
  *   @vel: The velocity array.
- *   @i, n: The current index and number of players.
- *   @play: The player array.
+ *   @last, n: The last started voice and number of simultaneous voices.
+ *   @voices: The voice manager.
+ *   @play: The player array, one per voice slot.
  */
 struct amp_sample_t {
-	double decay;
+	double decay, fade;
+	unsigned int rate;
 
 	unsigned int len;
 	struct amp_sample_vel_t *vel;
 
-	unsigned int i, n;
+	int last;
+	unsigned int n;
+	struct amp_voices_t *voices;
 	struct play_t play[];
 };
 
@@ -43,12 +48,10 @@ struct amp_sample_vel_t {
 
 /**
  * Sample instance structure.
- *   @file: The file.
- *   @buf: The buffer.
+ *   @file: The decoded file.
  */
 struct amp_sample_inst_t {
 	struct amp_file_t *file;
-	struct dsp_buf_t *buf;
 };
 
 
@@ -67,22 +70,26 @@ const struct amp_module_i amp_sample_iface = {
  * Create a sample.
  *   @n: The number of simultaneous samples.
  *   @decay: The decay rate.
+ *   @rate: The sample rate.
+ *   @steal: The voice stealing policy.
  *   &returns: The sample.
  */
-struct amp_sample_t *amp_sample_new(unsigned int n, double decay)
+struct amp_sample_t *amp_sample_new(unsigned int n, double decay, unsigned int rate, enum amp_steal_e steal)
 {
-	unsigned int i;
 	struct amp_sample_t *sample;
+	struct amp_voices_t *voices;
 
-	sample = malloc(sizeof(struct amp_sample_t) + n * sizeof(struct play_t));
+	voices = amp_voices_new(n, steal);
+
+	sample = malloc(sizeof(struct amp_sample_t) + voices->total * sizeof(struct play_t));
 	sample->len = 0;
 	sample->vel = malloc(0);
-	sample->i = 0;
+	sample->last = -1;
 	sample->n = n;
+	sample->voices = voices;
 	sample->decay = decay;
-
-	for(i = 0; i < n; i++)
-		sample->play[i].idx = INT_MAX;
+	sample->fade = amp_voice_fade(rate);
+	sample->rate = rate;
 
 	return sample;
 }
@@ -97,7 +104,7 @@ struct amp_sample_t *amp_sample_copy(struct amp_sample_t *sample)
 	struct amp_sample_t *copy;
 	unsigned int i, j;
 	
-	copy = amp_sample_new(sample->n, sample->decay);
+	copy = amp_sample_new(sample->n, sample->decay, sample->rate, sample->voices->steal);
 
 	for(i = 0; i < sample->len; i++) {
 		struct amp_sample_vel_t *vel = amp_sample_vel(copy);
@@ -127,6 +134,7 @@ void amp_sample_delete(struct amp_sample_t *sample)
 	}
 
 	free(sample->vel);
+	amp_voices_delete(sample->voices);
 	free(sample);
 }
 
@@ -157,7 +165,10 @@ char *amp_sample_make(struct ml_value_t **ret, struct ml_value_t *value, struct
 	if((ml_list_getv(list, 0)->type != ml_value_num_v) || !ml_value_isnum(ml_list_getv(list, 1)) || (ml_list_getv(list, 2)->type != ml_value_list_v))
 		error();
 
-	sample = amp_sample_new(ml_list_getv(list, 0)->data.num, ml_value_getflt(ml_list_getv(list, 1)));
+	if(ml_list_getv(list, 0)->data.num < 1)
+		fail("%C: Sample requires at least one voice.", ml_tag_chunk(&value->tag));
+
+	sample = amp_sample_new(ml_list_getv(list, 0)->data.num, ml_value_getflt(ml_list_getv(list, 1)), amp_core_rate(env), amp_core_steal(env, amp_steal_oldest_v));
 
 	for(link = ml_list_getv(list, 2)->data.list->head; link != NULL; link = link->next) {
 		struct amp_file_t *file;
@@ -172,10 +183,7 @@ char *amp_sample_make(struct ml_value_t **ret, struct ml_value_t *value, struct
 			if(inst->value->type != ml_value_str_v)
 				error();
 
-			file = amp_cache_open(cache, inst->value->data.str, 0, amp_core_rate(env));
-			if(file == NULL)
-				fail("Cannot open '%s'.", inst->value->data.str);
-
+			file = amp_cache_decode(cache, inst->value->data.str, amp_core_rate(env));
 			amp_sample_inst(vel, file);
 		}
 	}
@@ -197,7 +205,8 @@ void amp_sample_info(struct amp_sample_t *sample, struct amp_info_t info)
 }
 
 /**
- * Process a sample.
+ * Process a sample. Starting a voice begins the decay of the voice started
+ * before it.
  *   @sample: The sample.
  *   @buf: The buffer.
  *   @time: The time.
@@ -205,50 +214,85 @@ void amp_sample_info(struct amp_sample_t *sample, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_sample_proc(struct amp_sample_t *sample, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_sample_proc(struct amp_sample_t *sample, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
-	bool cont = false;
-	unsigned int i, j, n = 0;
+	int idx, stolen;
+	unsigned int i, j, k, end, cnt, n = 0;
+	const unsigned int *live;
 	struct amp_event_t *event;
 
-	for(i = 0; i < len; i++) {
+	for(i = 0; i < len; i = end) {
 		while((event = amp_queue_event(queue, &n, i)) != NULL) {
 			unsigned int n;
 			struct amp_sample_vel_t *vel;
 
-			if(event->val == 0)
+			if(event->val == 0) {
+				amp_voices_release(sample->voices, event->key);
 				continue;
+			}
 
 			n = ((float)event->val / (float)UINT16_MAX) * sample->len;
 			vel = &sample->vel[(n >= sample->len) ? (sample->len - 1) : n];
 
-			sample->play[sample->i].buf = vel->inst[vel->rr].buf;
-			sample->play[sample->i].vol = 1.0;
-			sample->play[sample->i].idx = 0;
-			sample->play[(sample->i + sample->n - 1) % sample->n].vol *= sample->decay;
+			if((sample->last >= 0) && (sample->play[sample->last].mul == 1.0)) {
+				sample->play[sample->last].vol *= sample->decay;
+				sample->play[sample->last].mul = sample->decay;
+			}
 
-			sample->i = (sample->i + 1) % sample->n;
-			vel->rr = (vel->rr + 1) % vel->len;
-		}
+			idx = amp_voices_alloc(sample->voices, event->key, &stolen);
+			if(stolen >= 0)
+				sample->play[stolen].mul = sample->fade;
 
-		buf[i] = 0.0;
+			sample->play[idx].buf = amp_file_dsp(vel->inst[vel->rr].file, 0);
+			sample->play[idx].vol = 1.0;
+			sample->play[idx].mul = 1.0;
+			sample->play[idx].idx = 0;
+			sample->last = idx;
 
-		for(j = 0; j < sample->n; j++) {
-			struct play_t *play = &sample->play[j];
-
-			if((play->idx == INT_MAX) || (play->idx >= play->buf->len))
-				continue;
-
-			cont = true;
-			buf[i] += play->vol * play->buf->arr[play->idx];
-			play->idx++;
+			vel->rr = (vel->rr + 1) % vel->len;
+		}
 
-			if(play->vol < 1.0)
-				play->vol *= sample->decay;
+		end = amp_queue_split(queue, n, len);
+		dsp_zero_s(buf + i, end - i);
+
+		live = amp_voices_live(sample->voices, &cnt);
+		for(j = cnt; j-- > 0; ) {
+			unsigned int run;
+			double vol, mul;
+			const float *arr;
+			struct play_t *play = &sample->play[live[j]];
+
+			run = m_min_u(end - i, play->buf->len - play->idx);
+			arr = play->buf->arr + play->idx;
+			vol = play->vol;
+			mul = play->mul;
+
+			if(mul != 1.0) {
+				for(k = 0; k < run; k++) {
+					buf[i+k] += vol * arr[k];
+					vol *= mul;
+				}
+			}
+			else {
+				for(k = 0; k < run; k++)
+					buf[i+k] += vol * arr[k];
+			}
+
+			play->vol = vol;
+			play->idx += run;
+
+			if((play->idx >= play->buf->len) || (vol < 0.001)) {
+				if(sample->last == (int)live[j])
+					sample->last = -1;
+
+				amp_voices_free(sample->voices, live[j]);
+			}
+			else
+				amp_voices_level(sample->voices, live[j], vol);
 		}
 	}
 
-	return cont;
+	return sample->voices->nlive > 0;
 }
 
 
@@ -273,15 +317,10 @@ struct amp_sample_vel_t *amp_sample_vel(struct amp_sample_t *sample)
 /**
  * Add an instance to the velocity.
  *   @vel: The velocity.
- *   @file: The file.
+ *   @file: Consumed. The decoded file.
  */
 void amp_sample_inst(struct amp_sample_vel_t *vel, struct amp_file_t *file)
 {
-	struct amp_sample_inst_t *inst;
-
 	vel->inst = realloc(vel->inst, (vel->len + 1) * sizeof(struct amp_sample_inst_t));
-	inst = &vel->inst[vel->len++];
-	inst->file = file;
-	fatal("stub");
-	//inst->buf = amp_file_buf(file);
+	vel->inst[vel->len++].file = file;
 }
@@ -113,7 +113,7 @@ void amp_shot_info(struct amp_shot_t *shot, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_shot_proc(struct amp_shot_t *shot, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_shot_proc(struct amp_shot_t *shot, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	return amp_module_proc(shot->module, buf, time, len, queue);
 }
@@ -4,11 +4,13 @@
 /**
  * Instance structure.
  *   @delay: The delay.
+ *   @gain: The fade out gain.
  *   @note: The note.
  *   @module: The module.
  */
 struct inst_t {
 	int delay;
+	double gain;
 	struct amp_note_t note;
 	struct amp_module_t module;
 };
@@ -16,13 +18,17 @@ struct inst_t {
 /**
  * Synthesizer structure.
  *   @dev: Listening device.
- *   @n: The width.
- *   @inst: The instance array.
+ *   @n, rate: The width and sample rate.
+ *   @fade: The fade multiplier.
+ *   @voices: The voice manager.
+ *   @inst: The instance array, one per voice slot.
  */
 struct amp_synth_t {
 	uint16_t dev;
-	unsigned int n;
+	unsigned int n, rate;
+	double fade;
 
+	struct amp_voices_t *voices;
 	struct inst_t *inst;
 };
 
@@ -41,11 +47,13 @@ struct amp_module_i amp_synth_iface = {
 /**
  * Create a synthesizer.
  *   @dev: The device.
- *   @n: The number of instances.
+ *   @n: The number of simultaneous instances.
  *   @module: Consumed. The module.
+ *   @rate: The sample rate.
+ *   @steal: The voice stealing policy.
  *   &returns: The synthesizer.
  */
-struct amp_synth_t *amp_synth_new(uint16_t dev, unsigned int n, struct amp_module_t module)
+struct amp_synth_t *amp_synth_new(uint16_t dev, unsigned int n, struct amp_module_t module, unsigned int rate, enum amp_steal_e steal)
 {
 	unsigned int i;
 	struct amp_synth_t *synth;
@@ -55,11 +63,14 @@ struct amp_synth_t *amp_synth_new(uint16_t dev, unsigned int n, struct amp_modul
 	synth = malloc(sizeof(struct amp_synth_t));
 	synth->dev = dev;
 	synth->n = n;
-	synth->inst = malloc(n * sizeof(struct inst_t));
-	synth->inst[0] = (struct inst_t){ -1, { 0.0, 0.0 }, module };
+	synth->rate = rate;
+	synth->fade = amp_voice_fade(rate);
+	synth->voices = amp_voices_new(n, steal);
+	synth->inst = malloc(synth->voices->total * sizeof(struct inst_t));
+	synth->inst[0] = (struct inst_t){ -1, 1.0, { 0.0, 0.0 }, module };
 
-	for(i = 1; i < synth->n; i++)
-		synth->inst[i] = (struct inst_t){ -1, { 0, 0.0, 0.0 }, amp_module_copy(module) };
+	for(i = 1; i < synth->voices->total; i++)
+		synth->inst[i] = (struct inst_t){ -1, 1.0, { 0, 0.0, 0.0 }, amp_module_copy(module) };
 
 	return synth;
 }
@@ -71,7 +82,7 @@ struct amp_synth_t *amp_synth_new(uint16_t dev, unsigned int n, struct amp_modul
  */
 struct amp_synth_t *amp_synth_copy(struct amp_synth_t *synth)
 {
-	return amp_synth_new(synth->dev, synth->n, amp_module_copy(synth->inst[0].module));
+	return amp_synth_new(synth->dev, synth->n, amp_module_copy(synth->inst[0].module), synth->rate, synth->voices->steal);
 }
 
 /**
@@ -82,9 +93,10 @@ void amp_synth_delete(struct amp_synth_t *synth)
 {
 	unsigned int i;
 
-	for(i = 0; i < synth->n; i++)
+	for(i = 0; i < synth->voices->total; i++)
 		amp_module_delete(synth->inst[i].module);
 
+	amp_voices_delete(synth->voices);
 	free(synth->inst);
 	free(synth);
 }
@@ -104,7 +116,10 @@ char *amp_synth_make(struct ml_value_t **ret, struct ml_value_t *value, struct m
 	struct amp_module_t module;
 
 	chkfail(amp_match_unpack(value, "(d,d,M)", &dev, &n, &module));
-	*ret = amp_pack_module((struct amp_module_t){ amp_synth_new(dev, n, module), &amp_synth_iface });
+	if(n < 1)
+		return amp_module_delete(module), mprintf("%C: Synth requires at least one instance.", ml_tag_chunk(&value->tag));
+
+	*ret = amp_pack_module((struct amp_module_t){ amp_synth_new(dev, n, module, amp_core_rate(env), amp_core_steal(env, amp_steal_oldest_v)), &amp_synth_iface });
 
 	return NULL;
 #undef onexit
@@ -120,12 +135,13 @@ void amp_synth_info(struct amp_synth_t *synth, struct amp_info_t info)
 {
 	unsigned int i;
 
-	for(i = 0; i < synth->n; i++)
+	for(i = 0; i < synth->voices->total; i++)
 		amp_module_info(synth->inst[i].module, info);
 }
 
 /**
- * Process a synthesizer.
+ * Process a synthesizer. Notes on a key already playing are passed to its
+ * instance, and stolen instances are faded out.
  *   @synth: The synthesizer.
  *   @buf: The buffer.
  *   @time: The time.
@@ -133,14 +149,14 @@ void amp_synth_info(struct amp_synth_t *synth, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The contuation flag.
  */
-bool amp_synth_proc(struct amp_synth_t *synth, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_synth_proc(struct amp_synth_t *synth, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	unsigned int n = 0;
 	struct amp_action_t *action;
 
 	while((action = amp_queue_action(queue, &n, len)) != NULL) {
 		bool init;
-		unsigned int i;
+		int i, stolen;
 
 		if(action->event.dev != synth->dev)
 			continue;
@@ -148,27 +164,20 @@ bool amp_synth_proc(struct amp_synth_t *synth, double *buf, struct amp_time_t *t
 		if(action->event.key >= 128)
 			continue;
 
-		for(i = 0; i < synth->n; i++) {
-			if(synth->inst[i].note.key == action->event.key)
-				break;
-		}
+		i = amp_voices_key(synth->voices, action->event.key);
+		if(i < 0) {
+			if(action->event.val == 0)
+				continue;
 
-		if(i == synth->n) {
 			init = true;
-
-			for(i = 0; i < synth->n; i++) {
-				if(synth->inst[i].delay < 0)
-					break;
-			}
-
-			if(i == synth->n)
-				continue;
+			i = amp_voices_alloc(synth->voices, action->event.key, &stolen);
+			synth->inst[i].gain = 1.0;
 		}
-		else
+		else {
 			init = false;
-
-		if(i == synth->n)
-			continue;
+			if(action->event.val == 0)
+				amp_voices_release(synth->voices, action->event.key);
+		}
 
 		synth->inst[i].delay = init ? action->delay : 0;
 		synth->inst[i].note.delay = init ? 0 : action->delay;
@@ -182,27 +191,50 @@ bool amp_synth_proc(struct amp_synth_t *synth, double *buf, struct amp_time_t *t
 
 	int delay;
 	bool cont;
-	unsigned int i;
-	double tmp[len];
+	double level;
+	unsigned int i, k, idx, cnt;
+	const unsigned int *live;
+	struct inst_t *inst;
+	dsp_sample_t tmp[len];
 
-	dsp_zero_d(buf, len);
+	dsp_zero_s(buf, len);
 
-	for(i = 0; i < synth->n; i++) {
-		if(synth->inst[i].delay < 0)
-			continue;
+	live = amp_voices_live(synth->voices, &cnt);
+	for(i = cnt; i-- > 0; ) {
+		idx = live[i];
+		inst = &synth->inst[idx];
 
 		struct amp_queue_t queue;
 		amp_queue_init(&queue);
 
-		delay = synth->inst[i].delay;
+		delay = inst->delay;
 		if(delay < len) {
-			cont = amp_module_proc(synth->inst[i].module, tmp, time + delay, len - delay, &queue);
-			synth->inst[i].delay = cont ? 0 : -1;
+			cont = amp_module_proc(inst->module, tmp, time + delay, len - delay, &queue);
+			inst->delay = 0;
+
+			if(synth->voices->voice[idx].fade) {
+				for(k = 0; k < len - delay; k++) {
+					tmp[k] *= inst->gain;
+					inst->gain *= synth->fade;
+				}
 
-			dsp_add_d(buf + delay, tmp, len - delay);
+				cont = cont && (inst->gain >= 0.001);
+			}
+
+			dsp_add_s(buf + delay, tmp, len - delay);
+
+			if(!cont)
+				amp_voices_free(synth->voices, idx);
+			else if(synth->voices->steal == amp_steal_quiet_v) {
+				level = 0.0;
+				for(k = 0; k < len - delay; k++)
+					level = fmax(level, fabs(tmp[k]));
+
+				amp_voices_level(synth->voices, idx, level);
+			}
 		}
 		else
-			synth->inst[i].delay -= len;
+			inst->delay -= len;
 	}
 
 	return false;
@@ -15,6 +15,6 @@ void amp_trig_delete(struct amp_trig_t *trig);
 char *amp_trig_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 
 void amp_trig_info(struct amp_trig_t *trig, struct amp_info_t info);
-bool amp_trig_proc(struct amp_trig_t *trig, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_trig_proc(struct amp_trig_t *trig, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 #endif
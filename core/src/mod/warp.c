@@ -103,7 +103,7 @@ void amp_warp_info(struct amp_warp_t *warp, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_warp_proc(struct amp_warp_t *warp, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_warp_proc(struct amp_warp_t *warp, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	bool cont;
 	unsigned int i;
@@ -117,7 +117,7 @@ bool amp_warp_proc(struct amp_warp_t *warp, double *buf, struct amp_time_t *time
 			buf[i] = dsp_osc_warp(fmod(buf[i] + 0.25, 1.0), dist) - 0.25;
 	}
 	else {
-		double dist[len];
+		dsp_sample_t dist[len];
 
 		cont |= amp_param_proc(warp->dist, dist, time, len, queue);
 
@@ -15,7 +15,7 @@ void amp_warp_delete(struct amp_warp_t *warp);
 char *amp_warp_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 
 void amp_warp_info(struct amp_warp_t *warp, struct amp_info_t info);
-bool amp_warp_proc(struct amp_warp_t *warp, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_warp_proc(struct amp_warp_t *warp, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 struct amp_warp_vel_t *amp_warp_vel(struct amp_warp_t *warp);
 void amp_warp_inst(struct amp_warp_vel_t *vel, struct amp_file_t *file);
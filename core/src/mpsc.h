@@ -0,0 +1,120 @@
+#ifndef MPSC_H
+#define MPSC_H
+
+/**
+ * Multiple producer, single consumer ring structure. The ring only tracks
+ * sequence numbers; the owner keeps the cells in an array of the same
+ * length, indexed by the position masked to the length. Any number of
+ * threads may write without locking, and a single thread reads.
+ *   @len: The ring length, a power of two.
+ *   @wr, rd, lost: The write index, read index, and lost write count.
+ *   @seq: The sequence number of each cell.
+ */
+struct amp_mpsc_t {
+	unsigned int len;
+	uint64_t wr, rd, lost;
+	uint64_t *seq;
+};
+
+
+/**
+ * Initialize a ring.
+ *   @len: The length, a power of two.
+ *   &returns: The ring.
+ */
+static inline struct amp_mpsc_t amp_mpsc_init(unsigned int len)
+{
+	unsigned int i;
+	struct amp_mpsc_t ring;
+
+	ring.len = len;
+	ring.wr = ring.rd = ring.lost = 0;
+	ring.seq = malloc(len * sizeof(uint64_t));
+
+	for(i = 0; i < len; i++)
+		ring.seq[i] = i;
+
+	return ring;
+}
+
+/**
+ * Destroy a ring.
+ *   @ring: The ring.
+ */
+static inline void amp_mpsc_destroy(struct amp_mpsc_t *ring)
+{
+	free(ring->seq);
+}
+
+/**
+ * Claim a cell for writing. The write is counted as lost if the ring is full.
+ * The cell must be published once written.
+ *   @ring: The ring.
+ *   @pos: Out. The claimed position.
+ *   &returns: True if claimed, false if the ring is full.
+ */
+static inline bool amp_mpsc_claim(struct amp_mpsc_t *ring, uint64_t *pos)
+{
+	uint64_t seq;
+
+	*pos = __atomic_load_n(&ring->wr, __ATOMIC_RELAXED);
+	while(true) {
+		seq = __atomic_load_n(&ring->seq[*pos & (ring->len - 1)], __ATOMIC_ACQUIRE);
+
+		if(seq == *pos) {
+			if(__atomic_compare_exchange_n(&ring->wr, pos, *pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				return true;
+		}
+		else if(seq < *pos) {
+			__atomic_fetch_add(&ring->lost, 1, __ATOMIC_RELAXED);
+			return false;
+		}
+		else
+			*pos = __atomic_load_n(&ring->wr, __ATOMIC_RELAXED);
+	}
+}
+
+/**
+ * Publish a written cell to the reader.
+ *   @ring: The ring.
+ *   @pos: The claimed position.
+ */
+static inline void amp_mpsc_publish(struct amp_mpsc_t *ring, uint64_t pos)
+{
+	__atomic_store_n(&ring->seq[pos & (ring->len - 1)], pos + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Check if the next cell is ready to read. Only the reader may call.
+ *   @ring: The ring.
+ *   @idx: Out. The cell index.
+ *   &returns: True if ready.
+ */
+static inline bool amp_mpsc_peek(struct amp_mpsc_t *ring, unsigned int *idx)
+{
+	*idx = ring->rd & (ring->len - 1);
+
+	return __atomic_load_n(&ring->seq[*idx], __ATOMIC_ACQUIRE) == (ring->rd + 1);
+}
+
+/**
+ * Release the cell last peeked back to the writers. Only the reader may call.
+ *   @ring: The ring.
+ */
+static inline void amp_mpsc_release(struct amp_mpsc_t *ring)
+{
+	__atomic_store_n(&ring->seq[ring->rd & (ring->len - 1)], ring->rd + ring->len, __ATOMIC_RELEASE);
+	ring->rd++;
+}
+
+/**
+ * Retrieve the number of writes lost to a full ring.
+ *   @ring: The ring.
+ *   &returns: The lost count.
+ */
+static inline uint64_t amp_mpsc_lost(struct amp_mpsc_t *ring)
+{
+	return __atomic_load_n(&ring->lost, __ATOMIC_RELAXED);
+}
+
+#endif
@@ -109,7 +109,7 @@ void amp_param_info(struct amp_param_t *param, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool amp_param_proc(struct amp_param_t *param, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_param_proc(struct amp_param_t *param, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	switch(param->type) {
 	case amp_param_flt_e:
@@ -124,14 +124,15 @@ bool amp_param_proc(struct amp_param_t *param, double *buf, struct amp_time_t *t
 
 	case amp_param_ctrl_e:
 		{
-			unsigned int i, n = 0;
+			unsigned int i, end, n = 0;
 			struct amp_event_t *event;
 
-			for(i = 0; i < len; i++) {
+			for(i = 0; i < len; i = end) {
 				while((event = amp_queue_event(queue, &n, i)) != NULL)
 					param->flt = amp_ctrl_proc(param->data.ctrl, *event);
 
-				buf[i] = param->flt;
+				for(end = amp_queue_split(queue, n, len); i < end; i++)
+					buf[i] = param->flt;
 			}
 
 			return false;
@@ -31,15 +31,20 @@ struct amp_perf_t amp_perf_init(void)
  */
 uint64_t amp_perf_worst(struct amp_perf_t *perf)
 {
-	unsigned int i;
-	uint64_t cur = sys_utime() - 1000000;
+	unsigned int i, orig;
+	uint64_t worst = 0, cur = sys_utime() - 1000000;
 
-	i = perf->idx & ~0x1;
+	orig = i = prev(perf->idx & ~0x1);
+	while(perf->arr[i] > cur) {
+		if((perf->arr[i] - perf->arr[prev(i)]) > worst)
+			worst = perf->arr[i] - perf->arr[prev(i)];
 
-	for(i = prev(perf->idx & ~0x1); perf->arr[i] > cur; i = prev(perf->idx)) {
+		i = prev(prev(i));
+		if(i == orig)
+			break;
 	}
 
-	return 0;
+	return worst;
 }
 
 /**
@@ -23,6 +23,7 @@ struct amp_perf_t {
  */
 struct amp_perf_t amp_perf_init(void);
 
+uint64_t amp_perf_worst(struct amp_perf_t *perf);
 double amp_perf_ave(struct amp_perf_t *perf);
 
 
@@ -152,19 +152,19 @@ bool amp_poly_proc(struct amp_poly_t *poly, struct amp_polyinfo_t *info)
 /*
  * process handlers.
  */
-bool amp_poly_proc_instr(struct amp_poly_t *poly, double **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_poly_proc_instr(struct amp_poly_t *poly, dsp_sample_t **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	struct amp_polyinfo_t info = { len, time, queue, { .instr = { buf } } };
 
 	return poly->iface->proc(poly->ref, poly, &info);
 }
-bool amp_poly_proc_effect(struct amp_poly_t *poly, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_poly_proc_effect(struct amp_poly_t *poly, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	struct amp_polyinfo_t info = { len, time, queue, { .effect = { buf } } };
 
 	return poly->iface->proc(poly->ref, poly, &info);
 }
-bool amp_poly_proc_module(struct amp_poly_t *poly, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_poly_proc_module(struct amp_poly_t *poly, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	struct amp_polyinfo_t info = { len, time, queue, { .module = { buf } } };
 
@@ -12,7 +12,7 @@ struct amp_poly_t;
  *   @buf: The buffer.
  */
 struct amp_polyinstr_t {
-	double **buf;
+	dsp_sample_t **buf;
 };
 
 /**
@@ -20,7 +20,7 @@ struct amp_polyinstr_t {
  *   @buf: The buffer.
  */
 struct amp_polyeffect_t {
-	double *buf;
+	dsp_sample_t *buf;
 };
 
 /**
@@ -28,7 +28,7 @@ struct amp_polyeffect_t {
  *   @buf: The buffer.
  */
 struct amp_polymodule_t {
-	double *buf;
+	dsp_sample_t *buf;
 };
 
 /*
@@ -91,8 +91,8 @@ struct ml_value_t *amp_poly_make(struct amp_box_t *box, void *ref, const struct
 
 void amp_poly_info(struct amp_poly_t *poly, struct amp_info_t info);
 bool amp_poly_proc(struct amp_poly_t *poly, struct amp_polyinfo_t *info);
-bool amp_poly_proc_instr(struct amp_poly_t *poly, double **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
-bool amp_poly_proc_effect(struct amp_poly_t *poly, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
-bool amp_poly_proc_module(struct amp_poly_t *poly, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_poly_proc_instr(struct amp_poly_t *poly, dsp_sample_t **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_poly_proc_effect(struct amp_poly_t *poly, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_poly_proc_module(struct amp_poly_t *poly, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 #endif
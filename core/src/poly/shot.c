@@ -156,21 +156,21 @@ static inline struct amp_queue_t amp_shot_filt(struct amp_shot_t *shot, struct a
 /*
  * process handlers.
  */
-bool amp_shot_proc_instr(struct amp_shot_t *shot, double **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_shot_proc_instr(struct amp_shot_t *shot, dsp_sample_t **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	struct amp_queue_t filt;
 
 	filt = amp_shot_filt(shot, queue);
 	return amp_instr_proc(shot->box->data.instr, buf, time, len, &filt);
 }
-bool amp_shot_proc_effect(struct amp_shot_t *shot, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_shot_proc_effect(struct amp_shot_t *shot, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	struct amp_queue_t filt;
 
 	filt = amp_shot_filt(shot, queue);
 	return amp_effect_proc(shot->box->data.effect, buf, time, len, &filt);
 }
-bool amp_shot_proc_module(struct amp_shot_t *shot, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool amp_shot_proc_module(struct amp_shot_t *shot, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	struct amp_queue_t filt;
 
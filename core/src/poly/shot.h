@@ -15,8 +15,8 @@ void amp_shot_delete(struct amp_shot_t *shot);
 char *amp_shot_make(struct ml_value_t **ret, struct ml_value_t *value, struct ml_env_t *env);
 
 void amp_shot_info(struct amp_shot_t *shot, struct amp_info_t info);
-bool amp_shot_proc_instr(struct amp_shot_t *shot, double **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
-bool amp_shot_proc_effect(struct amp_shot_t *shot, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
-bool amp_shot_proc_module(struct amp_shot_t *shot, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_shot_proc_instr(struct amp_shot_t *shot, dsp_sample_t **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_shot_proc_effect(struct amp_shot_t *shot, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool amp_shot_proc_module(struct amp_shot_t *shot, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 #endif
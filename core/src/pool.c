@@ -0,0 +1,342 @@
+#include "common.h"
+
+/*****************************************************************************
+ * The worker pool provides fork/join parallelism for the real time thread.
+ * Each call to 'amp_pool_exec' publishes a new generation with a set of jobs;
+ * the caller and any awake workers claim jobs from a shared ticket until none
+ * remain. A job only runs once its start tag is swapped from the generation to zero,
+ * so the caller then steals every job claimed by a worker that has not yet started
+ * it, and only waits for jobs that are running. Workers
+ * spin briefly after each generation before sleeping on a condition variable,
+ * and the caller only touches the lock when a worker is asleep. Nested calls,
+ * from within a job, execute serially on the calling thread.
+ ****************************************************************************/
+
+
+/**
+ * Number of spin iterations before a worker sleeps.
+ */
+#define POOL_SPIN 20000
+
+/**
+ * Number of jobs with start tags. Jobs past this index are not stolen.
+ */
+#define POOL_JOBS 256
+
+/**
+ * Pool structure.
+ *   @term: Terminate flag.
+ *   @nthreads: The number of threads.
+ *   @thread: The thread array.
+ *   @lock: The sleep lock.
+ *   @cond: The sleep condition variable.
+ *   @busy, gen, nsleep: The busy flag, generation, and sleeper count.
+ *   @ticket: The generation and next job packed into one word.
+ *   @func, arg: The job function and argument.
+ *   @njobs, done, slot: The number of jobs, finished jobs, and next slot.
+ *   @start: The start tag of each job, the generation until started.
+ */
+struct amp_pool_t {
+	bool term;
+	unsigned int nthreads;
+	sys_thread_t *thread;
+
+	sys_mutex_t lock;
+	sys_cond_t cond;
+
+	int busy;
+	unsigned int gen, nsleep;
+	uint64_t ticket;
+
+	amp_pool_f func;
+	void *arg;
+	unsigned int njobs, done, slot;
+	unsigned int start[POOL_JOBS];
+};
+
+
+/*
+ * local declarations
+ */
+static void *pool_thread(void *arg);
+static bool pool_claim(struct amp_pool_t *pool, unsigned int gen, unsigned int *idx);
+static bool pool_start(struct amp_pool_t *pool, unsigned int gen, unsigned int idx);
+static void pool_relax(void);
+
+
+/**
+ * Create a worker pool.
+ *   @nthreads: The number of worker threads, not including the caller.
+ *   &returns: The pool.
+ */
+struct amp_pool_t *amp_pool_new(unsigned int nthreads)
+{
+	unsigned int i;
+	struct amp_pool_t *pool;
+
+	pool = malloc(sizeof(struct amp_pool_t));
+	pool->term = false;
+	pool->nthreads = nthreads;
+	pool->thread = malloc(nthreads * sizeof(sys_thread_t));
+	pool->lock = sys_mutex_init(0);
+	pool->cond = sys_cond_init(0);
+	pool->busy = 0;
+	pool->gen = 0;
+	pool->nsleep = 0;
+	pool->ticket = 0;
+	pool->func = NULL;
+	pool->arg = NULL;
+	pool->njobs = pool->done = pool->slot = 0;
+
+	for(i = 0; i < POOL_JOBS; i++)
+		pool->start[i] = 0;
+
+	for(i = 0; i < nthreads; i++)
+		pool->thread[i] = sys_thread_create(0, pool_thread, pool);
+
+	return pool;
+}
+
+/**
+ * Delete a worker pool.
+ *   @pool: The pool.
+ */
+void amp_pool_delete(struct amp_pool_t *pool)
+{
+	unsigned int i;
+
+	sys_mutex_lock(&pool->lock);
+	__atomic_store_n(&pool->term, true, __ATOMIC_SEQ_CST);
+	sys_cond_broadcast(&pool->cond);
+	sys_mutex_unlock(&pool->lock);
+
+	for(i = 0; i < pool->nthreads; i++)
+		sys_thread_join(&pool->thread[i]);
+
+	sys_mutex_destroy(&pool->lock);
+	sys_cond_destroy(&pool->cond);
+	free(pool->thread);
+	free(pool);
+}
+
+
+/**
+ * Retrieve the number of online processors.
+ *   &returns: The number of processors, at least one.
+ */
+unsigned int amp_pool_ncpu(void)
+{
+#ifdef WINDOWS
+	return 1;
+#else
+	long n;
+
+	n = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return (n > 1) ? n : 1;
+#endif
+}
+
+/**
+ * Retrieve the number of worker threads.
+ *   @pool: Optional. The pool.
+ *   &returns: The number of threads, not including the caller.
+ */
+unsigned int amp_pool_nthreads(struct amp_pool_t *pool)
+{
+	return (pool != NULL) ? pool->nthreads : 0;
+}
+
+/**
+ * Retrieve a worker thread, for example to adjust its scheduling.
+ *   @pool: The pool.
+ *   @idx: The thread index.
+ *   &returns: The thread.
+ */
+sys_thread_t *amp_pool_thread(struct amp_pool_t *pool, unsigned int idx)
+{
+	return &pool->thread[idx];
+}
+
+/**
+ * Retrieve the number of slots used by the pool for a set of jobs. A worker
+ * only takes a slot once it starts a job, so at most one slot per job is
+ * used in addition to the caller's.
+ *   @pool: Optional. The pool.
+ *   @njobs: The number of jobs.
+ *   &returns: The number of slots.
+ */
+unsigned int amp_pool_nslots(struct amp_pool_t *pool, unsigned int njobs)
+{
+	if((pool == NULL) || (pool->nthreads == 0) || (njobs < 2))
+		return 1;
+
+	return m_min_u(pool->nthreads, njobs) + 1;
+}
+
+/**
+ * Execute a set of jobs on the pool, returning once all have completed. The
+ * calling thread always executes jobs using slot zero.
+ *   @pool: Optional. The pool.
+ *   @func: The job function.
+ *   @arg: The argument.
+ *   @njobs: The number of jobs.
+ */
+void amp_pool_exec(struct amp_pool_t *pool, amp_pool_f func, void *arg, unsigned int njobs)
+{
+	int busy = 0;
+	unsigned int i, gen;
+
+	if((pool == NULL) || (pool->nthreads == 0) || (njobs < 2) || !__atomic_compare_exchange_n(&pool->busy, &busy, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+		for(i = 0; i < njobs; i++)
+			func(arg, i, 0);
+
+		return;
+	}
+
+	gen = (pool->gen + 1) ?: 1;
+	pool->func = func;
+	pool->arg = arg;
+	pool->njobs = njobs;
+	__atomic_store_n(&pool->done, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&pool->slot, 1, __ATOMIC_RELAXED);
+
+	for(i = 0; i < m_min_u(njobs, POOL_JOBS); i++)
+		__atomic_store_n(&pool->start[i], gen, __ATOMIC_RELAXED);
+
+	__atomic_store_n(&pool->ticket, (uint64_t)gen << 32, __ATOMIC_RELEASE);
+	__atomic_store_n(&pool->gen, gen, __ATOMIC_SEQ_CST);
+
+	if(__atomic_load_n(&pool->nsleep, __ATOMIC_SEQ_CST) > 0) {
+		sys_mutex_lock(&pool->lock);
+		sys_cond_broadcast(&pool->cond);
+		sys_mutex_unlock(&pool->lock);
+	}
+
+	while(pool_claim(pool, gen, &i)) {
+		if(!pool_start(pool, gen, i))
+			continue;
+
+		func(arg, i, 0);
+		__atomic_add_fetch(&pool->done, 1, __ATOMIC_RELEASE);
+	}
+
+	for(i = 0; i < m_min_u(njobs, POOL_JOBS); i++) {
+		if(!pool_start(pool, gen, i))
+			continue;
+
+		func(arg, i, 0);
+		__atomic_add_fetch(&pool->done, 1, __ATOMIC_RELEASE);
+	}
+
+	while(__atomic_load_n(&pool->done, __ATOMIC_ACQUIRE) < njobs)
+		pool_relax();
+
+	__atomic_store_n(&pool->busy, 0, __ATOMIC_RELEASE);
+}
+
+
+/**
+ * Worker thread.
+ *   @arg: The pool.
+ *   &returns: Always null.
+ */
+static void *pool_thread(void *arg)
+{
+	struct amp_pool_t *pool = arg;
+	unsigned int i, idx, slot, gen, seen = 0;
+
+	while(true) {
+		for(i = 0; i < POOL_SPIN; i++) {
+			if(__atomic_load_n(&pool->gen, __ATOMIC_ACQUIRE) != seen)
+				break;
+
+			pool_relax();
+		}
+
+		if(__atomic_load_n(&pool->gen, __ATOMIC_ACQUIRE) == seen) {
+			sys_mutex_lock(&pool->lock);
+			__atomic_add_fetch(&pool->nsleep, 1, __ATOMIC_SEQ_CST);
+
+			while((__atomic_load_n(&pool->gen, __ATOMIC_SEQ_CST) == seen) && !__atomic_load_n(&pool->term, __ATOMIC_SEQ_CST))
+				sys_cond_wait(&pool->cond, &pool->lock);
+
+			__atomic_sub_fetch(&pool->nsleep, 1, __ATOMIC_SEQ_CST);
+			sys_mutex_unlock(&pool->lock);
+		}
+
+		if(__atomic_load_n(&pool->term, __ATOMIC_SEQ_CST))
+			break;
+
+		seen = gen = __atomic_load_n(&pool->gen, __ATOMIC_ACQUIRE);
+		slot = UINT_MAX;
+
+		while(pool_claim(pool, gen, &idx)) {
+			if(!pool_start(pool, gen, idx))
+				continue;
+
+			if(slot == UINT_MAX)
+				slot = __atomic_fetch_add(&pool->slot, 1, __ATOMIC_RELAXED);
+
+			pool->func(pool->arg, idx, slot);
+			__atomic_add_fetch(&pool->done, 1, __ATOMIC_RELEASE);
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Claim a job from the current generation.
+ *   @pool: The pool.
+ *   @gen: The generation.
+ *   @idx: Ref. The claimed job index.
+ *   &returns: True if a job was claimed.
+ */
+static bool pool_claim(struct amp_pool_t *pool, unsigned int gen, unsigned int *idx)
+{
+	uint64_t ticket;
+
+	ticket = __atomic_load_n(&pool->ticket, __ATOMIC_ACQUIRE);
+
+	do {
+		if((ticket >> 32) != gen)
+			return false;
+
+		if((uint32_t)ticket >= pool->njobs)
+			return false;
+	} while(!__atomic_compare_exchange_n(&pool->ticket, &ticket, ticket + 1, true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+	*idx = (uint32_t)ticket;
+
+	return true;
+}
+
+/**
+ * Start a claimed job by clearing its start tag. Exactly one thread starts
+ * each job, and a worker delayed from an earlier generation never starts a
+ * job of the current one.
+ *   @pool: The pool.
+ *   @gen: The generation, never zero.
+ *   @idx: The job index.
+ *   &returns: True if the job was started by the calling thread.
+ */
+static bool pool_start(struct amp_pool_t *pool, unsigned int gen, unsigned int idx)
+{
+	if(idx >= POOL_JOBS)
+		return true;
+
+	return __atomic_compare_exchange_n(&pool->start[idx], &gen, 0, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+}
+
+/**
+ * Relax the processor inside of a spin loop.
+ */
+static void pool_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#else
+	__asm__ volatile("" ::: "memory");
+#endif
+}
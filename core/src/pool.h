@@ -0,0 +1,28 @@
+#ifndef POOL_H
+#define POOL_H
+
+/**
+ * Pool job function.
+ *   @arg: The argument.
+ *   @idx: The job index.
+ *   @slot: The slot of the executing thread, unique within a single call to
+ *     'amp_pool_exec' and less than 'amp_pool_nslots' for the same number of
+ *     jobs.
+ */
+typedef void (*amp_pool_f)(void *arg, unsigned int idx, unsigned int slot);
+
+/*
+ * pool declarations
+ */
+struct amp_pool_t;
+
+struct amp_pool_t *amp_pool_new(unsigned int nthreads);
+void amp_pool_delete(struct amp_pool_t *pool);
+
+unsigned int amp_pool_ncpu(void);
+unsigned int amp_pool_nthreads(struct amp_pool_t *pool);
+sys_thread_t *amp_pool_thread(struct amp_pool_t *pool, unsigned int idx);
+unsigned int amp_pool_nslots(struct amp_pool_t *pool, unsigned int njobs);
+void amp_pool_exec(struct amp_pool_t *pool, amp_pool_f func, void *arg, unsigned int njobs);
+
+#endif
@@ -0,0 +1,491 @@
+#define _GNU_SOURCE
+#include "common.h"
+
+#ifndef WINDOWS
+#	include <dlfcn.h>
+#endif
+
+
+/**
+ * Key structure, identifying a node.
+ *   @ref, iface: The node reference and interface.
+ */
+struct prof_key_t {
+	const void *ref, *iface;
+};
+
+/**
+ * Sample structure.
+ *   @key: The node key.
+ *   @len: The block length.
+ *   @self, total: The exclusive and inclusive times in ticks.
+ */
+struct prof_sample_t {
+	struct prof_key_t key;
+	unsigned int len;
+	uint64_t self, total;
+};
+
+/**
+ * Node structure.
+ *   @key: The key.
+ *   @name: The name.
+ *   @idx, cnt, len: The window index, sample count, and last block length.
+ *   @seen: The time of the last sample.
+ *   @self, total: The exclusive and inclusive time windows.
+ */
+struct prof_node_t {
+	struct prof_key_t key;
+
+	char name[32];
+	unsigned int idx, cnt, len;
+	int64_t seen;
+
+	float self[AMP_PROF_HIST], total[AMP_PROF_HIST];
+};
+
+/**
+ * Profiler structure.
+ *   @enable: The enabled flag.
+ *   @scale: The number of microseconds per tick.
+ *   @ring: The sample ring.
+ *   @cell: The ring cells, allocated when first enabled.
+ *   @lock: The lock, held while reading.
+ *   @tree: The node tree.
+ */
+struct amp_prof_t {
+	bool enable;
+	double scale;
+
+	struct amp_mpsc_t ring;
+	struct prof_sample_t *cell;
+
+	sys_mutex_t lock;
+	struct avltree_t tree;
+};
+
+
+/*
+ * local declarations
+ */
+static void prof_drain(struct amp_prof_t *prof);
+static void prof_name(char *name, size_t size, const void *iface);
+static int prof_cmp(const void *left, const void *right);
+static int stat_cmp(const void *left, const void *right);
+static int float_cmp(const void *left, const void *right);
+
+/*
+ * global variables
+ */
+struct amp_prof_t *amp_prof = NULL;
+
+static __thread uint64_t prof_child = 0;
+
+
+/**
+ * Create a profiler.
+ *   &returns: The profiler.
+ */
+struct amp_prof_t *amp_prof_new(void)
+{
+	struct amp_prof_t *prof;
+
+	prof = malloc(sizeof(struct amp_prof_t));
+	prof->enable = false;
+	prof->scale = 0.0;
+	prof->ring = amp_mpsc_init(AMP_PROF_LEN);
+	prof->cell = NULL;
+	prof->lock = sys_mutex_init(0);
+	prof->tree = avltree_init(prof_cmp, free);
+
+	return prof;
+}
+
+/**
+ * Delete a profiler. The audio callback must no longer be running.
+ *   @prof: The profiler.
+ */
+void amp_prof_delete(struct amp_prof_t *prof)
+{
+	amp_prof_enable(prof, false);
+
+	avltree_destroy(&prof->tree);
+	sys_mutex_destroy(&prof->lock);
+	amp_mpsc_destroy(&prof->ring);
+	erase(prof->cell);
+	free(prof);
+}
+
+
+/**
+ * Read the tick counter.
+ *   &returns: The ticks.
+ */
+static inline uint64_t prof_tick(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __builtin_ia32_rdtsc();
+#else
+	return sys_utime();
+#endif
+}
+
+/**
+ * Enable or disable the profiler. Only one profiler may be enabled at a
+ * time, and the first enable calibrates the tick counter.
+ *   @prof: The profiler.
+ *   @enable: The enable flag.
+ */
+void amp_prof_enable(struct amp_prof_t *prof, bool enable)
+{
+	sys_mutex_lock(&prof->lock);
+
+	if(enable && (prof->cell == NULL)) {
+		uint64_t tick;
+		int64_t utime;
+
+		prof->cell = malloc(AMP_PROF_LEN * sizeof(struct prof_sample_t));
+
+		tick = prof_tick();
+		utime = sys_utime();
+		sys_usleep(20000);
+		prof->scale = (double)(sys_utime() - utime) / (double)(prof_tick() - tick);
+	}
+
+	prof->enable = enable;
+
+	if(enable)
+		__atomic_store_n(&amp_prof, prof, __ATOMIC_RELEASE);
+	else {
+		struct amp_prof_t *cur = prof;
+
+		__atomic_compare_exchange_n(&amp_prof, &cur, NULL, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+	}
+
+	sys_mutex_unlock(&prof->lock);
+}
+
+/**
+ * Check if the profiler is enabled.
+ *   @prof: The profiler.
+ *   &returns: True if enabled.
+ */
+bool amp_prof_enabled(struct amp_prof_t *prof)
+{
+	return prof->enable;
+}
+
+
+/**
+ * Push a sample onto the ring of the active profiler. Any number of threads
+ * may push concurrently; the sample is dropped if the ring is full.
+ *   @ref: The reference.
+ *   @iface: The interface.
+ *   @len: The block length.
+ *   @self: The exclusive ticks.
+ *   @total: The inclusive ticks.
+ */
+static void prof_push(const void *ref, const void *iface, unsigned int len, uint64_t self, uint64_t total)
+{
+	uint64_t pos;
+	struct amp_prof_t *prof;
+
+	prof = __atomic_load_n(&amp_prof, __ATOMIC_ACQUIRE);
+	if((prof == NULL) || !amp_mpsc_claim(&prof->ring, &pos))
+		return;
+
+	prof->cell[pos & (AMP_PROF_LEN - 1)] = (struct prof_sample_t){ { ref, iface }, len, self, total };
+	amp_mpsc_publish(&prof->ring, pos);
+}
+
+/**
+ * Begin timing a node.
+ *   @save: Out. The saved nested time of the parent.
+ *   &returns: The starting tick.
+ */
+static inline uint64_t prof_enter(uint64_t *save)
+{
+	*save = prof_child;
+	prof_child = 0;
+
+	return prof_tick();
+}
+
+/**
+ * Finish timing a node.
+ *   @ref: The reference.
+ *   @iface: The interface.
+ *   @len: The block length.
+ *   @save: The saved nested time of the parent.
+ *   @begin: The starting tick.
+ */
+static inline void prof_leave(const void *ref, const void *iface, unsigned int len, uint64_t save, uint64_t begin)
+{
+	uint64_t total;
+
+	total = prof_tick() - begin;
+	prof_push(ref, iface, len, (total > prof_child) ? (total - prof_child) : 0, total);
+	prof_child = save + total;
+}
+
+/**
+ * Process an instrument under the profiler.
+ *   @instr: The instrument.
+ *   @buf: The buffer.
+ *   @time: The time.
+ *   @len: The length.
+ *   @queue: Action queue.
+ *   &returns: The continuation flag.
+ */
+bool amp_prof_instr(struct amp_instr_t instr, dsp_sample_t **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+{
+	bool cont;
+	uint64_t save, begin;
+
+	begin = prof_enter(&save);
+	cont = instr.iface->proc(instr.ref, buf, time, len, queue);
+	prof_leave(instr.ref, instr.iface, len, save, begin);
+
+	return cont;
+}
+
+/**
+ * Process an effect under the profiler.
+ *   @effect: The effect.
+ *   @buf: The buffer.
+ *   @time: The time.
+ *   @len: The length.
+ *   @queue: The action queue.
+ *   &returns: The continuation flag.
+ */
+bool amp_prof_effect(struct amp_effect_t effect, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+{
+	bool cont;
+	uint64_t save, begin;
+
+	begin = prof_enter(&save);
+	cont = effect.iface->proc(effect.ref, buf, time, len, queue);
+	prof_leave(effect.ref, effect.iface, len, save, begin);
+
+	return cont;
+}
+
+/**
+ * Process a module under the profiler.
+ *   @module: The module.
+ *   @buf: The buffer.
+ *   @time: The time.
+ *   @len: The length.
+ *   @queue: The action queue.
+ *   &returns: The continuation flag.
+ */
+bool amp_prof_module(struct amp_module_t module, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+{
+	bool cont;
+	uint64_t save, begin;
+
+	begin = prof_enter(&save);
+	cont = module.iface->proc(module.ref, buf, time, len, queue);
+	prof_leave(module.ref, module.iface, len, save, begin);
+
+	return cont;
+}
+
+
+/**
+ * Retrieve statistics for every node seen in the last five seconds, sorted
+ * by decreasing mean time. Older nodes are discarded.
+ *   @prof: The profiler.
+ *   @stat: Out. The allocated statistics array.
+ *   &returns: The number of nodes.
+ */
+unsigned int amp_prof_stat(struct amp_prof_t *prof, struct amp_prof_stat_t **stat)
+{
+	int64_t now;
+	unsigned int i, n, nstale;
+	struct avltree_inst_t *inst;
+	struct prof_node_t **stale;
+
+	sys_mutex_lock(&prof->lock);
+
+	if(prof->cell != NULL)
+		prof_drain(prof);
+
+	now = sys_utime();
+	n = nstale = 0;
+	stale = NULL;
+
+	for(inst = avltree_first(&prof->tree); inst != NULL; inst = avltree_next(inst)) {
+		struct prof_node_t *node = inst->val;
+
+		if((now - node->seen) > 5000000) {
+			stale = realloc(stale, (nstale + 1) * sizeof(void *));
+			stale[nstale++] = node;
+		}
+		else
+			n++;
+	}
+
+	for(i = 0; i < nstale; i++)
+		free(avltree_remove(&prof->tree, &stale[i]->key));
+
+	erase(stale);
+
+	*stat = malloc(n * sizeof(struct amp_prof_stat_t));
+
+	for(inst = avltree_first(&prof->tree), i = 0; inst != NULL; inst = avltree_next(inst), i++) {
+		unsigned int j;
+		double self = 0.0, total = 0.0;
+		struct prof_node_t *node = inst->val;
+		float sort[AMP_PROF_HIST];
+
+		for(j = 0; j < node->cnt; j++) {
+			self += sort[j] = node->self[j];
+			total += node->total[j];
+		}
+
+		qsort(sort, node->cnt, sizeof(float), float_cmp);
+
+		memcpy((*stat)[i].name, node->name, sizeof(node->name));
+		(*stat)[i].ref = node->key.ref;
+		(*stat)[i].cnt = node->cnt;
+		(*stat)[i].len = node->len;
+		(*stat)[i].mean = self / node->cnt;
+		(*stat)[i].p99 = sort[(99 * node->cnt - 1) / 100];
+		(*stat)[i].worst = sort[node->cnt - 1];
+		(*stat)[i].total = total / node->cnt;
+	}
+
+	sys_mutex_unlock(&prof->lock);
+
+	qsort(*stat, n, sizeof(struct amp_prof_stat_t), stat_cmp);
+
+	return n;
+}
+
+/**
+ * Retrieve the number of samples lost to a full ring.
+ *   @prof: The profiler.
+ *   &returns: The lost count.
+ */
+uint64_t amp_prof_lost(struct amp_prof_t *prof)
+{
+	return amp_mpsc_lost(&prof->ring);
+}
+
+
+/**
+ * Drain the ring into the node windows. The lock must be held.
+ *   @prof: The profiler.
+ */
+static void prof_drain(struct amp_prof_t *prof)
+{
+	int64_t now;
+	unsigned int idx;
+	struct prof_sample_t sample;
+	struct prof_node_t *node;
+
+	now = sys_utime();
+
+	while(true) {
+		if(!amp_mpsc_peek(&prof->ring, &idx))
+			break;
+
+		sample = prof->cell[idx];
+		amp_mpsc_release(&prof->ring);
+
+		node = avltree_lookup(&prof->tree, &sample.key);
+		if(node == NULL) {
+			node = malloc(sizeof(struct prof_node_t));
+			node->key = sample.key;
+			node->idx = node->cnt = 0;
+			prof_name(node->name, sizeof(node->name), sample.key.iface);
+			avltree_insert(&prof->tree, &node->key, node);
+		}
+
+		node->self[node->idx] = sample.self * prof->scale;
+		node->total[node->idx] = sample.total * prof->scale;
+		node->idx = (node->idx + 1) % AMP_PROF_HIST;
+		node->len = sample.len;
+		node->seen = now;
+
+		if(node->cnt < AMP_PROF_HIST)
+			node->cnt++;
+	}
+}
+
+/**
+ * Name a node from the symbol of its interface, so that 'amp_reverb_iface'
+ * becomes 'reverb'. The address is used if the symbol cannot be found.
+ *   @name: The name buffer.
+ *   @size: The buffer size.
+ *   @iface: The interface.
+ */
+static void prof_name(char *name, size_t size, const void *iface)
+{
+#ifndef WINDOWS
+	Dl_info info;
+
+	if((dladdr(iface, &info) != 0) && (info.dli_sname != NULL)) {
+		size_t len;
+		const char *str = info.dli_sname;
+
+		if(strncmp(str, "amp_", 4) == 0)
+			str += 4;
+
+		len = strlen(str);
+		if((len > 6) && (strcmp(str + len - 6, "_iface") == 0))
+			len -= 6;
+
+		snprintf(name, size, "%.*s", (int)len, str);
+
+		return;
+	}
+#endif
+
+	snprintf(name, size, "%p", iface);
+}
+
+/**
+ * Compare two node keys by reference and interface.
+ *   @left: The left key.
+ *   @right: The right key.
+ *   &returns: Their order.
+ */
+static int prof_cmp(const void *left, const void *right)
+{
+	const struct prof_key_t *l = left, *r = right;
+
+	if(l->ref != r->ref)
+		return (l->ref > r->ref) ? 1 : -1;
+	else if(l->iface != r->iface)
+		return (l->iface > r->iface) ? 1 : -1;
+	else
+		return 0;
+}
+
+/**
+ * Compare two statistics by decreasing mean.
+ *   @left: The left statistic.
+ *   @right: The right statistic.
+ *   &returns: Their order.
+ */
+static int stat_cmp(const void *left, const void *right)
+{
+	const struct amp_prof_stat_t *l = left, *r = right;
+
+	return (l->mean < r->mean) ? 1 : (l->mean > r->mean) ? -1 : 0;
+}
+
+/**
+ * Compare two floats.
+ *   @left: The left float.
+ *   @right: The right float.
+ *   &returns: Their order.
+ */
+static int float_cmp(const void *left, const void *right)
+{
+	float l = *(const float *)left, r = *(const float *)right;
+
+	return (l > r) ? 1 : (l < r) ? -1 : 0;
+}
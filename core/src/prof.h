@@ -0,0 +1,42 @@
+#ifndef PROF_H
+#define PROF_H
+
+/*
+ * profiler definitions
+ *   @AMP_PROF_LEN: The sample ring length, a power of two.
+ *   @AMP_PROF_HIST: The number of samples retained per node.
+ */
+#define AMP_PROF_LEN  (16*1024)
+#define AMP_PROF_HIST 1024
+
+/**
+ * Profiler statistics structure. All times are in microseconds and measure
+ * the node itself, excluding nested nodes, except for the total.
+ *   @name: The node name.
+ *   @ref: The node reference.
+ *   @cnt: The number of samples in the window.
+ *   @len: The most recent block length.
+ *   @mean, p99, worst: The mean, 99th percentile, and worst time per block.
+ *   @total: The mean time per block including nested nodes.
+ */
+struct amp_prof_stat_t {
+	char name[32];
+	const void *ref;
+	unsigned int cnt, len;
+	double mean, p99, worst, total;
+};
+
+
+/*
+ * profiler declarations
+ */
+struct amp_prof_t *amp_prof_new(void);
+void amp_prof_delete(struct amp_prof_t *prof);
+
+void amp_prof_enable(struct amp_prof_t *prof, bool enable);
+bool amp_prof_enabled(struct amp_prof_t *prof);
+
+unsigned int amp_prof_stat(struct amp_prof_t *prof, struct amp_prof_stat_t **stat);
+uint64_t amp_prof_lost(struct amp_prof_t *prof);
+
+#endif
@@ -134,6 +134,23 @@ static inline struct amp_event_t *amp_queue_event(struct amp_queue_t *queue, uns
 	return action ? &action->event : NULL;
 }
 
+/**
+ * Split a block at the next pending action. Once every action at the current
+ * index has been retrieved, the samples up to the returned index are free of
+ * events and may be processed as a single run.
+ *   @queue: The queue.
+ *   @n: The position pointer.
+ *   @len: The block length.
+ *   &returns: The end of the event-free run.
+ */
+static inline unsigned int amp_queue_split(struct amp_queue_t *queue, unsigned int n, unsigned int len)
+{
+	if(n >= queue->idx)
+		return len;
+
+	return (queue->arr[n].delay < len) ? queue->arr[n].delay : len;
+}
+
 
 /**
  * Sequencer processing function.
@@ -0,0 +1,378 @@
+#include "common.h"
+
+
+/*
+ * local declarations
+ */
+static unsigned int voice_victim(struct amp_voices_t *voices, uint16_t key);
+static void voice_unkey(struct amp_voices_t *voices, unsigned int idx);
+static void voice_unlive(struct amp_voices_t *voices, unsigned int idx);
+
+static bool heap_before(struct amp_voices_t *voices, bool fading, unsigned int a, unsigned int b);
+static void heap_set(struct amp_voices_t *voices, bool fading, unsigned int pos, unsigned int idx);
+static void heap_up(struct amp_voices_t *voices, bool fading, unsigned int pos);
+static void heap_down(struct amp_voices_t *voices, bool fading, unsigned int pos);
+static void heap_push(struct amp_voices_t *voices, bool fading, unsigned int idx);
+static void heap_remove(struct amp_voices_t *voices, bool fading, unsigned int idx);
+
+
+/**
+ * Create a voice manager.
+ *   @simul: The number of simultaneous voices.
+ *   @steal: The stealing policy.
+ *   &returns: The voice manager.
+ */
+struct amp_voices_t *amp_voices_new(unsigned int simul, enum amp_steal_e steal)
+{
+	unsigned int i;
+	struct amp_voices_t *voices;
+
+	assert(simul > 0);
+
+	voices = malloc(sizeof(struct amp_voices_t) + 2 * simul * sizeof(struct amp_voice_t));
+	voices->steal = steal;
+	voices->simul = simul;
+	voices->total = 2 * simul;
+	voices->nheap = voices->nfading = voices->nlive = 0;
+	voices->nfree = voices->total;
+	voices->age = 0;
+	voices->heap = malloc(voices->total * sizeof(unsigned int));
+	voices->fading = malloc(voices->total * sizeof(unsigned int));
+	voices->live = malloc(voices->total * sizeof(unsigned int));
+	voices->free = malloc(voices->total * sizeof(unsigned int));
+
+	for(i = 0; i < 128; i++)
+		voices->key[i] = -1;
+
+	for(i = 0; i < voices->total; i++)
+		voices->free[i] = voices->total - i - 1;
+
+	return voices;
+}
+
+/**
+ * Delete a voice manager.
+ *   @voices: The voice manager.
+ */
+void amp_voices_delete(struct amp_voices_t *voices)
+{
+	free(voices->heap);
+	free(voices->fading);
+	free(voices->live);
+	free(voices->free);
+	free(voices);
+}
+
+
+/**
+ * Allocate a voice for a key. If the simultaneous voices are all in use, a
+ * voice is chosen by the stealing policy and marked as fading; the caller
+ * should fade it out and free it once silent. When every slot is in use, the
+ * oldest fading voice is reused without finishing its fade, so a sounding
+ * voice is never cut.
+ *   @voices: The voice manager.
+ *   @key: The key.
+ *   @stolen: Out. The stolen voice to fade out, negative if none.
+ *   &returns: The voice index.
+ */
+unsigned int amp_voices_alloc(struct amp_voices_t *voices, uint16_t key, int *stolen)
+{
+	unsigned int idx;
+	struct amp_voice_t *voice;
+
+	*stolen = -1;
+
+	if(voices->nfree == 0) {
+		assert(voices->nfading > 0);
+
+		idx = voices->fading[0];
+		heap_remove(voices, true, idx);
+		voice_unlive(voices, idx);
+		voices->free[voices->nfree++] = idx;
+	}
+
+	if(voices->nheap >= voices->simul) {
+		idx = voice_victim(voices, key);
+		heap_remove(voices, false, idx);
+		voice_unkey(voices, idx);
+		voices->voice[idx].fade = true;
+		heap_push(voices, true, idx);
+		*stolen = idx;
+	}
+
+	idx = voices->free[--voices->nfree];
+	voice = &voices->voice[idx];
+	voice->key = key;
+	voice->held = true;
+	voice->fade = false;
+	voice->age = voices->age++;
+	voice->level = INFINITY;
+
+	voice->live = voices->nlive;
+	voices->live[voices->nlive++] = idx;
+
+	heap_push(voices, false, idx);
+
+	if(key < 128)
+		voices->key[key] = idx;
+
+	return idx;
+}
+
+/**
+ * Release the voice playing a key.
+ *   @voices: The voice manager.
+ *   @key: The key.
+ *   &returns: The released voice, negative if none.
+ */
+int amp_voices_release(struct amp_voices_t *voices, uint16_t key)
+{
+	int idx;
+
+	idx = amp_voices_key(voices, key);
+	if(idx < 0)
+		return -1;
+
+	voices->voice[idx].held = false;
+	if(voices->steal == amp_steal_release_v) {
+		heap_up(voices, false, voices->voice[idx].heap);
+		heap_down(voices, false, voices->voice[idx].heap);
+	}
+
+	return idx;
+}
+
+/**
+ * Report the level of a voice, used by the quietest policy.
+ *   @voices: The voice manager.
+ *   @idx: The voice index.
+ *   @level: The level.
+ */
+void amp_voices_level(struct amp_voices_t *voices, unsigned int idx, float level)
+{
+	struct amp_voice_t *voice = &voices->voice[idx];
+
+	voice->level = level;
+	if((voices->steal == amp_steal_quiet_v) && !voice->fade) {
+		heap_up(voices, false, voice->heap);
+		heap_down(voices, false, voice->heap);
+	}
+}
+
+/**
+ * Free a voice that has finished playing.
+ *   @voices: The voice manager.
+ *   @idx: The voice index.
+ */
+void amp_voices_free(struct amp_voices_t *voices, unsigned int idx)
+{
+	if(!voices->voice[idx].fade) {
+		heap_remove(voices, false, idx);
+		voice_unkey(voices, idx);
+	}
+	else
+		heap_remove(voices, true, idx);
+
+	voice_unlive(voices, idx);
+	voices->free[voices->nfree++] = idx;
+}
+
+
+/**
+ * Parse a stealing policy.
+ *   @str: The string, one of 'oldest', 'quietest', 'key', or 'release'.
+ *   @steal: Out. The policy.
+ *   &returns: True if valid.
+ */
+bool amp_steal_get(const char *str, enum amp_steal_e *steal)
+{
+	if(strcmp(str, "oldest") == 0)
+		*steal = amp_steal_oldest_v;
+	else if(strcmp(str, "quietest") == 0)
+		*steal = amp_steal_quiet_v;
+	else if(strcmp(str, "key") == 0)
+		*steal = amp_steal_key_v;
+	else if(strcmp(str, "release") == 0)
+		*steal = amp_steal_release_v;
+	else
+		return false;
+
+	return true;
+}
+
+/**
+ * Compute the per-sample multiplier that fades a stolen voice to silence.
+ *   @rate: The sample rate.
+ *   &returns: The multiplier.
+ */
+float amp_voice_fade(unsigned int rate)
+{
+	return powf(0.001f, 1.0f / (AMP_VOICE_FADE * rate));
+}
+
+
+/**
+ * Choose the voice to steal. The heap must not be empty.
+ *   @voices: The voice manager.
+ *   @key: The key being started.
+ *   &returns: The voice index.
+ */
+static unsigned int voice_victim(struct amp_voices_t *voices, uint16_t key)
+{
+	if((voices->steal == amp_steal_key_v) && (amp_voices_key(voices, key) >= 0))
+		return amp_voices_key(voices, key);
+
+	return voices->heap[0];
+}
+
+/**
+ * Remove a voice from the key map.
+ *   @voices: The voice manager.
+ *   @idx: The voice index.
+ */
+static void voice_unkey(struct amp_voices_t *voices, unsigned int idx)
+{
+	uint16_t key = voices->voice[idx].key;
+
+	if((key < 128) && (voices->key[key] == (int)idx))
+		voices->key[key] = -1;
+}
+
+/**
+ * Remove a voice from the live list, moving the last voice into its place.
+ *   @voices: The voice manager.
+ *   @idx: The voice index.
+ */
+static void voice_unlive(struct amp_voices_t *voices, unsigned int idx)
+{
+	unsigned int pos, last;
+
+	pos = voices->voice[idx].live;
+	last = voices->live[--voices->nlive];
+	voices->live[pos] = last;
+	voices->voice[last].live = pos;
+}
+
+
+/**
+ * Check if a voice is stolen before another. Fading voices are reused oldest
+ * first, whatever the policy.
+ *   @voices: The voice manager.
+ *   @fading: Flag selecting the fading heap.
+ *   @a: The first voice index.
+ *   @b: The second voice index.
+ *   &returns: True if the first voice is stolen first.
+ */
+static bool heap_before(struct amp_voices_t *voices, bool fading, unsigned int a, unsigned int b)
+{
+	struct amp_voice_t *x = &voices->voice[a], *y = &voices->voice[b];
+
+	switch(fading ? amp_steal_oldest_v : voices->steal) {
+	case amp_steal_quiet_v:
+		if(x->level != y->level)
+			return x->level < y->level;
+
+		break;
+
+	case amp_steal_release_v:
+		if(x->held != y->held)
+			return !x->held;
+
+		break;
+
+	default:
+		break;
+	}
+
+	return x->age < y->age;
+}
+
+/**
+ * Place a voice in a heap.
+ *   @voices: The voice manager.
+ *   @fading: Flag selecting the fading heap.
+ *   @pos: The heap position.
+ *   @idx: The voice index.
+ */
+static void heap_set(struct amp_voices_t *voices, bool fading, unsigned int pos, unsigned int idx)
+{
+	(fading ? voices->fading : voices->heap)[pos] = idx;
+	voices->voice[idx].heap = pos;
+}
+
+/**
+ * Move a heap entry towards the root.
+ *   @voices: The voice manager.
+ *   @fading: Flag selecting the fading heap.
+ *   @pos: The heap position.
+ */
+static void heap_up(struct amp_voices_t *voices, bool fading, unsigned int pos)
+{
+	unsigned int *heap = fading ? voices->fading : voices->heap, idx = heap[pos];
+
+	while((pos > 0) && heap_before(voices, fading, idx, heap[(pos - 1) / 2])) {
+		heap_set(voices, fading, pos, heap[(pos - 1) / 2]);
+		pos = (pos - 1) / 2;
+	}
+
+	heap_set(voices, fading, pos, idx);
+}
+
+/**
+ * Move a heap entry towards the leaves.
+ *   @voices: The voice manager.
+ *   @fading: Flag selecting the fading heap.
+ *   @pos: The heap position.
+ */
+static void heap_down(struct amp_voices_t *voices, bool fading, unsigned int pos)
+{
+	unsigned int *heap = fading ? voices->fading : voices->heap, idx = heap[pos];
+	unsigned int child, n = fading ? voices->nfading : voices->nheap;
+
+	while((child = 2 * pos + 1) < n) {
+		if(((child + 1) < n) && heap_before(voices, fading, heap[child + 1], heap[child]))
+			child++;
+
+		if(!heap_before(voices, fading, heap[child], idx))
+			break;
+
+		heap_set(voices, fading, pos, heap[child]);
+		pos = child;
+	}
+
+	heap_set(voices, fading, pos, idx);
+}
+
+/**
+ * Add a voice to a heap.
+ *   @voices: The voice manager.
+ *   @fading: Flag selecting the fading heap.
+ *   @idx: The voice index.
+ */
+static void heap_push(struct amp_voices_t *voices, bool fading, unsigned int idx)
+{
+	unsigned int *n = fading ? &voices->nfading : &voices->nheap;
+
+	heap_set(voices, fading, (*n)++, idx);
+	heap_up(voices, fading, voices->voice[idx].heap);
+}
+
+/**
+ * Remove a voice from a heap.
+ *   @voices: The voice manager.
+ *   @fading: Flag selecting the fading heap.
+ *   @idx: The voice index.
+ */
+static void heap_remove(struct amp_voices_t *voices, bool fading, unsigned int idx)
+{
+	unsigned int pos, last, *n = fading ? &voices->nfading : &voices->nheap;
+
+	pos = voices->voice[idx].heap;
+	if(pos == --(*n))
+		return;
+
+	last = (fading ? voices->fading : voices->heap)[*n];
+	heap_set(voices, fading, pos, last);
+	heap_up(voices, fading, pos);
+	heap_down(voices, fading, voices->voice[last].heap);
+}
@@ -0,0 +1,109 @@
+#ifndef VOICE_H
+#define VOICE_H
+
+/**
+ * Voice stealing policy enumerator.
+ *   @amp_steal_oldest_v: Steal the oldest voice.
+ *   @amp_steal_quiet_v: Steal the quietest voice.
+ *   @amp_steal_key_v: Steal the voice on the same key, otherwise the oldest.
+ *   @amp_steal_release_v: Steal the oldest released voice, otherwise the
+ *     oldest voice.
+ */
+enum amp_steal_e {
+	amp_steal_oldest_v,
+	amp_steal_quiet_v,
+	amp_steal_key_v,
+	amp_steal_release_v
+};
+
+/**
+ * Voice definitions.
+ *   @AMP_VOICE_FADE: The fade out length of a stolen voice in seconds.
+ */
+#define AMP_VOICE_FADE 0.005
+
+/**
+ * Voice structure.
+ *   @key: The key.
+ *   @held, fade: Flags indicating the key is held and the voice is fading.
+ *   @age: The start order.
+ *   @level: The last reported level.
+ *   @heap, live: The positions in the heap, or the fading heap if fading,
+ *     and in the live list.
+ */
+struct amp_voice_t {
+	uint16_t key;
+	bool held, fade;
+	uint64_t age;
+	float level;
+	unsigned int heap, live;
+};
+
+/**
+ * Voice manager structure. There are twice as many slots as simultaneous
+ * voices, so that a stolen voice fades out in its own slot while the new
+ * voice starts. Voices that are not fading are kept in a heap ordered by the
+ * stealing policy, fading voices in a second heap ordered by age, and every
+ * voice in use is kept in a compact live list.
+ *   @steal: The stealing policy.
+ *   @simul, total: The number of simultaneous voices and slots.
+ *   @nheap, nfading, nlive, nfree: The heap, fading heap, live list, and free
+ *     stack lengths.
+ *   @age: The age counter.
+ *   @key: The voice started on each key, negative if none.
+ *   @heap, fading, live, free: The heap, fading heap, live list, and free
+ *     stack.
+ *   @voice: The voice array.
+ */
+struct amp_voices_t {
+	enum amp_steal_e steal;
+	unsigned int simul, total;
+	unsigned int nheap, nfading, nlive, nfree;
+	uint64_t age;
+
+	int key[128];
+	unsigned int *heap, *fading, *live, *free;
+	struct amp_voice_t voice[];
+};
+
+/*
+ * voice manager declarations
+ */
+struct amp_voices_t *amp_voices_new(unsigned int simul, enum amp_steal_e steal);
+void amp_voices_delete(struct amp_voices_t *voices);
+
+unsigned int amp_voices_alloc(struct amp_voices_t *voices, uint16_t key, int *stolen);
+int amp_voices_release(struct amp_voices_t *voices, uint16_t key);
+void amp_voices_level(struct amp_voices_t *voices, unsigned int idx, float level);
+void amp_voices_free(struct amp_voices_t *voices, unsigned int idx);
+
+bool amp_steal_get(const char *str, enum amp_steal_e *steal);
+float amp_voice_fade(unsigned int rate);
+
+/**
+ * Retrieve the live list. Voices may be freed while iterating the list from
+ * its end to its start.
+ *   @voices: The voice manager.
+ *   @n: Out. The number of live voices.
+ *   &returns: The list of voice indices.
+ */
+static inline const unsigned int *amp_voices_live(struct amp_voices_t *voices, unsigned int *n)
+{
+	*n = voices->nlive;
+
+	return voices->live;
+}
+
+/**
+ * Retrieve the voice playing a key. Fading voices are not returned, and keys
+ * past 127 are never tracked.
+ *   @voices: The voice manager.
+ *   @key: The key.
+ *   &returns: The voice index, negative if none.
+ */
+static inline int amp_voices_key(struct amp_voices_t *voices, uint16_t key)
+{
+	return (key < 128) ? voices->key[key] : -1;
+}
+
+#endif
@@ -1,68 +1,227 @@
 #include "common.h"
+#ifdef __SSE2__
+#	include <emmintrin.h>
+#endif
 
 
+/*
+ * local definitions
+ */
+#ifdef __SSE2__
+typedef __m128d fft_z;
+#else
+typedef struct z_double_t fft_z;
+#endif
+
 /*
  * local declarations
  */
-static void fft_d(struct z_double_t *in, struct z_double_t *out, int n, int step);
+static void fft_pass(struct dsp_fft_t *fft, struct z_double_t *buf, unsigned int n, bool inv);
+
+static inline fft_z fft_load(const struct z_double_t *ptr);
+static inline void fft_store(struct z_double_t *ptr, fft_z val);
+static inline fft_z fft_add(fft_z a, fft_z b);
+static inline fft_z fft_sub(fft_z a, fft_z b);
+static inline fft_z fft_mul(fft_z a, fft_z b);
+static inline fft_z fft_scale(fft_z a, double b);
+static inline fft_z fft_conj(fft_z a);
+static inline fft_z fft_rot(fft_z a, bool inv);
+
 
 /**
- * Perform a fast fourier transform on a buffer.
+ * Create an FFT plan. The plan holds every table needed to transform a
+ * buffer, so that transforms never allocate.
+ *   @len: The length, a power of two.
+ *   &returns: The plan.
+ */
+struct dsp_fft_t *dsp_fft_new(unsigned int len)
+{
+	unsigned int i, k, bits;
+	struct dsp_fft_t *fft;
+
+	assert((len > 0) && ((len & (len - 1)) == 0));
+
+	for(bits = 0; (1u << bits) < len; bits++);
+
+	fft = malloc(sizeof(struct dsp_fft_t));
+	fft->len = len;
+	fft->rev = malloc(len * sizeof(unsigned int));
+	fft->tw = malloc(m_max_u(len / 2, 1) * sizeof(struct z_double_t));
+
+	for(i = 0; i < len; i++) {
+		fft->rev[i] = 0;
+
+		for(k = 0; k < bits; k++)
+			fft->rev[i] |= ((i >> k) & 1) << (bits - k - 1);
+	}
+
+	for(i = 0; i < m_max_u(len / 2, 1); i++)
+		fft->tw[i] = z_expi_d(-2.0 * M_PI * (double)i / (double)len);
+
+	return fft;
+}
+
+/**
+ * Delete an FFT plan.
+ *   @fft: The plan.
+ */
+void dsp_fft_delete(struct dsp_fft_t *fft)
+{
+	free(fft->rev);
+	free(fft->tw);
+	free(fft);
+}
+
+
+/**
+ * Perform a complex FFT in place.
+ *   @fft: The plan.
+ *   @buf: The buffer of the plan length.
+ */
+void dsp_fft_cplx(struct dsp_fft_t *fft, struct z_double_t *buf)
+{
+	fft_pass(fft, buf, fft->len, false);
+}
+
+/**
+ * Perform an inverse complex FFT in place, scaled by the inverse length.
+ *   @fft: The plan.
+ *   @buf: The buffer of the plan length.
+ */
+void dsp_fft_icplx(struct dsp_fft_t *fft, struct z_double_t *buf)
+{
+	unsigned int i;
+	double scale = 1.0 / fft->len;
+
+	fft_pass(fft, buf, fft->len, true);
+
+	for(i = 0; i < fft->len; i++)
+		fft_store(&buf[i], fft_scale(fft_load(&buf[i]), scale));
+}
+
+/**
+ * Perform a real FFT in place. The output holds the first half of the
+ * spectrum as interleaved complex numbers, except that the imaginary part of
+ * the first bin holds the real Nyquist bin.
+ *   @fft: The plan, with a length of at least two.
+ *   @buf: The buffer of the plan length.
+ */
+void dsp_fft_real(struct dsp_fft_t *fft, double *buf)
+{
+	unsigned int k, n = fft->len / 2;
+	struct z_double_t *z = (struct z_double_t *)buf;
+	fft_z a, b, e, o;
+
+	assert(fft->len >= 2);
+
+	fft_pass(fft, z, n, false);
+	z[0] = z_init_d(z[0].re + z[0].im, z[0].re - z[0].im);
+
+	for(k = 1; k <= n / 2; k++) {
+		a = fft_load(&z[k]);
+		b = fft_conj(fft_load(&z[n - k]));
+		e = fft_scale(fft_add(a, b), 0.5);
+		o = fft_mul(fft_rot(fft_scale(fft_sub(a, b), 0.5), false), fft_load(&fft->tw[k]));
+
+		fft_store(&z[k], fft_add(e, o));
+		fft_store(&z[n - k], fft_conj(fft_sub(e, o)));
+	}
+}
+
+/**
+ * Perform an inverse real FFT in place, scaled by the inverse length. The
+ * input is in the format produced by 'dsp_fft_real'.
+ *   @fft: The plan, with a length of at least two.
+ *   @buf: The buffer of the plan length.
+ */
+void dsp_fft_ireal(struct dsp_fft_t *fft, double *buf)
+{
+	unsigned int k, n = fft->len / 2;
+	struct z_double_t *z = (struct z_double_t *)buf;
+	fft_z a, b, e, o;
+
+	assert(fft->len >= 2);
+
+	z[0] = z_init_d((z[0].re + z[0].im) / 2.0, (z[0].re - z[0].im) / 2.0);
+
+	for(k = 1; k <= n / 2; k++) {
+		a = fft_load(&z[k]);
+		b = fft_conj(fft_load(&z[n - k]));
+		e = fft_scale(fft_add(a, b), 0.5);
+		o = fft_rot(fft_mul(fft_scale(fft_sub(a, b), 0.5), fft_conj(fft_load(&fft->tw[k]))), true);
+
+		fft_store(&z[k], fft_add(e, o));
+		fft_store(&z[n - k], fft_conj(fft_sub(e, o)));
+	}
+
+	fft_pass(fft, z, n, true);
+
+	for(k = 0; k < n; k++)
+		fft_store(&z[k], fft_scale(fft_load(&z[k]), 1.0 / n));
+}
+
+
+/**
+ * Perform a fast fourier transform on a buffer. The transform allocates, use
+ * a plan from 'dsp_fft_new' on the audio thread instead.
  *   @in: The input buffer.
  *   @mag: Optional. The magnitude.
  *   @phase: Optional. The phase.
- *   @len: The length.
+ *   @len: The length, a power of two.
  */
 void dsp_fft_d(const double *in, double *mag, double *phase, unsigned int len)
 {
 	unsigned int i;
-	struct z_double_t *a, *b;
+	struct dsp_fft_t *fft;
+	struct z_double_t *buf;
 
-	a = malloc(len * sizeof(struct z_double_t));
-	b = malloc(len * sizeof(struct z_double_t));
+	fft = dsp_fft_new(len);
+	buf = malloc(len * sizeof(struct z_double_t));
 
 	for(i = 0; i < len; i++)
-		a[i] = b[i] = z_re_d(in[i]);
+		buf[i] = z_re_d(in[i]);
 
-	fft_d(a, b, len, 1);
+	dsp_fft_cplx(fft, buf);
 
 	for(i = 0; i < len; i++) {
 		if(mag != NULL)
-			mag[i] = z_mag_d(a[i]);
+			mag[i] = z_mag_d(buf[i]);
 
 		if(phase != NULL)
-			phase[i] = z_arg_d(a[i]);
+			phase[i] = z_arg_d(buf[i]);
 	}
 
-	free(a);
-	free(b);
+	free(buf);
+	dsp_fft_delete(fft);
 }
 
 /**
- * Perform an inverse fast fourier transform on a buffer.
+ * Perform an inverse fast fourier transform on a buffer. The transform
+ * allocates, use a plan from 'dsp_fft_new' on the audio thread instead.
  *   @mag: The magnitude.
  *   @phase: The phase.
- *   @out: The input buffer.
- *   @len: The length.
+ *   @out: The output buffer.
+ *   @len: The length, a power of two.
  */
 void dsp_ifft_d(const double *mag, const double *phase, double *out, unsigned int len)
 {
 	unsigned int i;
-	struct z_double_t *a, *b;
+	struct dsp_fft_t *fft;
+	struct z_double_t *buf;
 
-	a = malloc(len * sizeof(struct z_double_t));
-	b = malloc(len * sizeof(struct z_double_t));
+	fft = dsp_fft_new(len);
+	buf = malloc(len * sizeof(struct z_double_t));
 
 	for(i = 0; i < len; i++)
-		a[i] = b[i] = z_mul_d(z_re_d(mag[i]), z_expi_d(phase[i]));
+		buf[i] = z_mul_d(z_re_d(mag[i]), z_expi_d(phase[i]));
 
-	fft_d(a, b, len, 1);
+	dsp_fft_icplx(fft, buf);
 
 	for(i = 0; i < len; i++)
-		out[i] = a[i].re / len;
+		out[i] = buf[i].re;
 
-	free(a);
-	free(b);
+	free(buf);
+	dsp_fft_delete(fft);
 }
 
 /**
@@ -77,28 +236,6 @@ double dsp_fft_freq(unsigned int idx, unsigned int rate, unsigned int size)
 	return (double)idx * (double)rate / (double)size;
 }
 
-/**
- * Internal FFT computation
- *   @in: The input.
- *   @out: The output.
- *   @n: The number of elements in the FFT.
- *   @step: The step size.
- */
-static void fft_d(struct z_double_t *in, struct z_double_t *out, int n, int step)
-{
-	if(step < n) {
-		fft_d(out, in, n, step * 2);
-		fft_d(out + step, in + step, n, step * 2);
-
-		for(int i = 0; i < n; i += 2 * step) {
-			struct z_double_t t = z_mul_d(z_expi_d(M_PI * (double)i / n), out[i + step]);
-			in[i / 2]     = z_add_d(out[i], t);
-			in[(i + n)/2] = z_sub_d(out[i], t);
-		}
-	}
-}
-
-
 /**
  * Multiply a buffer by a blackman window.
  *   @buf: The buffer.
@@ -117,3 +254,208 @@ void dsp_blackman_d(double *buf, unsigned int len)
 	for(i = 0; i < len; i++)
 		buf[i] *= a0 - a1 * cos(2.0 * M_PI * i / (len - 1)) + a2 * cos(4.0 * M_PI * i / (len - 1));
 }
+
+
+/**
+ * Perform the passes of an unscaled complex FFT in place. The input is
+ * permuted into bit-reversed order, followed by a radix-2 pass if the length
+ * is an odd power of two, and radix-4 passes for the remainder.
+ *   @fft: The plan.
+ *   @buf: The buffer.
+ *   @n: The length, a power of two no greater than the plan length.
+ *   @inv: The inverse flag.
+ */
+static void fft_pass(struct dsp_fft_t *fft, struct z_double_t *buf, unsigned int n, bool inv)
+{
+	unsigned int i, j, k, m, shift, stride;
+	struct z_double_t t;
+	fft_z a0, a1, a2, a3, b0, b1, b2, b3, w1, w2;
+
+	for(shift = 0; (fft->len >> shift) > n; shift++);
+
+	for(i = 0; i < n; i++) {
+		j = fft->rev[i] >> shift;
+		if(i < j)
+			t = buf[i], buf[i] = buf[j], buf[j] = t;
+	}
+
+	for(m = 1; (m * 4) <= n; m *= 4);
+
+	if(m < n) {
+		for(i = 0; i < n; i += 2) {
+			a0 = fft_load(&buf[i]);
+			a1 = fft_load(&buf[i + 1]);
+			fft_store(&buf[i], fft_add(a0, a1));
+			fft_store(&buf[i + 1], fft_sub(a0, a1));
+		}
+
+		m = 2;
+	}
+	else
+		m = 1;
+
+	for(; (m * 4) <= n; m *= 4) {
+		stride = fft->len / (4 * m);
+
+		for(i = 0; i < n; i += 4 * m) {
+			for(k = 0; k < m; k++) {
+				w1 = fft_load(&fft->tw[k * stride]);
+				w2 = fft_load(&fft->tw[2 * k * stride]);
+
+				if(inv)
+					w1 = fft_conj(w1), w2 = fft_conj(w2);
+
+				a0 = fft_load(&buf[i + k]);
+				a1 = fft_mul(fft_load(&buf[i + k + m]), w2);
+				a2 = fft_load(&buf[i + k + 2 * m]);
+				a3 = fft_mul(fft_load(&buf[i + k + 3 * m]), w2);
+
+				b0 = fft_add(a0, a1);
+				b1 = fft_sub(a0, a1);
+				b2 = fft_mul(fft_add(a2, a3), w1);
+				b3 = fft_rot(fft_mul(fft_sub(a2, a3), w1), inv);
+
+				fft_store(&buf[i + k], fft_add(b0, b2));
+				fft_store(&buf[i + k + m], fft_add(b1, b3));
+				fft_store(&buf[i + k + 2 * m], fft_sub(b0, b2));
+				fft_store(&buf[i + k + 3 * m], fft_sub(b1, b3));
+			}
+		}
+	}
+}
+
+
+#ifdef __SSE2__
+/**
+ * Load a complex number.
+ *   @ptr: The pointer.
+ *   &returns: The complex number.
+ */
+static inline fft_z fft_load(const struct z_double_t *ptr)
+{
+	return _mm_loadu_pd(&ptr->re);
+}
+
+/**
+ * Store a complex number.
+ *   @ptr: The pointer.
+ *   @val: The complex number.
+ */
+static inline void fft_store(struct z_double_t *ptr, fft_z val)
+{
+	_mm_storeu_pd(&ptr->re, val);
+}
+
+/**
+ * Add two complex numbers.
+ *   @a: The first value.
+ *   @b: The second value.
+ *   &returns: The sum.
+ */
+static inline fft_z fft_add(fft_z a, fft_z b)
+{
+	return _mm_add_pd(a, b);
+}
+
+/**
+ * Subtract two complex numbers.
+ *   @a: The first value.
+ *   @b: The second value.
+ *   &returns: The difference.
+ */
+static inline fft_z fft_sub(fft_z a, fft_z b)
+{
+	return _mm_sub_pd(a, b);
+}
+
+/**
+ * Multiply two complex numbers.
+ *   @a: The first value.
+ *   @b: The second value.
+ *   &returns: The product.
+ */
+static inline fft_z fft_mul(fft_z a, fft_z b)
+{
+	fft_z re, im;
+
+	re = _mm_mul_pd(a, _mm_unpacklo_pd(b, b));
+	im = _mm_mul_pd(_mm_shuffle_pd(a, a, 1), _mm_unpackhi_pd(b, b));
+
+	return _mm_add_pd(re, _mm_xor_pd(im, _mm_set_pd(0.0, -0.0)));
+}
+
+/**
+ * Scale a complex number.
+ *   @a: The complex number.
+ *   @b: The scale.
+ *   &returns: The scaled number.
+ */
+static inline fft_z fft_scale(fft_z a, double b)
+{
+	return _mm_mul_pd(a, _mm_set1_pd(b));
+}
+
+/**
+ * Conjugate a complex number.
+ *   @a: The complex number.
+ *   &returns: The conjugate.
+ */
+static inline fft_z fft_conj(fft_z a)
+{
+	return _mm_xor_pd(a, _mm_set_pd(-0.0, 0.0));
+}
+
+/**
+ * Rotate a complex number by a quarter turn, clockwise for the forward
+ * transform and counterclockwise for the inverse.
+ *   @a: The complex number.
+ *   @inv: The inverse flag.
+ *   &returns: The rotated number.
+ */
+static inline fft_z fft_rot(fft_z a, bool inv)
+{
+	a = _mm_shuffle_pd(a, a, 1);
+
+	return _mm_xor_pd(a, inv ? _mm_set_pd(0.0, -0.0) : _mm_set_pd(-0.0, 0.0));
+}
+#else
+static inline fft_z fft_load(const struct z_double_t *ptr)
+{
+	return *ptr;
+}
+
+static inline void fft_store(struct z_double_t *ptr, fft_z val)
+{
+	*ptr = val;
+}
+
+static inline fft_z fft_add(fft_z a, fft_z b)
+{
+	return z_add_d(a, b);
+}
+
+static inline fft_z fft_sub(fft_z a, fft_z b)
+{
+	return z_sub_d(a, b);
+}
+
+static inline fft_z fft_mul(fft_z a, fft_z b)
+{
+	return z_mul_d(a, b);
+}
+
+static inline fft_z fft_scale(fft_z a, double b)
+{
+	return z_init_d(a.re * b, a.im * b);
+}
+
+static inline fft_z fft_conj(fft_z a)
+{
+	return z_init_d(a.re, -a.im);
+}
+
+static inline fft_z fft_rot(fft_z a, bool inv)
+{
+	return inv ? z_init_d(-a.im, a.re) : z_init_d(a.im, -a.re);
+}
+#endif
@@ -1,6 +1,30 @@
 #ifndef ALGO_H
 #define ALGO_H
 
+/**
+ * FFT plan structure.
+ *   @len: The length.
+ *   @rev: The bit-reversal permutation.
+ *   @tw: The twiddle factors, the first half of the roots of unity.
+ */
+struct dsp_fft_t {
+	unsigned int len;
+	unsigned int *rev;
+	struct z_double_t *tw;
+};
+
+
+/*
+ * fft declarations
+ */
+struct dsp_fft_t *dsp_fft_new(unsigned int len);
+void dsp_fft_delete(struct dsp_fft_t *fft);
+
+void dsp_fft_cplx(struct dsp_fft_t *fft, struct z_double_t *buf);
+void dsp_fft_icplx(struct dsp_fft_t *fft, struct z_double_t *buf);
+void dsp_fft_real(struct dsp_fft_t *fft, double *buf);
+void dsp_fft_ireal(struct dsp_fft_t *fft, double *buf);
+
 /*
  * algorithm declarations
  */
@@ -112,12 +112,17 @@ char *dsp_buf_save(struct dsp_buf_t *buf, const char *path, unsigned int rate)
  */
 struct dsp_ring_t *dsp_ring_new(unsigned int len)
 {
+	unsigned int cap;
 	struct dsp_ring_t *ring;
 
-	ring = malloc(sizeof(struct dsp_ring_t) + len * sizeof(double));
+	for(cap = 1; cap < len; cap *= 2)
+		;
+
+	ring = malloc(sizeof(struct dsp_ring_t) + cap * sizeof(double));
 	ring->i = 0;
 	ring->len = len;
-	dsp_zero_d(ring->arr, len);
+	ring->mask = cap - 1;
+	dsp_zero_d(ring->arr, cap);
 
 	return ring;
 }
@@ -131,7 +136,6 @@ void dsp_ring_delete(struct dsp_ring_t *ring)
 	free(ring);
 }
 
-
 /**
  * Find the length for a sample rate conversion.
  *   @len: The input length.
@@ -145,7 +149,8 @@ unsigned int dsp_rerate(unsigned int len, unsigned int outrate, unsigned int inr
 }
 
 /**
- * Perform sample rate conversion between buffers.
+ * Perform sample rate conversion between buffers using the highest quality
+ * resampler.
  *   @out: The output.
  *   @outlen: The output length.
  *   @outrate: The output rate.
@@ -155,15 +160,17 @@ unsigned int dsp_rerate(unsigned int len, unsigned int outrate, unsigned int inr
  */
 void dsp_rerate_f(float *out, unsigned int outlen, unsigned int outrate, float *in, unsigned int inlen, unsigned int inrate)
 {
-	float idx, ratio;
-	unsigned int i;
+	struct dsp_sinc_t *sinc;
 
-	ratio = (float)inrate / (float)outrate;
+	if(inrate == outrate) {
+		memcpy(out, in, m_min_u(outlen, inlen) * sizeof(float));
+		if(outlen > inlen)
+			dsp_zero_f(out + inlen, outlen - inlen);
 
-	for(i = 0; i < outlen; i++) {
-		idx = ratio * i;
-
-		idx = round(idx);
-		out[i] = ((int)idx < inlen) ? in[(int)idx] : 0.0;
+		return;
 	}
+
+	sinc = dsp_sinc_new(DSP_SINC_HIGH, (double)inrate / (double)outrate);
+	dsp_sinc_proc(sinc, out, outlen, in, inlen);
+	dsp_sinc_delete(sinc);
 }
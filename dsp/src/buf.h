@@ -33,15 +33,28 @@ static inline void dsp_buf_erase(struct dsp_buf_t *buf)
 
 
 /**
- * Ring buffer structure.
- *   @i, len: The index and length.
+ * Ring buffer structure. The capacity is a power of two no less than the
+ * length, so that indices wrap by masking; the write index runs freely and
+ * is only masked on access.
+ *   @i, len, mask: The write index, length, and capacity mask.
  *   @arr: The array.
  */
 struct dsp_ring_t {
-	unsigned int i, len;
+	unsigned int i, len, mask;
 	double arr[];
 };
 
+/**
+ * Ring buffer span structure. A run of samples in a ring buffer is covered by
+ * at most two contiguous segments, the second starting at the beginning of
+ * the array.
+ *   @arr, len: The segment arrays and lengths.
+ */
+struct dsp_span_t {
+	double *arr[2];
+	unsigned int len[2];
+};
+
 /*
  * ring buffer declarations
  */
@@ -50,7 +63,7 @@ void dsp_ring_delete(struct dsp_ring_t *ring);
 
 static inline void dsp_ring_zero(struct dsp_ring_t *ring)
 {
-	dsp_zero_d(ring->arr, ring->len);
+	dsp_zero_d(ring->arr, ring->mask + 1);
 }
 
 /**
@@ -60,7 +73,7 @@ static inline void dsp_ring_zero(struct dsp_ring_t *ring)
  */
 static inline double dsp_ring_last(struct dsp_ring_t *ring)
 {
-	return ring->arr[ring->i];
+	return ring->arr[(ring->i - ring->len) & ring->mask];
 }
 
 /**
@@ -70,12 +83,12 @@ static inline double dsp_ring_last(struct dsp_ring_t *ring)
  */
 static inline void dsp_ring_put(struct dsp_ring_t *ring, double val)
 {
-	ring->arr[ring->i] = val;
-	ring->i = (ring->i + 1) % ring->len;
+	ring->arr[ring->i++ & ring->mask] = val;
 }
 
 /**
- * Retrieve a value from the ring buffer.
+ * Retrieve a value from the ring buffer. An index of zero wraps to the
+ * length, the oldest value.
  *   @ring: The ring buffer.
  *   @idx: The index into the buffer.
  *   &returns: The value.
@@ -84,7 +97,7 @@ static inline double dsp_ring_get(struct dsp_ring_t *ring, unsigned int idx)
 {
 	assert(idx <= ring->len);
 
-	return ring->arr[(ring->i - idx + ring->len) % ring->len];
+	return ring->arr[(ring->i - (idx ?: ring->len)) & ring->mask];
 }
 
 /**
@@ -138,6 +151,77 @@ static inline double dsp_ring_proc(struct dsp_ring_t *ring, double val)
 	return ret;
 }
 
+/**
+ * Retrieve the span of a run of delayed samples.
+ *   @ring: The ring buffer.
+ *   @delay: The delay of the first sample of the run.
+ *   @len: The run length, at most the capacity.
+ *   &returns: The span.
+ */
+static inline struct dsp_span_t dsp_ring_span(struct dsp_ring_t *ring, unsigned int delay, unsigned int len)
+{
+	unsigned int idx, n;
+
+	assert(len <= (ring->mask + 1));
+
+	idx = (ring->i - delay) & ring->mask;
+	n = m_min_u(len, ring->mask + 1 - idx);
+
+	return (struct dsp_span_t){ { ring->arr + idx, ring->arr }, { n, len - n } };
+}
+
+/**
+ * Read a run of delayed samples from a ring buffer. Every sample of the run
+ * precedes the write index if the delay is no less than the length.
+ *   @ring: The ring buffer.
+ *   @delay: The delay of the first sample.
+ *   @out: The output array.
+ *   @len: The length.
+ */
+static inline void dsp_ring_read(struct dsp_ring_t *ring, unsigned int delay, double *out, unsigned int len)
+{
+	struct dsp_span_t span = dsp_ring_span(ring, delay, len);
+
+	dsp_copy_d(out, span.arr[0], span.len[0]);
+	dsp_copy_d(out + span.len[0], span.arr[1], span.len[1]);
+}
+
+/**
+ * Mix a run of delayed samples from a ring buffer into a buffer.
+ *   @ring: The ring buffer.
+ *   @delay: The delay of the first sample.
+ *   @buf: The buffer.
+ *   @gain: The gain.
+ *   @len: The length.
+ */
+static inline void dsp_ring_mix(struct dsp_ring_t *ring, unsigned int delay, dsp_sample_t *buf, double gain, unsigned int len)
+{
+	unsigned int i, j;
+	struct dsp_span_t span = dsp_ring_span(ring, delay, len);
+
+	for(j = 0; j < 2; j++) {
+		for(i = 0; i < span.len[j]; i++)
+			buf[i] += gain * span.arr[j][i];
+
+		buf += span.len[j];
+	}
+}
+
+/**
+ * Write a run of samples to a ring buffer.
+ *   @ring: The ring buffer.
+ *   @in: The input array.
+ *   @len: The length.
+ */
+static inline void dsp_ring_write(struct dsp_ring_t *ring, const double *in, unsigned int len)
+{
+	struct dsp_span_t span = dsp_ring_span(ring, 0, len);
+
+	memcpy(span.arr[0], in, span.len[0] * sizeof(double));
+	memcpy(span.arr[1], in + span.len[0], span.len[1] * sizeof(double));
+	ring->i += len;
+}
+
 /**
  * Delete a ring buffer if non-null.
  *   @ring: The ring buffer.
@@ -0,0 +1,177 @@
+#ifndef COEF_H
+#define COEF_H
+
+/**
+ * Coefficient ramp definitions.
+ *   @DSP_COEF_MAX: The maximum number of coefficients.
+ *   @DSP_COEF_KEY: The maximum number of parameters in a key.
+ *   @DSP_COEF_LEN: The default control period in samples.
+ */
+#define DSP_COEF_MAX 12
+#define DSP_COEF_KEY 4
+#define DSP_COEF_LEN 16
+
+/**
+ * Coefficient ramp structure. Filter coefficients are computed once per
+ * control period from the parameters at its end, and ramped linearly across
+ * the period. Coefficients are only recomputed when the parameters, given as
+ * the key, change. Every coefficient structure is made only of doubles, so
+ * the coefficients are handled as a double array.
+ *   @len: The control period, one for audio rate.
+ *   @init: Flag indicating the ramp holds coefficients.
+ *   @nkey, key: The key length and parameters of the last computation.
+ *   @cur, step, tgt: The current coefficients, the step per sample, and the
+ *     target coefficients.
+ */
+struct dsp_coef_t {
+	unsigned int len;
+	bool init;
+
+	unsigned int nkey;
+	double key[DSP_COEF_KEY];
+
+	double cur[DSP_COEF_MAX], step[DSP_COEF_MAX], tgt[DSP_COEF_MAX];
+};
+
+
+/**
+ * Initialize a coefficient ramp.
+ *   @len: The control period, one for audio rate.
+ *   &returns: The ramp.
+ */
+static inline struct dsp_coef_t dsp_coef_init(unsigned int len)
+{
+	return (struct dsp_coef_t){ (len > 0) ? len : 1, false, 0 };
+}
+
+/**
+ * Reset a coefficient ramp, so that the next coefficients are taken without
+ * ramping.
+ *   @coef: The ramp.
+ */
+static inline void dsp_coef_reset(struct dsp_coef_t *coef)
+{
+	coef->init = false;
+	coef->nkey = 0;
+}
+
+/**
+ * Compute the end of the control period starting at an index.
+ *   @coef: The ramp.
+ *   @i: The index.
+ *   @len: The block length.
+ *   &returns: The end index.
+ */
+static inline unsigned int dsp_coef_next(struct dsp_coef_t *coef, unsigned int i, unsigned int len)
+{
+	return ((len - i) > coef->len) ? (i + coef->len) : len;
+}
+
+/**
+ * Check if the parameters of a period match those of the last computation,
+ * recording them otherwise.
+ *   @coef: The ramp.
+ *   @key: The parameters.
+ *   @n: The number of parameters.
+ *   &returns: True if unchanged.
+ */
+static inline bool dsp_coef_key(struct dsp_coef_t *coef, const double *key, unsigned int n)
+{
+	if((coef->nkey == n) && (memcmp(coef->key, key, n * sizeof(double)) == 0))
+		return true;
+
+	coef->nkey = n;
+	memcpy(coef->key, key, n * sizeof(double));
+
+	return false;
+}
+
+/**
+ * Begin ramping towards new coefficients. The first coefficients, and every
+ * coefficient at audio rate, are taken without ramping.
+ *   @coef: The ramp.
+ *   @tgt: The target coefficients.
+ *   @n: The number of coefficients.
+ *   @len: The number of samples in the period.
+ */
+static inline void dsp_coef_ramp(struct dsp_coef_t *coef, const void *tgt, unsigned int n, unsigned int len)
+{
+	unsigned int k;
+
+	memcpy(coef->tgt, tgt, n * sizeof(double));
+
+	if(!coef->init || (len == 1)) {
+		memcpy(coef->cur, tgt, n * sizeof(double));
+		dsp_zero_d(coef->step, n);
+		coef->init = true;
+	}
+	else {
+		for(k = 0; k < n; k++)
+			coef->step[k] = (coef->tgt[k] - coef->cur[k]) / len;
+	}
+}
+
+/**
+ * Hold the target coefficients for a period with unchanged parameters.
+ *   @coef: The ramp.
+ *   @n: The number of coefficients.
+ */
+static inline void dsp_coef_hold(struct dsp_coef_t *coef, unsigned int n)
+{
+	memcpy(coef->cur, coef->tgt, n * sizeof(double));
+	dsp_zero_d(coef->step, n);
+}
+
+/**
+ * Advance the ramp by one sample.
+ *   @coef: The ramp.
+ *   @out: Out. The coefficients.
+ *   @n: The number of coefficients.
+ */
+static inline void dsp_coef_step(struct dsp_coef_t *coef, void *out, unsigned int n)
+{
+	unsigned int k;
+
+	for(k = 0; k < n; k++)
+		coef->cur[k] += coef->step[k];
+
+	memcpy(out, coef->cur, n * sizeof(double));
+}
+
+/**
+ * Process a buffer with ramped coefficients. The coefficients are computed
+ * from the parameters at the end of each control period, only if they
+ * changed, and ramped across the period. The coefficient type must fit in
+ * the ramp, which is checked at compile time.
+ *   @coef: The ramp.
+ *   @buf: The buffer, indexed by 'i'.
+ *   @len: The buffer length.
+ *   @type: The coefficient type.
+ *   @init: The coefficient initializer, given the period end 'j'.
+ *   @proc: The sample processor, given the coefficients 'c'.
+ *   @...: The parameters at the period end.
+ */
+#define dsp_coef_run(coef, buf, len, type, init, proc, ...) \
+	do { \
+		type c; \
+		unsigned int j, n = sizeof(type) / sizeof(double); \
+		_Static_assert((sizeof(type) % sizeof(double)) == 0, "Coefficients must be doubles."); \
+		_Static_assert(sizeof(type) <= (DSP_COEF_MAX * sizeof(double)), "Coefficients exceed DSP_COEF_MAX."); \
+		for(i = 0; i < (len); ) { \
+			j = dsp_coef_next(coef, i, len); \
+			double key[] = { __VA_ARGS__ }; \
+			_Static_assert(sizeof(key) <= (DSP_COEF_KEY * sizeof(double)), "Key exceeds DSP_COEF_KEY."); \
+			if(!dsp_coef_key(coef, key, sizeof(key) / sizeof(double))) { \
+				c = init; \
+				dsp_coef_ramp(coef, &c, n, j - i); \
+			} \
+			else \
+				dsp_coef_hold(coef, n); \
+			for(; i < j; i++) { \
+				dsp_coef_step(coef, &c, n); \
+				buf[i] = proc; \
+			} \
+		} \
+	} while(0)
+
+#endif
@@ -0,0 +1,444 @@
+#include "common.h"
+#ifdef __SSE2__
+#	include <emmintrin.h>
+#endif
+
+
+/**
+ * Deferred work state enumerator.
+ *   @conv_idle_v: No work.
+ *   @conv_queue_v: Queued, not yet claimed.
+ *   @conv_busy_v: Claimed and running.
+ *   @conv_step_v: Claimed by the processing thread and computed in steps.
+ *   @conv_done_v: Finished.
+ */
+enum conv_state_e {
+	conv_idle_v,
+	conv_queue_v,
+	conv_busy_v,
+	conv_step_v,
+	conv_done_v
+};
+
+
+/*
+ * local declarations
+ */
+static void conv_stage(struct dsp_conv_t *conv, unsigned int idx);
+static void conv_step(struct dsp_conv_t *conv, unsigned int idx, unsigned int step);
+static void conv_spread(struct dsp_conv_t *conv, unsigned int idx);
+static void conv_boundary(struct dsp_conv_t *conv, unsigned int idx);
+static bool conv_claim(struct dsp_convstage_t *stage, int state);
+static void conv_mac(double *acc, const double *x, const double *h, unsigned int n);
+static void conv_relax(void);
+
+
+/**
+ * Create a partitioned impulse response.
+ *   @arr: The response.
+ *   @len: The response length.
+ *   @block: The head length, a power of two no greater than the maximum
+ *     partition size.
+ *   &returns: The impulse response.
+ */
+struct dsp_ir_t *dsp_ir_new(const float *arr, unsigned int len, unsigned int block)
+{
+	unsigned int i, p, k, n, size, next, off;
+	struct dsp_ir_t *ir;
+	struct dsp_irstage_t *stage;
+
+	assert((block > 0) && ((block & (block - 1)) == 0) && (block <= DSP_CONV_MAX));
+
+	ir = malloc(sizeof(struct dsp_ir_t));
+	ir->len = len;
+	ir->block = block;
+	ir->head = malloc(block * sizeof(double));
+	ir->nstages = 0;
+	ir->stage = malloc(0);
+
+	for(i = 0; i < block; i++)
+		ir->head[i] = (i < len) ? arr[i] : 0.0;
+
+	for(size = off = block; off < len; size = next) {
+		next = m_min_u(size * DSP_CONV_RATIO, DSP_CONV_MAX);
+
+		if(next == size)
+			n = (len - off + size - 1) / size;
+		else
+			n = m_min_u((2 * next - off) / size, (len - off + size - 1) / size);
+
+		ir->stage = realloc(ir->stage, (ir->nstages + 1) * sizeof(struct dsp_irstage_t));
+		stage = &ir->stage[ir->nstages];
+		stage->size = size;
+		stage->off = off;
+		stage->npart = n;
+		stage->defer = ir->nstages > 0;
+		stage->fft = dsp_fft_new(2 * size);
+		stage->spec = malloc(n * 2 * size * sizeof(double));
+
+		for(p = 0; p < n; p++) {
+			double *spec = stage->spec + p * 2 * size;
+
+			for(k = 0; k < 2 * size; k++)
+				spec[k] = ((k < size) && ((off + p * size + k) < len)) ? arr[off + p * size + k] : 0.0;
+
+			dsp_fft_real(stage->fft, spec);
+		}
+
+		ir->nstages++;
+		off += n * size;
+	}
+
+	return ir;
+}
+
+/**
+ * Delete a partitioned impulse response.
+ *   @ir: The impulse response.
+ */
+void dsp_ir_delete(struct dsp_ir_t *ir)
+{
+	unsigned int i;
+
+	for(i = 0; i < ir->nstages; i++) {
+		dsp_fft_delete(ir->stage[i].fft);
+		free(ir->stage[i].spec);
+	}
+
+	free(ir->stage);
+	free(ir->head);
+	free(ir);
+}
+
+
+/**
+ * Create a convolution. Deferred work not offloaded to another thread is
+ * computed in steps spread over the period of its stage; offloaded work is
+ * only taken over in this way once half of the period has passed unclaimed.
+ *   @ir: The impulse response, kept for the lifetime of the convolution.
+ *   @offload: Flag indicating 'dsp_conv_work' is called from another thread.
+ *   &returns: The convolution.
+ */
+struct dsp_conv_t *dsp_conv_new(const struct dsp_ir_t *ir, bool offload)
+{
+	unsigned int i, size;
+	struct dsp_conv_t *conv;
+	struct dsp_convstage_t *stage;
+
+	conv = malloc(sizeof(struct dsp_conv_t));
+	conv->ir = ir;
+	conv->offload = offload;
+	conv->fill = 0;
+	conv->hist = malloc(2 * ir->block * sizeof(double));
+	conv->stage = malloc(ir->nstages * sizeof(struct dsp_convstage_t));
+	dsp_zero_d(conv->hist, 2 * ir->block);
+
+	for(i = 0; i < ir->nstages; i++) {
+		stage = &conv->stage[i];
+		size = ir->stage[i].size;
+
+		stage->fill = stage->pos = stage->step = 0;
+		stage->state = conv_idle_v;
+		stage->in = malloc(2 * size * sizeof(double));
+		stage->work = malloc(2 * size * sizeof(double));
+		stage->cur = malloc(size * sizeof(double));
+		stage->next = malloc(size * sizeof(double));
+		stage->fdl = malloc(ir->stage[i].npart * 2 * size * sizeof(double));
+
+		dsp_zero_d(stage->in, 2 * size);
+		dsp_zero_d(stage->cur, size);
+		dsp_zero_d(stage->fdl, ir->stage[i].npart * 2 * size);
+	}
+
+	return conv;
+}
+
+/**
+ * Delete a convolution. No deferred work may be running.
+ *   @conv: The convolution.
+ */
+void dsp_conv_delete(struct dsp_conv_t *conv)
+{
+	unsigned int i;
+
+	for(i = 0; i < conv->ir->nstages; i++) {
+		free(conv->stage[i].in);
+		free(conv->stage[i].work);
+		free(conv->stage[i].cur);
+		free(conv->stage[i].next);
+		free(conv->stage[i].fdl);
+	}
+
+	free(conv->stage);
+	free(conv->hist);
+	free(conv);
+}
+
+
+/**
+ * Process a convolution in place. Deferred stages are queued as their input
+ * completes; they are computed by 'dsp_conv_work' if called in time, and
+ * otherwise in steps over the rest of their period.
+ *   @conv: The convolution.
+ *   @buf: The buffer.
+ *   @len: The length.
+ *   &returns: True if deferred work was queued.
+ */
+bool dsp_conv_proc(struct dsp_conv_t *conv, dsp_sample_t *buf, unsigned int len)
+{
+	bool queue = false;
+	unsigned int i, j, k, n, s;
+	const struct dsp_ir_t *ir = conv->ir;
+	unsigned int block = ir->block;
+
+	for(i = 0; i < len; i += n) {
+		n = m_min_u(len - i, block - conv->fill);
+
+		for(j = 0; j < n; j++)
+			conv->hist[block + conv->fill + j] = buf[i + j];
+
+		for(s = 0; s < ir->nstages; s++) {
+			struct dsp_convstage_t *stage = &conv->stage[s];
+			double *in = stage->in + ir->stage[s].size + stage->fill;
+
+			for(j = 0; j < n; j++)
+				in[j] = buf[i + j];
+		}
+
+		for(j = 0; j < n; j++) {
+			double y = 0.0;
+			const double *x = conv->hist + block + conv->fill + j;
+
+			for(k = 0; k < block; k++)
+				y += ir->head[k] * x[-(int)k];
+
+			buf[i + j] = y;
+		}
+
+		for(s = 0; s < ir->nstages; s++) {
+			struct dsp_convstage_t *stage = &conv->stage[s];
+
+			for(j = 0; j < n; j++)
+				buf[i + j] += stage->cur[stage->fill + j];
+
+			stage->fill += n;
+			if(ir->stage[s].defer)
+				conv_spread(conv, s);
+
+			if(stage->fill == ir->stage[s].size) {
+				conv_boundary(conv, s);
+				queue |= ir->stage[s].defer;
+			}
+		}
+
+		conv->fill += n;
+		if(conv->fill == block) {
+			dsp_copy_d(conv->hist, conv->hist + block, block);
+			conv->fill = 0;
+		}
+	}
+
+	return queue;
+}
+
+/**
+ * Compute the queued deferred stages of a convolution. This function may be
+ * called from any thread, concurrently with 'dsp_conv_proc'.
+ *   @conv: The convolution.
+ */
+void dsp_conv_work(struct dsp_conv_t *conv)
+{
+	unsigned int i;
+
+	for(i = 0; i < conv->ir->nstages; i++) {
+		if(!conv_claim(&conv->stage[i], conv_busy_v))
+			continue;
+
+		conv_stage(conv, i);
+		__atomic_store_n(&conv->stage[i].state, conv_done_v, __ATOMIC_RELEASE);
+	}
+}
+
+
+/**
+ * Compute a stage from its input window into its next output.
+ *   @conv: The convolution.
+ *   @idx: The stage index.
+ */
+static void conv_stage(struct dsp_conv_t *conv, unsigned int idx)
+{
+	unsigned int k;
+
+	for(k = 0; k < conv->ir->stage[idx].npart + 2; k++)
+		conv_step(conv, idx, k);
+}
+
+/**
+ * Compute a single step of a stage. The first step transforms the input
+ * window, each partition is then accumulated in its own step, and the last
+ * step transforms the result into the next output.
+ *   @conv: The convolution.
+ *   @idx: The stage index.
+ *   @step: The step, less than two more than the number of partitions.
+ */
+static void conv_step(struct dsp_conv_t *conv, unsigned int idx, unsigned int step)
+{
+	unsigned int q;
+	struct dsp_convstage_t *stage = &conv->stage[idx];
+	const struct dsp_irstage_t *ir = &conv->ir->stage[idx];
+	unsigned int size = ir->size, npart = ir->npart;
+
+	if(step == 0) {
+		dsp_fft_real(ir->fft, stage->work);
+		memcpy(stage->fdl + stage->pos * 2 * size, stage->work, 2 * size * sizeof(double));
+		dsp_zero_d(stage->work, 2 * size);
+	}
+	else if(step <= npart) {
+		q = (stage->pos + npart - (step - 1)) % npart;
+		conv_mac(stage->work, stage->fdl + q * 2 * size, ir->spec + (step - 1) * 2 * size, size);
+	}
+	else {
+		stage->pos = (stage->pos + 1) % npart;
+
+		dsp_fft_ireal(ir->fft, stage->work);
+		memcpy(stage->next, stage->work + size, size * sizeof(double));
+	}
+}
+
+/**
+ * Compute the steps of deferred work that are due. The steps are evenly
+ * spaced so that the last is computed before the end of the period, apart
+ * from the boundary where every stage ends. Work that another thread claimed
+ * is left.
+ *   @conv: The convolution.
+ *   @idx: The stage index.
+ */
+static void conv_spread(struct dsp_conv_t *conv, unsigned int idx)
+{
+	unsigned int start, due;
+	struct dsp_convstage_t *stage = &conv->stage[idx];
+	const struct dsp_irstage_t *ir = &conv->ir->stage[idx];
+	unsigned int total = ir->npart + 2;
+
+	start = conv->offload ? (ir->size / 2) : 0;
+	if(stage->fill <= start)
+		return;
+
+	switch(__atomic_load_n(&stage->state, __ATOMIC_RELAXED)) {
+	case conv_queue_v:
+		if(!conv_claim(stage, conv_step_v))
+			return;
+
+		stage->step = 0;
+		break;
+
+	case conv_step_v:
+		break;
+
+	default:
+		return;
+	}
+
+	due = m_min_u((total + 1) * (stage->fill - start) / (ir->size - start), total);
+	while(stage->step < due)
+		conv_step(conv, idx, stage->step++);
+
+	if(stage->step == total)
+		__atomic_store_n(&stage->state, conv_done_v, __ATOMIC_RELAXED);
+}
+
+/**
+ * Handle the end of a stage period. The output computed for this period is
+ * swapped in, and the completed input window is computed, immediately for
+ * the first stage or queued for deferred stages.
+ *   @conv: The convolution.
+ *   @idx: The stage index.
+ */
+static void conv_boundary(struct dsp_conv_t *conv, unsigned int idx)
+{
+	double *swap;
+	struct dsp_convstage_t *stage = &conv->stage[idx];
+	const struct dsp_irstage_t *ir = &conv->ir->stage[idx];
+
+	if(ir->defer) {
+		if(conv_claim(stage, conv_busy_v))
+			conv_stage(conv, idx);
+		else {
+			while(__atomic_load_n(&stage->state, __ATOMIC_ACQUIRE) == conv_busy_v)
+				conv_relax();
+		}
+
+		if(__atomic_load_n(&stage->state, __ATOMIC_RELAXED) != conv_idle_v)
+			swap = stage->cur, stage->cur = stage->next, stage->next = swap;
+	}
+
+	memcpy(stage->work, stage->in, 2 * ir->size * sizeof(double));
+	memcpy(stage->in, stage->in + ir->size, ir->size * sizeof(double));
+	stage->fill = 0;
+
+	if(ir->defer)
+		__atomic_store_n(&stage->state, conv_queue_v, __ATOMIC_RELEASE);
+	else {
+		conv_stage(conv, idx);
+		swap = stage->cur, stage->cur = stage->next, stage->next = swap;
+	}
+}
+
+/**
+ * Claim the queued work of a stage.
+ *   @stage: The stage.
+ *   @state: The claimed state, either busy or step.
+ *   &returns: True if claimed.
+ */
+static bool conv_claim(struct dsp_convstage_t *stage, int state)
+{
+	int queue = conv_queue_v;
+
+	return __atomic_compare_exchange_n(&stage->state, &queue, state, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+/**
+ * Multiply and accumulate two spectra in the format of 'dsp_fft_real'.
+ *   @acc: The accumulator.
+ *   @x: The first spectrum.
+ *   @h: The second spectrum.
+ *   @n: The number of bins.
+ */
+static void conv_mac(double *acc, const double *x, const double *h, unsigned int n)
+{
+	unsigned int k = 1;
+
+	acc[0] += x[0] * h[0];
+	acc[1] += x[1] * h[1];
+
+#ifdef __SSE2__
+	for(; k < n; k++) {
+		__m128d a, b, re, im;
+
+		a = _mm_loadu_pd(x + 2 * k);
+		b = _mm_loadu_pd(h + 2 * k);
+		re = _mm_mul_pd(a, _mm_unpacklo_pd(b, b));
+		im = _mm_mul_pd(_mm_shuffle_pd(a, a, 1), _mm_unpackhi_pd(b, b));
+		im = _mm_xor_pd(im, _mm_set_pd(0.0, -0.0));
+
+		_mm_storeu_pd(acc + 2 * k, _mm_add_pd(_mm_loadu_pd(acc + 2 * k), _mm_add_pd(re, im)));
+	}
+#endif
+
+	for(; k < n; k++) {
+		acc[2 * k] += x[2 * k] * h[2 * k] - x[2 * k + 1] * h[2 * k + 1];
+		acc[2 * k + 1] += x[2 * k] * h[2 * k + 1] + x[2 * k + 1] * h[2 * k];
+	}
+}
+
+/**
+ * Relax the processor while waiting on deferred work.
+ */
+static void conv_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#else
+	__asm__ volatile("" ::: "memory");
+#endif
+}
@@ -0,0 +1,100 @@
+#ifndef CONV_H
+#define CONV_H
+
+/**
+ * Convolution definitions.
+ *   @DSP_CONV_BLOCK: The default head length in samples.
+ *   @DSP_CONV_RATIO: The ratio between the partition sizes of stages.
+ *   @DSP_CONV_MAX: The maximum partition size.
+ */
+#define DSP_CONV_BLOCK 64
+#define DSP_CONV_RATIO 8
+#define DSP_CONV_MAX 16384
+
+/**
+ * Impulse response stage structure. A stage holds the spectra of a run of
+ * equally sized partitions of the impulse response.
+ *   @size, off, npart: The partition size, the offset of the first
+ *     partition, and the number of partitions.
+ *   @defer: Flag indicating the stage is computed a period late, so that
+ *     it may run on another thread.
+ *   @fft: The FFT plan, twice the partition size.
+ *   @spec: The partition spectra.
+ */
+struct dsp_irstage_t {
+	unsigned int size, off, npart;
+	bool defer;
+
+	struct dsp_fft_t *fft;
+	double *spec;
+};
+
+/**
+ * Partitioned impulse response structure. The head of the response is
+ * convolved directly so that there is no latency, followed by stages of
+ * partitions growing by a constant ratio. Only the first stage is computed
+ * on the block in which its input completes; every later stage starts two
+ * partitions into the response, leaving a full period to compute it.
+ *   @len, block: The response length and the head length.
+ *   @head: The head of the response.
+ *   @nstages, stage: The stage array.
+ */
+struct dsp_ir_t {
+	unsigned int len, block;
+	double *head;
+
+	unsigned int nstages;
+	struct dsp_irstage_t *stage;
+};
+
+/**
+ * Convolution stage state structure.
+ *   @fill, pos, step: The samples input this period, the spectrum delay line
+ *     position, and the steps of deferred work computed in place.
+ *   @state: The state of the deferred work.
+ *   @in: The input window, twice the partition size.
+ *   @work: The working buffer, twice the partition size.
+ *   @cur, next: The output of the current period and of the next.
+ *   @fdl: The spectrum delay line.
+ */
+struct dsp_convstage_t {
+	unsigned int fill, pos, step;
+	int state;
+
+	double *in, *work, *cur, *next, *fdl;
+};
+
+/**
+ * Convolution structure.
+ *   @ir: The impulse response.
+ *   @offload: Flag indicating deferred work is expected from another thread.
+ *   @fill: The samples input this head period.
+ *   @hist: The head input history, twice the head length.
+ *   @stage: The stage state array.
+ */
+struct dsp_conv_t {
+	const struct dsp_ir_t *ir;
+	bool offload;
+
+	unsigned int fill;
+	double *hist;
+
+	struct dsp_convstage_t *stage;
+};
+
+/*
+ * impulse response declarations
+ */
+struct dsp_ir_t *dsp_ir_new(const float *arr, unsigned int len, unsigned int block);
+void dsp_ir_delete(struct dsp_ir_t *ir);
+
+/*
+ * convolution declarations
+ */
+struct dsp_conv_t *dsp_conv_new(const struct dsp_ir_t *ir, bool offload);
+void dsp_conv_delete(struct dsp_conv_t *conv);
+
+bool dsp_conv_proc(struct dsp_conv_t *conv, dsp_sample_t *buf, unsigned int len);
+void dsp_conv_work(struct dsp_conv_t *conv);
+
+#endif
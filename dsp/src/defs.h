@@ -1,4 +1,14 @@
 #ifndef DEFS_H
 #define DEFS_H
 
+/**
+ * Sample type used by signal buffers, single precision when configured with
+ * '--float'. Filter and reverb state remains double precision regardless.
+ */
+#if DSP_FLOAT
+typedef float dsp_sample_t;
+#else
+typedef double dsp_sample_t;
+#endif
+
 #endif
@@ -25,7 +25,7 @@ struct dsp_lpf_t {
  */
 static inline struct dsp_lpf_t dsp_lpf_init(double freq, double rate)
 {
-	double w = tanf(freq * M_PI / rate);
+	double w = dsp_tan_fast(freq * M_PI / rate);
 
 	return (struct dsp_lpf_t){ w };
 }
@@ -73,7 +73,7 @@ struct dsp_hpf_t {
  */
 static inline struct dsp_hpf_t dsp_hpf_init(double freq, double rate)
 {
-	double w = tanf(freq * M_PI / rate);
+	double w = dsp_tan_fast(freq * M_PI / rate);
 
 	return (struct dsp_hpf_t){ w / (1 + w) };
 }
@@ -150,7 +150,7 @@ struct dsp_moog_t {
  */
 static inline struct dsp_moog_t dsp_moog_init(double freq, double res, double rate)
 {
-	double w = tanf(freq * M_PI / rate);
+	double w = dsp_tan_fast(freq * M_PI / rate);
 
 	return (struct dsp_moog_t){ w, res };
 }
@@ -210,7 +210,7 @@ struct dsp_svf_t {
  */
 static inline struct dsp_svf_t dsp_svf_init(double freq, double res, unsigned int rate)
 {
-	double w = tanf(freq * M_PI / rate);
+	double w = dsp_tan_fast(freq * M_PI / rate);
 
 	return (struct dsp_svf_t){ w, 1.0 - res };
 }
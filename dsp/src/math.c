@@ -1 +1,68 @@
 #include "common.h"
+#ifdef __SSE2__
+#	include <emmintrin.h>
+#endif
+
+
+/*
+ * local declarations
+ */
+#ifdef __SSE2__
+static inline __m128d math_poly(__m128d x, const double *coef, unsigned int n);
+#endif
+
+
+/**
+ * Compute the exponential of an array, as by 'dsp_exp_fast'.
+ *   @out: The output array, may be the input.
+ *   @in: The input array.
+ *   @len: The length.
+ */
+void dsp_exp_v(double *out, const double *in, unsigned int len)
+{
+	unsigned int i = 0;
+
+#ifdef __SSE2__
+	static const double en[] = { 1.0 / 5040.0, 1.0 / 720.0, 1.0 / 120.0, 1.0 / 24.0, 1.0 / 6.0, 1.0 / 2.0, 1.0, 1.0 };
+	const __m128d round = _mm_set1_pd(DSP_ROUND), lo = _mm_set1_pd(-1020.0), hi = _mm_set1_pd(1020.0);
+
+	for(; (i + 2) <= len; i += 2) {
+		__m128d t, r, f;
+		__m128i b;
+
+		t = _mm_mul_pd(_mm_loadu_pd(in + i), _mm_set1_pd(M_LOG2E));
+		t = _mm_min_pd(_mm_max_pd(t, lo), hi);
+		r = _mm_add_pd(t, round);
+		f = _mm_mul_pd(_mm_sub_pd(t, _mm_sub_pd(r, round)), _mm_set1_pd(M_LN2));
+
+		b = _mm_add_epi64(_mm_castpd_si128(r), _mm_set1_epi64x(1023));
+		b = _mm_slli_epi64(b, 52);
+
+		_mm_storeu_pd(out + i, _mm_mul_pd(math_poly(f, en, 8), _mm_castsi128_pd(b)));
+	}
+#endif
+
+	for(; i < len; i++)
+		out[i] = dsp_exp_fast(in[i]);
+}
+
+
+#ifdef __SSE2__
+/**
+ * Evaluate a polynomial by Horner's method.
+ *   @x: The argument.
+ *   @coef: The coefficients, highest order first.
+ *   @n: The number of coefficients.
+ *   &returns: The value.
+ */
+static inline __m128d math_poly(__m128d x, const double *coef, unsigned int n)
+{
+	unsigned int k;
+	__m128d v = _mm_set1_pd(coef[0]);
+
+	for(k = 1; k < n; k++)
+		v = _mm_add_pd(_mm_mul_pd(v, x), _mm_set1_pd(coef[k]));
+
+	return v;
+}
+#endif
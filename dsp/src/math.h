@@ -1,6 +1,17 @@
 #ifndef MATH_H
 #define MATH_H
 
+/**
+ * Rounding constant. Adding and subtracting the constant rounds a double to
+ * the nearest integer, which is left in the low bits of the sum.
+ */
+#define DSP_ROUND 6755399441055744.0
+
+/*
+ * math declarations
+ */
+void dsp_exp_v(double *out, const double *in, unsigned int len);
+
 /**
  * Perform integer modulus with strictliy positive results.
  *   @a: The value.
@@ -47,6 +58,55 @@ static inline float dsp_pow_f(float b, float e)
 }
 
 
+/**
+ * Compute a fast tangent from a Pade approximant, reflecting arguments past
+ * a quarter turn so that the error stays below 1e-12 up to a half turn.
+ * Unlike 'tanf', the computation is branch-free and exact at zero.
+ *   @x: The argument, less than pi/2 in magnitude.
+ *   &returns: The tangent.
+ */
+static inline double dsp_tan_fast(double x)
+{
+	bool flip;
+	double a, f, f2, p, q, r;
+
+	a = (x < 0.0) ? -x : x;
+	flip = a > (M_PI / 4.0);
+	f = flip ? (M_PI_2 - a) : a;
+	f2 = f * f;
+
+	p = f * (135135.0 + f2 * (-17325.0 + f2 * (378.0 - f2)));
+	q = 135135.0 + f2 * (-62370.0 + f2 * (3150.0 - 28.0 * f2));
+	r = flip ? (q / p) : (p / q);
+
+	return (x < 0.0) ? -r : r;
+}
+
+/**
+ * Compute a fast exponential. The argument is split into a power of two and
+ * a remainder evaluated by polynomial, with a relative error below 1e-8.
+ *   @x: The argument.
+ *   &returns: The exponential.
+ */
+static inline double dsp_exp_fast(double x)
+{
+	uint64_t b;
+	double t, r, f, p, s;
+
+	t = x * M_LOG2E;
+	t = (t < -1020.0) ? -1020.0 : ((t > 1020.0) ? 1020.0 : t);
+	r = t + DSP_ROUND;
+	f = (t - (r - DSP_ROUND)) * M_LN2;
+	p = 1.0 + f * (1.0 + f * (1.0 / 2.0 + f * (1.0 / 6.0 + f * (1.0 / 24.0 + f * (1.0 / 120.0 + f * (1.0 / 720.0 + f / 5040.0))))));
+
+	memcpy(&b, &r, sizeof(double));
+	b = (b + 1023) << 52;
+	memcpy(&s, &b, sizeof(double));
+
+	return p * s;
+}
+
+
 /**
  * Convert amplitude to decibels.
  *   @amp: The amplitude value.
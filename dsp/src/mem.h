@@ -149,4 +149,103 @@ static inline void dsp_scale_d(double *buf, double fact, unsigned int len)
 		buf[i] *= fact;
 }
 
+/**
+ * Clamp a buffer of samples.
+ *   @buf: The buffer.
+ *   @len: The length.
+ */
+static inline void dsp_clamp_s(dsp_sample_t *buf, unsigned int len)
+{
+	unsigned int i;
+
+	for(i = 0; i < len; i++) {
+		if(buf[i] > 1.0)
+			buf[i] = 1.0;
+		else if(buf[i] < -1.0)
+			buf[i] = -1.0;
+	}
+}
+
+/**
+ * Zero a buffer of samples.
+ *   @buf: The buffer.
+ *   @len: The length.
+ */
+static inline void dsp_zero_s(dsp_sample_t *buf, unsigned int len)
+{
+	unsigned int i;
+
+	for(i = 0; i < len; i++)
+		buf[i] = 0.0;
+}
+
+/**
+ * Set a buffer of samples to one.
+ *   @buf: The buffer.
+ *   @len: The length.
+ */
+static inline void dsp_one_s(dsp_sample_t *buf, unsigned int len)
+{
+	unsigned int i;
+
+	for(i = 0; i < len; i++)
+		buf[i] = 1.0;
+}
+
+/**
+ * Copy a buffer of samples.
+ *   @dest: The destination.
+ *   @src: The source.
+ *   @len: The length.
+ */
+static inline void dsp_copy_s(dsp_sample_t *dest, const dsp_sample_t *src, unsigned int len)
+{
+	unsigned int i;
+
+	for(i = 0; i < len; i++)
+		dest[i] = src[i];
+}
+
+/**
+ * Add two buffers of samples.
+ *   @dest: The destination.
+ *   @src: The source.
+ *   @len: The length.
+ */
+static inline void dsp_add_s(dsp_sample_t *dest, const dsp_sample_t *src, unsigned int len)
+{
+	unsigned int i;
+
+	for(i = 0; i < len; i++)
+		dest[i] += src[i];
+}
+
+/**
+ * Multiply two buffers of samples.
+ *   @dest: The destination.
+ *   @src: The source.
+ *   @len: The length.
+ */
+static inline void dsp_mul_s(dsp_sample_t *dest, const dsp_sample_t *src, unsigned int len)
+{
+	unsigned int i;
+
+	for(i = 0; i < len; i++)
+		dest[i] *= src[i];
+}
+
+/**
+ * Scale a buffer of samples.
+ *   @buf: The buffer.
+ *   @fact: The scaling factoring.
+ *   @len: The length.
+ */
+static inline void dsp_scale_s(dsp_sample_t *buf, double fact, unsigned int len)
+{
+	unsigned int i;
+
+	for(i = 0; i < len; i++)
+		buf[i] *= fact;
+}
+
 #endif
@@ -1 +1,208 @@
 #include "common.h"
+#ifdef __SSE2__
+#	include <emmintrin.h>
+#endif
+
+
+/*
+ * local declarations
+ */
+static unsigned int fdn_prime(unsigned int val);
+static double fdn_mix(struct dsp_fdn_t *fdn, double *row, double x);
+
+
+/**
+ * Create a feedback delay network. The line lengths are distinct primes
+ * spread geometrically over the upper octave below the given length. Each
+ * line's low-pass filter attenuates the damping frequency by the line's
+ * decay gain on top of that gain, so the decay time at the damping
+ * frequency is half the decay time at low frequencies for every line.
+ *   @n: The number of lines, at most 'DSP_FDN_MAX'.
+ *   @len: The length of the longest line.
+ *   @decay: The time to decay by 60dB in seconds.
+ *   @freq: The damping frequency, below the Nyquist frequency.
+ *   @rate: The sample rate.
+ *   &returns: The network.
+ */
+struct dsp_fdn_t *dsp_fdn_new(unsigned int n, unsigned int len, double decay, double freq, double rate)
+{
+	unsigned int k, sum = 0, prev = 1, size[DSP_FDN_MAX];
+	double g, w;
+	struct dsp_fdn_t *fdn;
+
+	assert((n > 0) && (n <= DSP_FDN_MAX));
+
+	for(k = 0; k < n; k++) {
+		prev = size[k] = fdn_prime(m_max_u(lrint(len * pow(2.0, -(double)(n - 1 - k) / n)), prev + 1));
+		sum += size[k];
+	}
+
+	fdn = malloc(sizeof(struct dsp_fdn_t) + sum * sizeof(double));
+	fdn->n = n;
+	fdn->min = size[0];
+	fdn->max = size[n - 1];
+	fdn->quiet = fdn->max;
+	w = dsp_lpf_init(freq, rate).g;
+
+	for(sum = k = 0; k < n; k++) {
+		fdn->len[k] = size[k];
+		fdn->idx[k] = 0;
+		fdn->line[k] = fdn->arr + sum;
+		fdn->gain[k] = g = pow(10.0, -3.0 * size[k] / (decay * rate));
+		fdn->damp[k] = w / (w + sqrt(1.0 / (g * g) - 1.0));
+		fdn->in[k] = ((k & 1) ? -1.0 : 1.0) / sqrt(n);
+		fdn->out[k] = (k & 2) ? -1.0 : 1.0;
+		fdn->s[k] = 0.0;
+
+		sum += size[k];
+	}
+
+	dsp_zero_d(fdn->arr, sum);
+
+	return fdn;
+}
+
+/**
+ * Delete a feedback delay network.
+ *   @fdn: The network.
+ */
+void dsp_fdn_delete(struct dsp_fdn_t *fdn)
+{
+	free(fdn);
+}
+
+
+/**
+ * Process a feedback delay network in place. Samples are processed in runs
+ * no longer than the shortest line, so that every line is read as one or two
+ * contiguous spans before any sample of the run is written back.
+ *   @fdn: The network.
+ *   @buf: The buffer.
+ *   @len: The length.
+ *   &returns: True until every line only holds values below 'DSP_FDN_QUIET'.
+ */
+bool dsp_fdn_proc(struct dsp_fdn_t *fdn, dsp_sample_t *buf, unsigned int len)
+{
+	unsigned int i, j, k, m, idx, n = fdn->n;
+	double peak, row[DSP_FDN_BLOCK * DSP_FDN_MAX];
+
+	for(i = 0; i < len; i += m) {
+		m = m_min_u(m_min_u(len - i, DSP_FDN_BLOCK), fdn->min);
+
+		for(k = 0; k < n; k++) {
+			const double *line = fdn->line[k];
+
+			for(idx = fdn->idx[k], j = 0; j < m; j++) {
+				row[j * n + k] = line[idx];
+				if(++idx == fdn->len[k])
+					idx = 0;
+			}
+		}
+
+		for(j = 0; j < m; j++)
+			buf[i + j] = fdn_mix(fdn, row + j * n, buf[i + j]);
+
+		for(peak = 0.0, j = 0; j < (m * n); j++)
+			peak = fmax(peak, fabs(row[j]));
+
+		fdn->quiet = (peak > DSP_FDN_QUIET) ? 0 : m_min_u(fdn->quiet + m, fdn->max);
+
+		for(k = 0; k < n; k++) {
+			double *line = fdn->line[k];
+
+			for(idx = fdn->idx[k], j = 0; j < m; j++) {
+				line[idx] = row[j * n + k];
+				if(++idx == fdn->len[k])
+					idx = 0;
+			}
+
+			fdn->idx[k] = idx;
+		}
+	}
+
+	return fdn->quiet < fdn->max;
+}
+
+
+/**
+ * Find the smallest prime no less than a value.
+ *   @val: The value.
+ *   &returns: The prime.
+ */
+static unsigned int fdn_prime(unsigned int val)
+{
+	unsigned int d;
+
+	for(val = m_max_u(val, 2); ; val++) {
+		for(d = 2; (d * d) <= val; d++) {
+			if((val % d) == 0)
+				break;
+		}
+
+		if((d * d) > val)
+			return val;
+	}
+}
+
+/**
+ * Mix one sample of a feedback delay network. The row holds the output of
+ * every line on input, and the values to write back on return.
+ *   @fdn: The network.
+ *   @row: The row.
+ *   @x: The input.
+ *   &returns: The output.
+ */
+static double fdn_mix(struct dsp_fdn_t *fdn, double *row, double x)
+{
+	unsigned int k = 0, n = fdn->n;
+	double v, d, c, sum = 0.0, y = 0.0;
+
+#ifdef __SSE2__
+	__m128d vv, vd, vc, vx, vsum, vy;
+
+	vsum = vy = _mm_setzero_pd();
+
+	for(; (k + 2) <= n; k += 2) {
+		vv = _mm_mul_pd(_mm_loadu_pd(fdn->gain + k), _mm_loadu_pd(row + k));
+		vd = _mm_mul_pd(_mm_sub_pd(vv, _mm_loadu_pd(fdn->s + k)), _mm_loadu_pd(fdn->damp + k));
+		vv = _mm_add_pd(vd, _mm_loadu_pd(fdn->s + k));
+		_mm_storeu_pd(fdn->s + k, _mm_add_pd(vv, vd));
+		_mm_storeu_pd(row + k, vv);
+
+		vsum = _mm_add_pd(vsum, vv);
+		vy = _mm_add_pd(vy, _mm_mul_pd(_mm_loadu_pd(fdn->out + k), vv));
+	}
+
+	vsum = _mm_add_sd(vsum, _mm_unpackhi_pd(vsum, vsum));
+	vy = _mm_add_sd(vy, _mm_unpackhi_pd(vy, vy));
+	sum = _mm_cvtsd_f64(vsum);
+	y = _mm_cvtsd_f64(vy);
+#endif
+
+	for(; k < n; k++) {
+		v = fdn->gain[k] * row[k];
+		d = (v - fdn->s[k]) * fdn->damp[k];
+		v = d + fdn->s[k];
+		fdn->s[k] = v + d;
+		row[k] = v;
+
+		sum += v;
+		y += fdn->out[k] * v;
+	}
+
+	c = -2.0 * sum / n;
+	k = 0;
+
+#ifdef __SSE2__
+	vc = _mm_set1_pd(c);
+	vx = _mm_set1_pd(x);
+
+	for(; (k + 2) <= n; k += 2)
+		_mm_storeu_pd(row + k, _mm_add_pd(_mm_add_pd(_mm_loadu_pd(row + k), vc), _mm_mul_pd(_mm_loadu_pd(fdn->in + k), vx)));
+#endif
+
+	for(; k < n; k++)
+		row[k] += c + fdn->in[k] * x;
+
+	return y;
+}
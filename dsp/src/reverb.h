@@ -191,4 +191,46 @@ static inline double dsp_reverb_rescf(double x, struct dsp_ring_t *ring, double
 	return v;
 }
 
+
+/**
+ * Feedback delay network definitions.
+ *   @DSP_FDN_MAX: The maximum number of delay lines.
+ *   @DSP_FDN_BLOCK: The maximum number of samples processed per pass.
+ */
+#define DSP_FDN_MAX 16
+#define DSP_FDN_BLOCK 64
+#define DSP_FDN_QUIET 1e-5
+
+/**
+ * Feedback delay network structure. Every delay line is kept in one
+ * allocation following the structure, and the lines are mixed through a
+ * Householder matrix with a one-pole low-pass filter on each line.
+ *   @n, min, max: The number of lines and the shortest and longest line
+ *     lengths.
+ *   @quiet: The number of samples since a value above 'DSP_FDN_QUIET' was
+ *     written to a line.
+ *   @len, idx: The length and index of each line.
+ *   @line: The delay lines.
+ *   @gain, damp, in, out, s: The decay gain, low-pass coefficient, input
+ *     gain, output gain and filter state of each line.
+ *   @arr: The delay line storage.
+ */
+struct dsp_fdn_t {
+	unsigned int n, min, max, quiet;
+
+	unsigned int len[DSP_FDN_MAX], idx[DSP_FDN_MAX];
+	double *line[DSP_FDN_MAX];
+	double gain[DSP_FDN_MAX], damp[DSP_FDN_MAX], in[DSP_FDN_MAX], out[DSP_FDN_MAX], s[DSP_FDN_MAX];
+
+	double arr[];
+};
+
+/*
+ * feedback delay network declarations
+ */
+struct dsp_fdn_t *dsp_fdn_new(unsigned int n, unsigned int len, double decay, double freq, double rate);
+void dsp_fdn_delete(struct dsp_fdn_t *fdn);
+
+bool dsp_fdn_proc(struct dsp_fdn_t *fdn, dsp_sample_t *buf, unsigned int len);
+
 #endif
@@ -0,0 +1,133 @@
+#include "common.h"
+
+
+/*
+ * local declarations
+ */
+static double sinc_bessel(double x);
+
+/**
+ * Quality table, indexed by the quality level.
+ *   @ntaps: The base number of taps.
+ *   @beta: The Kaiser window parameter.
+ *   @pass: The passband as a fraction of the Nyquist frequency.
+ */
+static const struct {
+	unsigned int ntaps;
+	double beta, pass;
+} sinc_qual[] = {
+	{ 0, 0.0, 0.0 },
+	{ 8, 5.0, 0.75 },
+	{ 16, 6.5, 0.85 },
+	{ 32, 8.6, 0.90 },
+};
+
+
+/**
+ * Create a resampler table. When downsampling, the cutoff is lowered and the
+ * number of taps raised in proportion, up to the maximum.
+ *   @quality: The quality level.
+ *   @ratio: The ratio of the input rate to the output rate.
+ *   &returns: The table, or null for linear interpolation.
+ */
+struct dsp_sinc_t *dsp_sinc_new(unsigned int quality, double ratio)
+{
+	double fc, d, h, w, sum, row[DSP_SINC_MAX];
+	unsigned int k, p, ntaps;
+	struct dsp_sinc_t *sinc;
+
+	if(quality == DSP_SINC_LINEAR)
+		return NULL;
+
+	if(quality > DSP_SINC_HIGH)
+		quality = DSP_SINC_HIGH;
+
+	ntaps = ceil(sinc_qual[quality].ntaps * fmax(ratio, 1.0));
+	ntaps = m_min_u((ntaps + 7) & ~7, DSP_SINC_MAX);
+	fc = 0.5 * sinc_qual[quality].pass / fmax(ratio, 1.0);
+
+	sinc = malloc(sizeof(struct dsp_sinc_t) + (DSP_SINC_PHASE + 1) * ntaps * sizeof(float));
+	sinc->ntaps = ntaps;
+	sinc->ratio = ratio;
+
+	for(p = 0; p <= DSP_SINC_PHASE; p++) {
+		sum = 0.0;
+
+		for(k = 0; k < ntaps; k++) {
+			d = (double)k - (double)(ntaps / 2 - 1) - (double)p / DSP_SINC_PHASE;
+			h = (d == 0.0) ? (2.0 * fc) : (sin(2.0 * M_PI * fc * d) / (M_PI * d));
+			w = 1.0 - (d * d) / ((ntaps / 2) * (ntaps / 2));
+			w = sinc_bessel(sinc_qual[quality].beta * sqrt(fmax(w, 0.0))) / sinc_bessel(sinc_qual[quality].beta);
+
+			sum += row[k] = h * w;
+		}
+
+		for(k = 0; k < ntaps; k++)
+			sinc->coef[p * ntaps + k] = row[k] / sum;
+	}
+
+	return sinc;
+}
+
+/**
+ * Delete a resampler table.
+ *   @sinc: The table.
+ */
+void dsp_sinc_delete(struct dsp_sinc_t *sinc)
+{
+	free(sinc);
+}
+
+
+/**
+ * Resample a buffer. The output is aligned with the input, and inputs past
+ * either end are taken as zero.
+ *   @sinc: The table.
+ *   @out: The output.
+ *   @outlen: The output length.
+ *   @in: The input.
+ *   @inlen: The input length.
+ */
+void dsp_sinc_proc(const struct dsp_sinc_t *sinc, float *out, unsigned int outlen, const float *in, unsigned int inlen)
+{
+	int j, m;
+	double t;
+	unsigned int i, k, n = sinc->ntaps;
+	float x[DSP_SINC_MAX];
+
+	for(i = 0; i < outlen; i++) {
+		t = i * sinc->ratio;
+		m = floor(t);
+		j = m - (int)dsp_sinc_delay(sinc);
+
+		if((j >= 0) && ((j + n) <= inlen)) {
+			out[i] = dsp_sinc_eval(sinc, in + j, t - m);
+
+			continue;
+		}
+
+		for(k = 0; k < n; k++)
+			x[k] = ((j + (int)k >= 0) && (j + k < inlen)) ? in[j + k] : 0.0f;
+
+		out[i] = dsp_sinc_eval(sinc, x, t - m);
+	}
+}
+
+
+/**
+ * Compute the zeroth order modified Bessel function of the first kind.
+ *   @x: The input.
+ *   &returns: The value.
+ */
+static double sinc_bessel(double x)
+{
+	unsigned int k;
+	double term = 1.0, sum = 1.0;
+
+	for(k = 1; term > 1e-12 * sum; k++) {
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+	}
+
+	return sum;
+}
@@ -0,0 +1,104 @@
+#ifndef SINC_H
+#define SINC_H
+
+#ifdef __SSE2__
+#	include <emmintrin.h>
+#endif
+
+/**
+ * Resampling quality levels.
+ *   @DSP_SINC_LINEAR: Linear interpolation without a table.
+ *   @DSP_SINC_LOW: Windowed sinc over 8 taps.
+ *   @DSP_SINC_MED: Windowed sinc over 16 taps.
+ *   @DSP_SINC_HIGH: Windowed sinc over 32 taps.
+ */
+#define DSP_SINC_LINEAR 0
+#define DSP_SINC_LOW    1
+#define DSP_SINC_MED    2
+#define DSP_SINC_HIGH   3
+
+/**
+ * Resampler definitions.
+ *   @DSP_SINC_MAX: The maximum number of taps.
+ *   @DSP_SINC_PHASE: The number of phases in a table.
+ */
+#define DSP_SINC_MAX   64
+#define DSP_SINC_PHASE 256
+
+/**
+ * Polyphase windowed sinc table. Row 'p' holds the taps for an output
+ * 'p/DSP_SINC_PHASE' of the way between two inputs; there is one more row
+ * than phases so that neighbouring rows can always be interpolated.
+ *   @ntaps: The number of taps, a multiple of eight.
+ *   @ratio: The ratio of the input rate to the output rate.
+ *   @coef: The coefficient table.
+ */
+struct dsp_sinc_t {
+	unsigned int ntaps;
+	double ratio;
+	float coef[];
+};
+
+/*
+ * resampler declarations
+ */
+struct dsp_sinc_t *dsp_sinc_new(unsigned int quality, double ratio);
+void dsp_sinc_delete(struct dsp_sinc_t *sinc);
+
+void dsp_sinc_proc(const struct dsp_sinc_t *sinc, float *out, unsigned int outlen, const float *in, unsigned int inlen);
+
+/**
+ * Compute the delay of a resampler in input samples. Evaluating a window of
+ * 'ntaps' inputs produces the output between the inputs at this many and one
+ * more than this many from the start of the window.
+ *   @sinc: The resampler.
+ *   &returns: The delay.
+ */
+static inline unsigned int dsp_sinc_delay(const struct dsp_sinc_t *sinc)
+{
+	return sinc->ntaps / 2 - 1;
+}
+
+/**
+ * Evaluate a resampler over a window of inputs. The coefficients are
+ * interpolated between the two nearest phases.
+ *   @sinc: The table.
+ *   @x: The window of 'ntaps' inputs, oldest first.
+ *   @frac: The position between the inputs at the delay, from zero to one.
+ *   &returns: The output.
+ */
+static inline float dsp_sinc_eval(const struct dsp_sinc_t *sinc, const float *x, float frac)
+{
+	unsigned int k, p, n = sinc->ntaps;
+	const float *c0, *c1;
+	float a, v = 0.0f;
+
+	a = frac * DSP_SINC_PHASE;
+	p = m_min_u(a, DSP_SINC_PHASE - 1);
+	a -= p;
+
+	c0 = sinc->coef + p * n;
+	c1 = c0 + n;
+
+#ifdef __SSE2__
+	__m128 sum = _mm_setzero_ps(), wt = _mm_set1_ps(a);
+
+	for(k = 0; k < n; k += 4) {
+		__m128 lo = _mm_loadu_ps(c0 + k), hi = _mm_loadu_ps(c1 + k);
+		__m128 c = _mm_add_ps(lo, _mm_mul_ps(wt, _mm_sub_ps(hi, lo)));
+
+		sum = _mm_add_ps(sum, _mm_mul_ps(c, _mm_loadu_ps(x + k)));
+	}
+
+	sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+	sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+	v = _mm_cvtss_f32(sum);
+#else
+	for(k = 0; k < n; k++)
+		v += (c0[k] + a * (c1[k] - c0[k])) * x[k];
+#endif
+
+	return v;
+}
+
+#endif
@@ -226,7 +226,7 @@ static bool web_handler(const char *path, struct http_args_t *args, void *arg)
 		for(inst = avltree_first(&web->tree); inst != NULL; inst = avltree_next(inst)) {
 			struct perf_inst_t *cur = inst->val;
 
-			hprintf(args->file, "cur: %s  .... val %.3f\n", cur->id, amp_perf_ave(&cur->amp));
+			hprintf(args->file, "cur: %s  .... val %.3f  worst %luus\n", cur->id, amp_perf_ave(&cur->amp), (unsigned long)amp_perf_worst(&cur->amp));
 		}
 	}
 	else if(strcmp(path, "/json") == 0) {
@@ -84,7 +84,7 @@ void web_audit_info(struct web_audit_t *audit, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool web_audit_proc(struct web_audit_t *audit, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool web_audit_proc(struct web_audit_t *audit, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	//static int a = 0;
 
@@ -63,7 +63,7 @@ void web_loop_info(struct web_loop_t *loop, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool web_loop_proc(struct web_loop_t *loop, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool web_loop_proc(struct web_loop_t *loop, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 
 	return false;
@@ -115,7 +115,7 @@ void web_mulrec_info(struct web_mulrec_t *rec, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool web_mulrec_proc(struct web_mulrec_t *rec, double **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool web_mulrec_proc(struct web_mulrec_t *rec, dsp_sample_t **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	return false;
 }
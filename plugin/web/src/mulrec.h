@@ -10,7 +10,7 @@ struct web_mulrec_t *web_mulrec_new(const char *id);
 void web_mulrec_delete(struct web_mulrec_t *rec);
 
 void web_mulrec_info(struct web_mulrec_t *rec, struct amp_info_t info);
-bool web_mulrec_proc(struct web_mulrec_t *rec, double **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool web_mulrec_proc(struct web_mulrec_t *rec, dsp_sample_t **buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 void web_mulrec_print(struct web_mulrec_t *rec, struct io_file_t file);
 
@@ -1,6 +1,12 @@
 #include "common.h"
 
 
+/**
+ * Time in microseconds after the last profiler request before the profiler
+ * is disabled.
+ */
+#define WEB_PROF_TIMEOUT 10000000
+
 /**
  * Instance data union.
  *   @audit: Audit.
@@ -64,6 +70,9 @@ static bool req_init(struct web_serv_t *serv, struct http_args_t *args);
 static bool req_get(struct web_serv_t *serv, struct web_client_t *client, struct http_args_t *args);
 static bool req_put(struct web_serv_t *serv, struct http_args_t *args, struct json_t *json);
 static bool req_time(struct web_serv_t *serv, struct http_args_t *args, struct json_obj_t *obj);
+static bool req_prof(struct web_serv_t *serv, struct http_args_t *args);
+static bool req_unprof(struct web_serv_t *serv, struct http_args_t *args);
+static void prof_watch(sys_fd_t fd, void *arg);
 
 static struct http_asset_t serv_assets[] = {
 	{  "/",               "index.xhtml",    "application/xhtml+xml;charset=utf-8"   },
@@ -115,6 +124,10 @@ struct web_serv_t *web_serv_new(struct amp_rt_t *rt)
 
 	serv->client = NULL;
 
+	serv->prof = false;
+	serv->tm = 0;
+	serv->watch = sys_task_new(prof_watch, serv);
+
 	return serv;
 }
 
@@ -125,6 +138,7 @@ struct web_serv_t *web_serv_new(struct amp_rt_t *rt)
 void web_serv_delete(struct web_serv_t *serv)
 {
 	sys_task_delete(serv->task);
+	sys_task_delete(serv->watch);
 	sys_mutex_destroy(&serv->sync);
 	sys_mutex_destroy(&serv->lock);
 	web_client_destroy(serv->client);
@@ -391,7 +405,7 @@ void web_inst_info(struct web_inst_t *inst, struct amp_info_t info)
  *   @queue: The action queue.
  *   &returns: The continuation flag.
  */
-bool web_inst_effect(struct web_inst_t *inst, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
+bool web_inst_effect(struct web_inst_t *inst, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue)
 {
 	bool cont;
 
@@ -566,6 +580,10 @@ static bool req_handler(const char *path, struct http_args_t *args, void *arg)
 
 		return suc;
 	}
+	else if(strcmp(path, "/prof") == 0)
+		return req_prof(serv, args);
+	else if(strcmp(path, "/prof/stop") == 0)
+		return req_unprof(serv, args);
 	else
 		return false;
 }
@@ -583,11 +601,11 @@ static bool req_init(struct web_serv_t *serv, struct http_args_t *args)
 	struct web_inst_t *inst;
 
 	run = amp_rt_status(serv->rt) ? "true" : "false";
-	amp_clock_info(serv->rt->engine->clock, amp_info_loc(&loc));
+	loc = amp_rt_loc(serv->rt);
 
 	hprintf(args->file, "{\"client\":%u,\"data\":[", web_client_add(&serv->client));
 
-	hprintf(args->file, "{\"id\":\"Time\",\"type\":\"time\",\"data\":{\"run\":%s,\"loc\":{\"bar\":%d,\"beat\":%.8f}}}", run, loc.bar, loc.beat);
+	hprintf(args->file, "{\"id\":\"Time\",\"type\":\"time\",\"data\":{\"run\":%s,\"loc\":{\"bar\":%d,\"beat\":%.8f},\"lost\":%lu}}", run, loc.bar, loc.beat, (unsigned long)amp_rt_lost(serv->rt));
 
 	for(inst = web_inst_first(web_serv); inst != NULL; inst = web_inst_next(inst))
 		hprintf(args->file, ",{\"id\":\"%s\",\"type\":\"%s\",\"data\":%C}", inst->id, web_inst_type(inst->type), web_inst_chunk(inst));
@@ -614,9 +632,9 @@ static bool req_get(struct web_serv_t *serv, struct web_client_t *client, struct
 	struct web_msg_t **msg, *cur;
 
 	run = amp_rt_status(serv->rt) ? "true" : "false";
-	amp_clock_info(serv->rt->engine->clock, amp_info_loc(&loc));
+	loc = amp_rt_loc(serv->rt);
 
-	hprintf(args->file, "[{ \"run\": %s, \"loc\": { \"bar\": %d, \"beat\": %.8f } }", run, loc.bar, loc.beat);
+	hprintf(args->file, "[{ \"run\": %s, \"loc\": { \"bar\": %d, \"beat\": %.8f }, \"lost\": %lu }", run, loc.bar, loc.beat, (unsigned long)amp_rt_lost(serv->rt));
 
 	for(inst = web_inst_first(web_serv), idx = 1; inst != NULL; inst = web_inst_next(inst), idx++) {
 		bool comma = false;
@@ -726,3 +744,86 @@ static bool req_time(struct web_serv_t *serv, struct http_args_t *args, struct j
 
 	return true;
 }
+
+/**
+ * Process a profiler request. The profiler is enabled by the first request,
+ * and remains enabled until stopped or until no request arrives for
+ * 'WEB_PROF_TIMEOUT'.
+ *   @serv: The server.
+ *   @args: The arguments.
+ *   &returns: True if handled.
+ */
+static bool req_prof(struct web_serv_t *serv, struct http_args_t *args)
+{
+	unsigned int i, n;
+	struct amp_prof_stat_t *stat;
+	struct amp_core_t *core = serv->rt->engine->core;
+
+	sys_mutex_lock(&serv->sync);
+
+	if(!amp_prof_enabled(core->prof)) {
+		amp_prof_enable(core->prof, true);
+		serv->prof = true;
+	}
+
+	serv->tm = sys_utime();
+	sys_mutex_unlock(&serv->sync);
+
+	n = amp_prof_stat(core->prof, &stat);
+
+	hprintf(args->file, "{\"rate\":%u,\"lost\":%lu,\"underrun\":%lu,\"nodes\":[", amp_core_rate(core->env), (unsigned long)amp_prof_lost(core->prof), (unsigned long)amp_io_underrun(core->io));
+
+	for(i = 0; i < n; i++)
+		hprintf(args->file, "%s{\"name\":\"%s\",\"ref\":\"%p\",\"len\":%u,\"count\":%u,\"mean\":%.3f,\"p99\":%.3f,\"worst\":%.3f,\"total\":%.3f}", (i > 0) ? "," : "", stat[i].name, stat[i].ref, stat[i].len, stat[i].cnt, stat[i].mean, stat[i].p99, stat[i].worst, stat[i].total);
+
+	hprintf(args->file, "]}");
+	http_head_add(&args->resp, "Content-Type", "application/json");
+	free(stat);
+
+	return true;
+}
+
+/**
+ * Process a profiler stop request. The profiler is only disabled if it was
+ * enabled by the server.
+ *   @serv: The server.
+ *   @args: The arguments.
+ *   &returns: True if handled.
+ */
+static bool req_unprof(struct web_serv_t *serv, struct http_args_t *args)
+{
+	sys_mutex_lock(&serv->sync);
+
+	if(serv->prof) {
+		amp_prof_enable(serv->rt->engine->core->prof, false);
+		serv->prof = false;
+	}
+
+	sys_mutex_unlock(&serv->sync);
+
+	hprintf(args->file, "ok");
+
+	return true;
+}
+
+/**
+ * Profiler watchdog task. The profiler enabled by the server is disabled once
+ * no request has arrived for 'WEB_PROF_TIMEOUT'.
+ *   @fd: The termination file descriptor.
+ *   @arg: The server.
+ */
+static void prof_watch(sys_fd_t fd, void *arg)
+{
+	struct web_serv_t *serv = arg;
+
+	while(sys_poll1(fd, sys_poll_in_e, 1000) == 0) {
+		sys_mutex_lock(&serv->sync);
+
+		if(serv->prof && ((sys_utime() - serv->tm) > WEB_PROF_TIMEOUT)) {
+			amp_prof_enable(serv->rt->engine->core->prof, false);
+			serv->prof = false;
+		}
+
+		sys_mutex_unlock(&serv->sync);
+	}
+}
@@ -22,6 +22,9 @@ enum web_inst_e {
  *   @task: The http task.
  *   @inst: The instance tree.
  *   @client: The client list.
+ *   @prof, tm: Flag indicating the server enabled the profiler, and the time
+ *     of the last profiler request.
+ *   @watch: The profiler watchdog task.
  */
 struct web_serv_t {
 	struct amp_rt_t *rt;
@@ -31,6 +34,10 @@ struct web_serv_t {
 	struct avltree_root_t inst;
 
 	struct web_client_t *client;
+
+	bool prof;
+	int64_t tm;
+	struct sys_task_t *watch;
 };
 
 
@@ -62,7 +69,7 @@ struct web_inst_t *web_inst_ref(struct web_inst_t *inst);
 void web_inst_unref(struct web_inst_t *inst);
 
 void web_inst_info(struct web_inst_t *inst, struct amp_info_t info);
-bool web_inst_effect(struct web_inst_t *inst, double *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
+bool web_inst_effect(struct web_inst_t *inst, dsp_sample_t *buf, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 bool web_inst_seq(struct web_inst_t *inst, struct amp_time_t *time, unsigned int len, struct amp_queue_t *queue);
 
 const char *web_inst_type(enum web_inst_e type);
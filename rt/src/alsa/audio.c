@@ -3,15 +3,20 @@
 #include <pthread.h>
 #include "../common.h"
 
+#ifdef __SSE2__
+#	include <emmintrin.h>
+#endif
+
 
 /**
  * Audio configuration structure.
  *   @name, hack: The name and hack.
  *   @rate, in, out, period, nperiod: The stream parameters.
+ *   @mmap: Use memory mapped access.
  */
 struct alsa_conf_t {
 	char name[32], hack[32];
-	unsigned int rate, in, out, period, nperiod;
+	unsigned int rate, in, out, period, nperiod, mmap;
 };
 
 /**
@@ -48,6 +53,10 @@ static void audio_conf(struct alsa_conf_t *conf, const char *str);
 
 static void pcm_conf(snd_pcm_t *pcm, snd_pcm_stream_t stream, const struct alsa_conf_t *conf, snd_pcm_format_t *format);
 static void *pcm_thread(void *arg);
+static void *pcm_mmap(void *arg);
+static bool pcm_mmap_read(struct alsa_audio_t *audio, double **buf);
+static bool pcm_mmap_write(struct alsa_audio_t *audio, double **buf);
+static bool pcm_mmap_avail(snd_pcm_t *pcm, const struct alsa_conf_t *conf);
 static void pcm_prepare(struct alsa_audio_t *audio, void *raw);
 static void pcm_drop(struct alsa_audio_t *device);
 static unsigned short pcm_size(snd_pcm_format_t format);
@@ -55,6 +64,11 @@ static unsigned short pcm_size(snd_pcm_format_t format);
 static void pcm2float(double **restrict data, const uint8_t *restrict raw, snd_pcm_format_t format, unsigned int count, unsigned int chancnt);
 static void float2pcm(uint8_t *restrict raw, double **restrict data, snd_pcm_format_t format, unsigned int count, unsigned int chancnt);
 
+static void s16_to_d2(double *restrict left, double *restrict right, const int16_t *restrict ptr, unsigned int count, double scale);
+static void s32_to_d2(double *restrict left, double *restrict right, const int32_t *restrict ptr, unsigned int count, unsigned int shift, double scale);
+static void d2_to_s16(int16_t *restrict ptr, const double *restrict left, const double *restrict right, unsigned int count, double scale);
+static void d2_to_s32(int32_t *restrict ptr, const double *restrict left, const double *restrict right, unsigned int count, double scale);
+
 /*
  * global variables.
  */
@@ -197,6 +211,7 @@ static void audio_conf(struct alsa_conf_t *conf, const char *str)
 	conf->out = 2;
 	conf->period = 256;
 	conf->nperiod = 3;
+	conf->mmap = 0;
 
 	while(true) {
 		long val;
@@ -219,6 +234,7 @@ static void audio_conf(struct alsa_conf_t *conf, const char *str)
 			case 'o': param = &conf->out; break;
 			case 'p': param = &conf->period; break;
 			case 'n': param = &conf->nperiod; break;
+			case 'm': param = &conf->mmap; break;
 			default: fprintf(stderr, "Invalid ALSA option '%c'.\n", *str), exit(1);
 			}
 
@@ -250,8 +266,6 @@ static void audio_conf(struct alsa_conf_t *conf, const char *str)
 void alsa_audio_exec(struct alsa_audio_t *audio, amp_audio_f func, void *arg)
 {
 	int err;
-	pthread_attr_t attr;
-	struct sched_param param;
 
 	if(audio->conf.hack[0] != '\0') {
 #if PULSE
@@ -276,34 +290,9 @@ void alsa_audio_exec(struct alsa_audio_t *audio, amp_audio_f func, void *arg)
 	if(pipe(audio->pipe) < 0)
 		fprintf(stderr, "Failed to create synchronization pipe. %s.\n", strerror(errno)), exit(1);
 
-	err = pthread_attr_init(&attr);
-	if(err != 0)
-		fprintf(stderr, "Failed to initialize thread attributes. %s.\n", strerror(err)), exit(1);
-
-	err = pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
-	if(err != 0)
-		fprintf(stderr, "Failed to set schedular inheritance. %s.\n", strerror(err)), exit(1);
-
-	err = pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
-	if(err != 0)
-		fprintf(stderr, "Failed to set schedular policy. %s.\n", strerror(err)), exit(1);
-
-	param.sched_priority = 99;
-	err = pthread_attr_setschedparam(&attr, &param);
-	if(err != 0)
-		fprintf(stderr, "Failed to set schedular parameter. %s.\n", strerror(err)), exit(1);
-
-	err = pthread_create(&audio->thread, &attr, pcm_thread, audio);
-	if(err != 0) {
-		printf("no RT\n");
-		err = pthread_create(&audio->thread, NULL, pcm_thread, audio);
-		if(err != 0)
-			fprintf(stderr, "Failed to start thread. %s.\n", strerror(err)), exit(1);
-	}
-
-	pthread_attr_destroy(&attr);
+	err = pthread_create(&audio->thread, NULL, audio->conf.mmap ? pcm_mmap : pcm_thread, audio);
 	if(err != 0)
-		fprintf(stderr, "Failed to destroy thread attributes. %s.\n", strerror(err)), exit(1);
+		fprintf(stderr, "Failed to start thread. %s.\n", strerror(err)), exit(1);
 }
 
 /**
@@ -395,9 +384,9 @@ static void pcm_conf(snd_pcm_t *pcm, snd_pcm_stream_t stream, const struct alsa_
 		fprintf(stderr, "Failed find appropriate hardware format. %s.\n", snd_strerror(err)), exit(1);
 
 	*format = formatlist[i];
-	err = snd_pcm_hw_params_set_access(pcm, hw_params, SND_PCM_ACCESS_RW_INTERLEAVED);
+	err = snd_pcm_hw_params_set_access(pcm, hw_params, conf->mmap ? SND_PCM_ACCESS_MMAP_INTERLEAVED : SND_PCM_ACCESS_RW_INTERLEAVED);
 	if(err < 0)
-		fprintf(stderr, "Failed to set interlieved access. %s.\n", snd_strerror(err)), exit(1);
+		fprintf(stderr, "Failed to set %sinterlieved access. %s.\n", conf->mmap ? "memory mapped " : "", snd_strerror(err)), exit(1);
 	
 	val = conf->rate;
 	err = snd_pcm_hw_params_set_rate_near(pcm, hw_params, &val, 0);
@@ -554,6 +543,204 @@ static void *pcm_thread(void *arg)
 	return NULL;
 }
 
+/**
+ * The memory mapped PCM loop. Samples are converted directly between the
+ * device ring buffer and the engine buffers, and the thread only polls when
+ * less than a full period is available.
+ *   @arg: The device argument.
+ *   &returns: Always 'NULL'.
+ */
+static void *pcm_mmap(void *arg)
+{
+	struct alsa_audio_t *audio = arg;
+	const struct alsa_conf_t *conf = &audio->conf;
+	snd_pcm_t *pcm = audio->capture ?: audio->playback;
+	unsigned int i, chan = (conf->in > conf->out) ? conf->in : conf->out;
+	uint8_t raw[pcm_size(audio->format) * conf->out * conf->period];
+	unsigned int nfds = snd_pcm_poll_descriptors_count(pcm) + 1;
+	struct pollfd fdset[nfds];
+	double data[chan][conf->period], *buf[chan];
+
+	for(i = 0; i < chan; i++)
+		buf[i] = data[i];
+
+	snd_pcm_poll_descriptors(pcm, fdset, nfds-1);
+	fdset[nfds-1].fd = audio->pipe[0];
+	fdset[nfds-1].events = POLLIN;
+
+	pcm_prepare(audio, raw);
+
+	while(true) {
+		snd_pcm_sframes_t avail;
+
+		avail = snd_pcm_avail_update(pcm);
+		if((avail >= 0) && (audio->capture != NULL) && (audio->playback != NULL)) {
+			snd_pcm_sframes_t space = snd_pcm_avail_update(audio->playback);
+
+			if(space < 0)
+				avail = space;
+		}
+
+		if((avail >= 0) && (avail < conf->period)) {
+			for(i = 0; i < nfds; i++)
+				fdset[i].revents = 0;
+
+			poll(fdset, nfds, -1);
+
+			if(fdset[nfds-1].revents & POLLIN) {
+				int err;
+				uint8_t cmd;
+
+				err = read(audio->pipe[0], &cmd, 1);
+				if(err < 0)
+					fprintf(stderr, "Failed to read from sychronization pipe. %s.\n", strerror(errno)), exit(1);
+
+				break;
+			}
+
+			continue;
+		}
+
+		if((avail < 0) || ((audio->capture != NULL) && !pcm_mmap_read(audio, buf))) {
+			audio->func(NULL, 0, audio->arg);
+
+			pcm_drop(audio);
+			pcm_prepare(audio, raw);
+
+			continue;
+		}
+
+		for(i = (audio->capture != NULL) ? conf->in : 0; i < chan; i++)
+			dsp_zero_d(buf[i], conf->period);
+
+		audio->func(buf, conf->period, audio->arg);
+		dsp_clamp_d(buf[0], conf->period);
+		dsp_clamp_d(buf[1], conf->period);
+
+#if PULSE
+		if(audio->hack != NULL)
+			pulse_hack_proc(audio->hack, buf, conf->period);
+#endif
+
+		if((audio->playback != NULL) && !pcm_mmap_write(audio, buf)) {
+			audio->func(NULL, 0, audio->arg);
+
+			pcm_drop(audio);
+			pcm_prepare(audio, raw);
+		}
+	}
+
+	pcm_drop(audio);
+
+	return NULL;
+}
+
+/**
+ * Read a period from the memory mapped capture device.
+ *   @audio: The audio device.
+ *   @buf: The output buffers.
+ *   &returns: True on success, false on xrun.
+ */
+static bool pcm_mmap_read(struct alsa_audio_t *audio, double **buf)
+{
+	int err;
+	unsigned int i, chan = audio->conf.in;
+	snd_pcm_uframes_t off, frames, done = 0;
+	snd_pcm_sframes_t commit;
+	const snd_pcm_channel_area_t *areas;
+	double *sub[chan];
+
+	while(done < audio->conf.period) {
+		if(!pcm_mmap_avail(audio->capture, &audio->conf))
+			return false;
+
+		frames = audio->conf.period - done;
+		err = snd_pcm_mmap_begin(audio->capture, &areas, &off, &frames);
+		if(err < 0)
+			return false;
+		else if(frames == 0)
+			continue;
+
+		for(i = 0; i < chan; i++)
+			sub[i] = buf[i] + done;
+
+		pcm2float(sub, (uint8_t *)areas[0].addr + (areas[0].first + off * areas[0].step) / 8, audio->format, frames, chan);
+
+		commit = snd_pcm_mmap_commit(audio->capture, off, frames);
+		if((commit < 0) || ((snd_pcm_uframes_t)commit != frames))
+			return false;
+
+		done += frames;
+	}
+
+	return true;
+}
+
+/**
+ * Write a period to the memory mapped playback device.
+ *   @audio: The audio device.
+ *   @buf: The input buffers.
+ *   &returns: True on success, false on xrun.
+ */
+static bool pcm_mmap_write(struct alsa_audio_t *audio, double **buf)
+{
+	int err;
+	unsigned int i, chan = audio->conf.out;
+	snd_pcm_uframes_t off, frames, done = 0;
+	snd_pcm_sframes_t commit;
+	const snd_pcm_channel_area_t *areas;
+	double *sub[chan];
+
+	while(done < audio->conf.period) {
+		if(!pcm_mmap_avail(audio->playback, &audio->conf))
+			return false;
+
+		frames = audio->conf.period - done;
+		err = snd_pcm_mmap_begin(audio->playback, &areas, &off, &frames);
+		if(err < 0)
+			return false;
+		else if(frames == 0)
+			continue;
+
+		for(i = 0; i < chan; i++)
+			sub[i] = buf[i] + done;
+
+		float2pcm((uint8_t *)areas[0].addr + (areas[0].first + off * areas[0].step) / 8, sub, audio->format, frames, chan);
+
+		commit = snd_pcm_mmap_commit(audio->playback, off, frames);
+		if((commit < 0) || ((snd_pcm_uframes_t)commit != frames))
+			return false;
+
+		done += frames;
+	}
+
+	return true;
+}
+
+/**
+ * Wait for space on a memory mapped device. The wait is bounded by the length
+ * of the device buffer, so that a stalled device is recovered as an xrun
+ * instead of spinning the audio thread.
+ *   @pcm: The PCM device.
+ *   @conf: The configuration.
+ *   &returns: True if space is available, false on xrun or timeout.
+ */
+static bool pcm_mmap_avail(snd_pcm_t *pcm, const struct alsa_conf_t *conf)
+{
+	snd_pcm_sframes_t avail;
+
+	avail = snd_pcm_avail_update(pcm);
+	if(avail < 0)
+		return false;
+	else if(avail > 0)
+		return true;
+
+	if(snd_pcm_wait(pcm, 1000 * conf->period * conf->nperiod / conf->rate + 1) <= 0)
+		return false;
+
+	return snd_pcm_avail_update(pcm) > 0;
+}
+
 /**
  * Prepare data on a PCM device.
  *   @audio: The audio device.
@@ -579,7 +766,11 @@ static void pcm_prepare(struct alsa_audio_t *audio, void *raw)
 		snd_pcm_format_set_silence(audio->format, raw, audio->conf.period * audio->conf.out);
 
 		for(i = 0; i < audio->conf.nperiod; i++) {
-			err = snd_pcm_writei(audio->playback, raw, audio->conf.period);
+			if(audio->conf.mmap)
+				err = snd_pcm_mmap_writei(audio->playback, raw, audio->conf.period);
+			else
+				err = snd_pcm_writei(audio->playback, raw, audio->conf.period);
+
 			if(err < 0)
 				fprintf(stderr, "Unable to write to ALSA audio device. %s.\n", snd_strerror(err)), exit(1);
 		}
@@ -660,6 +851,11 @@ static void pcm2float(double **restrict data, const uint8_t *restrict raw, snd_p
 		{
 			const int16_t *ptr = (const int16_t *)raw;
 
+			if(chancnt == 2) {
+				s16_to_d2(data[0], data[1], ptr, count, INT16_MAX);
+				break;
+			}
+
 			for(ii = chancnt - 1; ii != (unsigned int )-1; ii--) {
 				for(i = count - 1; i != (unsigned int)-1; i--)
 					data[ii][i] = ptr[chancnt*i + ii] / (double)INT16_MAX;
@@ -671,9 +867,14 @@ static void pcm2float(double **restrict data, const uint8_t *restrict raw, snd_p
 		{
 			const int32_t *ptr = (const int32_t *)raw;
 
+			if(chancnt == 2) {
+				s32_to_d2(data[0], data[1], ptr, count, 8, (INT32_MAX >> 8) - 1);
+				break;
+			}
+
 			for(ii = chancnt - 1; ii != (unsigned int )-1; ii--) {
 				for(i = count - 1; i != (unsigned int)-1; i--)
-					data[ii][i] = ptr[chancnt*i + ii] / (double)((INT32_MAX >> 8) - 1);
+					data[ii][i] = ((int32_t)((uint32_t)ptr[chancnt*i + ii] << 8) >> 8) / (double)((INT32_MAX >> 8) - 1);
 			}
 		}
 		break;
@@ -682,6 +883,11 @@ static void pcm2float(double **restrict data, const uint8_t *restrict raw, snd_p
 		{
 			const int32_t *ptr = (const int32_t *)raw;
 
+			if(chancnt == 2) {
+				s32_to_d2(data[0], data[1], ptr, count, 0, INT32_MAX - 1);
+				break;
+			}
+
 			for(ii = chancnt - 1; ii != (unsigned int )-1; ii--) {
 				for(i = count - 1; i != (unsigned int)-1; i--)
 					data[ii][i] = ptr[chancnt*i + ii] / (double)(INT32_MAX - 1);
@@ -735,6 +941,11 @@ static void float2pcm(uint8_t *restrict raw, double **restrict data, snd_pcm_for
 		{
 			int16_t *ptr = (int16_t *)raw;
 
+			if(chancnt == 2) {
+				d2_to_s16(ptr, data[0], data[1], count, INT16_MAX);
+				break;
+			}
+
 			for(ii = chancnt - 1; ii != (unsigned int)-1; ii--) {
 				for(i = count - 1; i != (unsigned int)-1; i--)
 					ptr[chancnt*i + ii] = data[ii][i] * INT16_MAX;
@@ -744,7 +955,12 @@ static void float2pcm(uint8_t *restrict raw, double **restrict data, snd_pcm_for
 
 	case SND_PCM_FORMAT_S24:
 		{
-			uint32_t *ptr = (uint32_t *)raw;
+			int32_t *ptr = (int32_t *)raw;
+
+			if(chancnt == 2) {
+				d2_to_s32(ptr, data[0], data[1], count, (INT32_MAX >> 8) - 1);
+				break;
+			}
 
 			for(ii = chancnt - 1; ii != (unsigned int)-1; ii--) {
 				for(i = count - 1; i != (unsigned int)-1; i--)
@@ -757,6 +973,11 @@ static void float2pcm(uint8_t *restrict raw, double **restrict data, snd_pcm_for
 		{
 			int32_t *ptr = (int32_t *)raw;
 
+			if(chancnt == 2) {
+				d2_to_s32(ptr, data[0], data[1], count, INT32_MAX - 1);
+				break;
+			}
+
 			for(ii = chancnt - 1; ii != (unsigned int)-1; ii--) {
 				for(i = count - 1; i != (unsigned int)-1; i--)
 					ptr[chancnt*i + ii] = data[ii][i] * (INT32_MAX - 1);
@@ -786,3 +1007,136 @@ static void float2pcm(uint8_t *restrict raw, double **restrict data, snd_pcm_for
 		fprintf(stderr, "Unsupported format: %d\n", format), exit(1);
 	}
 }
+
+
+/**
+ * Convert interleaved stereo 16-bit samples into two floating point buffers.
+ *   @left, right: The left and right output.
+ *   @ptr: The interleaved input.
+ *   @count: The number of frames.
+ *   @scale: The full scale value.
+ */
+static void s16_to_d2(double *restrict left, double *restrict right, const int16_t *restrict ptr, unsigned int count, double scale)
+{
+	unsigned int i = 0;
+	double mul = 1.0 / scale;
+
+#ifdef __SSE2__
+	__m128d vmul = _mm_set1_pd(mul);
+
+	for(; i + 4 <= count; i += 4) {
+		__m128i v, lo, hi;
+
+		v = _mm_loadu_si128((const __m128i *)(ptr + 2 * i));
+		lo = _mm_shuffle_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16), _MM_SHUFFLE(3, 1, 2, 0));
+		hi = _mm_shuffle_epi32(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16), _MM_SHUFFLE(3, 1, 2, 0));
+
+		_mm_storeu_pd(left + i + 0, _mm_mul_pd(_mm_cvtepi32_pd(lo), vmul));
+		_mm_storeu_pd(left + i + 2, _mm_mul_pd(_mm_cvtepi32_pd(hi), vmul));
+		_mm_storeu_pd(right + i + 0, _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(lo, 8)), vmul));
+		_mm_storeu_pd(right + i + 2, _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(hi, 8)), vmul));
+	}
+#endif
+
+	for(; i < count; i++) {
+		left[i] = ptr[2*i + 0] * mul;
+		right[i] = ptr[2*i + 1] * mul;
+	}
+}
+
+/**
+ * Convert interleaved stereo 32-bit samples into two floating point buffers.
+ * A non-zero shift sign extends samples stored in the low bits, such as
+ * 24-bit samples in a 32-bit container.
+ *   @left, right: The left and right output.
+ *   @ptr: The interleaved input.
+ *   @count: The number of frames.
+ *   @shift: The sign extension shift.
+ *   @scale: The full scale value.
+ */
+static void s32_to_d2(double *restrict left, double *restrict right, const int32_t *restrict ptr, unsigned int count, unsigned int shift, double scale)
+{
+	unsigned int i = 0;
+	double mul = 1.0 / scale;
+
+#ifdef __SSE2__
+	__m128d vmul = _mm_set1_pd(mul);
+	__m128i vshift = _mm_cvtsi32_si128(shift);
+
+	for(; i + 2 <= count; i += 2) {
+		__m128i v;
+
+		v = _mm_loadu_si128((const __m128i *)(ptr + 2 * i));
+		v = _mm_sra_epi32(_mm_sll_epi32(v, vshift), vshift);
+		v = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 1, 2, 0));
+
+		_mm_storeu_pd(left + i, _mm_mul_pd(_mm_cvtepi32_pd(v), vmul));
+		_mm_storeu_pd(right + i, _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(v, 8)), vmul));
+	}
+#endif
+
+	for(; i < count; i++) {
+		left[i] = ((int32_t)((uint32_t)ptr[2*i + 0] << shift) >> shift) * mul;
+		right[i] = ((int32_t)((uint32_t)ptr[2*i + 1] << shift) >> shift) * mul;
+	}
+}
+
+/**
+ * Convert two floating point buffers into interleaved stereo 16-bit samples.
+ *   @ptr: The interleaved output.
+ *   @left, right: The left and right input.
+ *   @count: The number of frames.
+ *   @scale: The full scale value.
+ */
+static void d2_to_s16(int16_t *restrict ptr, const double *restrict left, const double *restrict right, unsigned int count, double scale)
+{
+	unsigned int i = 0;
+
+#ifdef __SSE2__
+	__m128d vmul = _mm_set1_pd(scale);
+
+	for(; i + 4 <= count; i += 4) {
+		__m128i l, r;
+
+		l = _mm_unpacklo_epi64(_mm_cvttpd_epi32(_mm_mul_pd(_mm_loadu_pd(left + i + 0), vmul)), _mm_cvttpd_epi32(_mm_mul_pd(_mm_loadu_pd(left + i + 2), vmul)));
+		r = _mm_unpacklo_epi64(_mm_cvttpd_epi32(_mm_mul_pd(_mm_loadu_pd(right + i + 0), vmul)), _mm_cvttpd_epi32(_mm_mul_pd(_mm_loadu_pd(right + i + 2), vmul)));
+
+		_mm_storeu_si128((__m128i *)(ptr + 2 * i), _mm_packs_epi32(_mm_unpacklo_epi32(l, r), _mm_unpackhi_epi32(l, r)));
+	}
+#endif
+
+	for(; i < count; i++) {
+		ptr[2*i + 0] = left[i] * scale;
+		ptr[2*i + 1] = right[i] * scale;
+	}
+}
+
+/**
+ * Convert two floating point buffers into interleaved stereo 32-bit samples.
+ *   @ptr: The interleaved output.
+ *   @left, right: The left and right input.
+ *   @count: The number of frames.
+ *   @scale: The full scale value.
+ */
+static void d2_to_s32(int32_t *restrict ptr, const double *restrict left, const double *restrict right, unsigned int count, double scale)
+{
+	unsigned int i = 0;
+
+#ifdef __SSE2__
+	__m128d vmul = _mm_set1_pd(scale);
+
+	for(; i + 2 <= count; i += 2) {
+		__m128i l, r;
+
+		l = _mm_cvttpd_epi32(_mm_mul_pd(_mm_loadu_pd(left + i), vmul));
+		r = _mm_cvttpd_epi32(_mm_mul_pd(_mm_loadu_pd(right + i), vmul));
+
+		_mm_storeu_si128((__m128i *)(ptr + 2 * i), _mm_unpacklo_epi32(l, r));
+	}
+#endif
+
+	for(; i < count; i++) {
+		ptr[2*i + 0] = left[i] * scale;
+		ptr[2*i + 1] = right[i] * scale;
+	}
+}
@@ -2,18 +2,26 @@
 
 
 /**
- * MIDI communication structure.
- *   @event: The event list.
- *   @rd, wr: The read and write indices.
- *   @lock: Write lock.
+ * Ring cell structure.
+ *   @event: The event.
+ *   @stamp: The arrival time in microseconds.
+ */
+struct cell_t {
+	struct amp_event_t event;
+	int64_t stamp;
+};
+
+/**
+ * MIDI communication structure. Events are passed through a bounded ring
+ * that any number of MIDI threads may write without locking; the audio
+ * callback is the only reader.
+ *   @ring: The event ring.
+ *   @cell: The ring cells.
  *   @inst: The instance list.
- *   @len: The instance list length.
  */
 struct amp_comm_t {
-	struct amp_event_t event[AMP_COMM_LEN];
-	volatile unsigned int rd, wr;
-
-	sys_mutex_t lock;
+	struct amp_mpsc_t ring;
+	struct cell_t cell[AMP_COMM_LEN];
 
 	struct inst_t *inst;
 };
@@ -49,15 +57,14 @@ struct amp_comm_t *amp_comm_new(void)
 	struct amp_comm_t *comm;
 
 	comm = malloc(sizeof(struct amp_comm_t));
-	comm->rd = comm->wr = 0;
+	comm->ring = amp_mpsc_init(AMP_COMM_LEN);
 	comm->inst = NULL;
-	comm->lock = sys_mutex_init(0);
 
 	return comm;
 }
 
 /**
- * Delete a communication structure.
+ * Delete a communication structure. Events lost to a full ring are reported.
  *   @comm: The communication structure.
  */
 void amp_comm_delete(struct amp_comm_t *comm)
@@ -71,7 +78,10 @@ void amp_comm_delete(struct amp_comm_t *comm)
 		free(inst);
 	}
 
-	sys_mutex_destroy(&comm->lock);
+	if(amp_mpsc_lost(&comm->ring) > 0)
+		fprintf(stderr, "%lu MIDI events lost to a full ring.\n", (unsigned long)amp_mpsc_lost(&comm->ring));
+
+	amp_mpsc_destroy(&comm->ring);
 	free(comm);
 }
 
@@ -97,41 +107,55 @@ void amp_comm_add(struct amp_comm_t *comm, uint16_t dev, const char *conf, const
 }
 
 /**
- * Read an event from the communications
+ * Read an event from the communications. Only the audio callback may read.
  *   @comm: The communication structure.
  *   @event: Out. The output event pointer.
+ *   @stamp: Out. The arrival time in microseconds.
  *   &returns: True if event available, false otherwise.
  */
-bool amp_comm_read(struct amp_comm_t *comm, struct amp_event_t *event)
+bool amp_comm_read(struct amp_comm_t *comm, struct amp_event_t *event, int64_t *stamp)
 {
-	if(comm->rd != comm->wr) {
-		*event = comm->event[comm->rd];
-		comm->rd = (comm->rd + 1) % AMP_COMM_LEN;
+	unsigned int idx;
 
-		return true;
-	}
-	else
+	if(!amp_mpsc_peek(&comm->ring, &idx))
 		return false;
 
+	*event = comm->cell[idx].event;
+	*stamp = comm->cell[idx].stamp;
+	amp_mpsc_release(&comm->ring);
+
+	return true;
+}
+
+/**
+ * Retrieve the number of events lost to a full ring.
+ *   @comm: The communication structure.
+ *   &returns: The lost event count.
+ */
+uint64_t amp_comm_lost(struct amp_comm_t *comm)
+{
+	return amp_mpsc_lost(&comm->ring);
 }
 
 
 /**
- * MIDI callback.
+ * MIDI callback. Any number of devices may call concurrently; the event is
+ * counted as lost if the ring is full.
  *   @key: The key.
  *   @val: The value.
  *   @arg: The argument.
  */
 static void callback(uint16_t key, uint16_t val, void *arg)
 {
+	uint64_t pos;
+	int64_t stamp;
 	struct inst_t *inst = arg;
 	struct amp_comm_t *comm = inst->comm;
 
-	sys_mutex_lock(&comm->lock);
-
-	comm->event[comm->wr] = (struct amp_event_t){ inst->dev, key, val };
-	__sync_synchronize();
-	comm->wr = (comm->wr + 1) % AMP_COMM_LEN;
+	stamp = sys_utime();
+	if(!amp_mpsc_claim(&comm->ring, &pos))
+		return;
 
-	sys_mutex_unlock(&comm->lock);
+	comm->cell[pos & (AMP_COMM_LEN - 1)] = (struct cell_t){ { inst->dev, key, val }, stamp };
+	amp_mpsc_publish(&comm->ring, pos);
 }
@@ -9,7 +9,8 @@ struct amp_midi_i;
 struct amp_comm_t *amp_comm_new(void);
 void amp_comm_delete(struct amp_comm_t *comm);
 
-bool amp_comm_read(struct amp_comm_t *comm, struct amp_event_t *event);
+bool amp_comm_read(struct amp_comm_t *comm, struct amp_event_t *event, int64_t *stamp);
+uint64_t amp_comm_lost(struct amp_comm_t *comm);
 void amp_comm_add(struct amp_comm_t *comm, uint16_t dev, const char *conf, const struct amp_midi_i *iface);
 
 #endif
@@ -17,6 +17,8 @@
 #include "comm.h"
 #include "engine.h"
 #include "exec.h"
+#include "harden.h"
+#include "render.h"
 #include "watch.h"
 
 #ifdef ALSA
@@ -3,9 +3,13 @@
 
 /**
  * Constant definitions
- *   @AMP_COMM_LEN: MIDI communications event ring length.
+ *   @AMP_COMM_LEN: MIDI communications event ring length, a power of two.
+ *   @AMP_RENDER_LEN: The maximum render block length.
+ *   @AMP_RENDER_CAP: The maximum render length in seconds when rendering bars.
  */
-#define AMP_COMM_LEN 32
+#define AMP_COMM_LEN 256
+#define AMP_RENDER_LEN 65536
+#define AMP_RENDER_CAP 3600
 
 
 /**
@@ -216,4 +220,19 @@ static inline void amp_midi_close(struct amp_midi_t midi)
 	midi.iface->close(midi.ref);
 }
 
+
+/**
+ * Real-time hardening structure.
+ *   @prio: The SCHED_FIFO priority, zero to leave the scheduler alone.
+ *   @cpu: The CPU for the audio thread, negative to leave unpinned.
+ *   @lock: Lock the engine memory and prefault the heap.
+ *   @fault: Prefault sample files as they are loaded.
+ *   @heap: The heap prefault size in MiB.
+ */
+struct amp_harden_t {
+	int prio, cpu;
+	bool lock, fault;
+	unsigned int heap;
+};
+
 #endif
@@ -4,18 +4,21 @@
  * local declarations
  */
 static void notify_proc(struct sys_change_t *change, void *arg);
+static void load_proc(void *arg, const char *path, unsigned int done, unsigned int total);
+
+static void engine_apply(struct amp_engine_t *engine, struct amp_cmd_t cmd);
 
 
 /**
  * Create an engine.
  *   @path: Constant. Optional. The source file.
  *   @comm: Consumed. Optional. The communication structure.
- *   @audio: The audio interface.
+ *   @rate: The sample rate.
+ *   @iface: Constant. The audio interface name.
  *   &returns: The engine.
  */
-struct amp_engine_t *amp_engine_new(const char *path, struct amp_comm_t *comm, struct amp_audio_t audio)
+struct amp_engine_t *amp_engine_new(const char *path, struct amp_comm_t *comm, unsigned int rate, const char *iface)
 {
-	const char *iface;
 	struct amp_engine_t *engine;
 
 	engine = malloc(sizeof(struct amp_engine_t));
@@ -23,30 +26,22 @@ struct amp_engine_t *amp_engine_new(const char *path, struct amp_comm_t *comm, s
 	engine->lock = sys_mutex_init(0);
 	engine->sync = sys_mutex_init(0);
 	engine->run = false;
-	engine->core = amp_core_new(amp_audio_info(audio).rate);
-	engine->clock = amp_basic_clock(amp_basic_new(120.0, 4.0, amp_audio_info(audio).rate));
-	engine->instr = amp_instr_null;
+	engine->rate = rate;
+	engine->core = amp_core_new(rate);
+	engine->live = false;
+	engine->graph = amp_graph_new(rate);
+	engine->retire = NULL;
+	engine->rd = engine->wr = 0;
+	engine->seq = 0;
+	engine->loc = amp_loc(0, 0.0);
 	engine->comm = comm ?: amp_comm_new();
-	engine->notify = sys_notify_async1(path, notify_proc, engine);
+	engine->notify = path ? sys_notify_async1(path, notify_proc, engine) : NULL;
 	engine->watch = NULL;
-	engine->rt = (struct amp_rt_t){ engine, amp_export_watch, amp_export_status, amp_export_start, amp_export_stop, amp_export_seek };
+	engine->rt = (struct amp_rt_t){ engine, amp_export_watch, amp_export_status, amp_export_start, amp_export_stop, amp_export_seek, amp_export_loc, amp_export_lost };
 
 	ml_env_add(&engine->core->env, strdup("amp.rt"), ml_value_box(amp_box_ref(&engine->rt), ml_tag_copy(ml_tag_null)));
-
-	iface = "unk";
-	
-	if(audio.iface == &dummy_audio_iface)
-		iface = "dummy";
-#if ALSA
-	else if(audio.iface == &alsa_audio_iface)
-		iface = "alsa";
-#endif
-#if PULSE
-	else if(audio.iface == &pulse_audio_iface)
-		iface = "pulse";
-#endif
-
 	ml_env_add(&engine->core->env, strdup("amp.audio"), ml_value_str(strdup(iface), ml_tag_copy(ml_tag_null)));
+	amp_cache_progress(engine->core->cache, load_proc, engine);
 
 	return engine;
 }
@@ -62,7 +57,8 @@ void amp_engine_delete(struct amp_engine_t *engine)
 	if(engine->run)
 		amp_engine_stop(engine);
 
-	sys_task_delete(engine->notify);
+	if(engine->notify != NULL)
+		sys_task_delete(engine->notify);
 
 	while(engine->watch != NULL) {
 		watch = engine->watch;
@@ -71,9 +67,9 @@ void amp_engine_delete(struct amp_engine_t *engine)
 		free(watch);
 	}
 
+	amp_engine_reclaim(engine);
 	amp_comm_delete(engine->comm);
-	amp_clock_delete(engine->clock);
-	amp_instr_erase(engine->instr);
+	amp_graph_delete(engine->graph);
 	amp_core_delete(engine->core);
 	sys_mutex_destroy(&engine->lock);
 	sys_mutex_destroy(&engine->sync);
@@ -109,6 +105,20 @@ static void notify_proc(struct sys_change_t *change, void *arg)
 	//amp_engine_update(arg, path);
 }
 
+/**
+ * Report the progress of loading files.
+ *   @arg: The engine.
+ *   @path: The path of the file loaded.
+ *   @done: The number of files loaded.
+ *   @total: The number of files being loaded.
+ */
+static void load_proc(void *arg, const char *path, unsigned int done, unsigned int total)
+{
+	fprintf(stderr, "\rLoaded %u of %u files.", done, total);
+	if(done == total)
+		fprintf(stderr, "\n");
+}
+
 
 /**
  * Check the status of the engine.
@@ -126,11 +136,8 @@ bool amp_engine_status(struct amp_engine_t *engine)
  */
 void amp_engine_start(struct amp_engine_t *engine)
 {
-	struct amp_seek_t seek;
-
 	engine->run = true;
-	amp_clock_info(engine->clock, amp_info_start(&seek));
-	amp_instr_info(engine->instr, amp_info_start(&seek));
+	amp_engine_post(engine, (struct amp_cmd_t){ amp_cmd_start_v, false, 0.0, NULL });
 }
 
 /**
@@ -139,11 +146,8 @@ void amp_engine_start(struct amp_engine_t *engine)
  */
 void amp_engine_stop(struct amp_engine_t *engine)
 {
-	struct amp_seek_t seek;
-
 	engine->run = false;
-	amp_clock_info(engine->clock, amp_info_stop(&seek));
-	amp_instr_info(engine->instr, amp_info_stop(&seek));
+	amp_engine_post(engine, (struct amp_cmd_t){ amp_cmd_stop_v, false, 0.0, NULL });
 }
 
 /**
@@ -152,15 +156,270 @@ void amp_engine_stop(struct amp_engine_t *engine)
  *   @bar: The bar.
  */
 void amp_engine_seek(struct amp_engine_t *engine, double bar)
+{
+	amp_engine_post(engine, (struct amp_cmd_t){ amp_cmd_seek_v, engine->run, bar, NULL });
+}
+
+/**
+ * Retrieve the location of the engine.
+ *   @engine: The engine.
+ *   &returns: The location of the last processed block.
+ */
+struct amp_loc_t amp_engine_loc(struct amp_engine_t *engine)
+{
+	unsigned int seq;
+	struct amp_loc_t loc;
+
+	if(!engine->live) {
+		amp_clock_info(engine->graph->clock, amp_info_loc(&loc));
+
+		return loc;
+	}
+
+	do {
+		seq = __atomic_load_n(&engine->seq, __ATOMIC_ACQUIRE);
+		loc = engine->loc;
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	} while((seq % 2) || (seq != __atomic_load_n(&engine->seq, __ATOMIC_RELAXED)));
+
+	return loc;
+}
+
+
+/**
+ * Process a block of audio on the engine. Pending commands are applied
+ * first, and the location is published afterwards. Device buffers are always
+ * double precision and are converted when built with single precision samples.
+ * MIDI events are placed within the block by arrival time, relative to the
+ * block period preceding the call, trading one block of latency for a
+ * jitter-free timing. Events that do not fit in the queue wait for the next
+ * block.
+ *   @engine: The engine.
+ *   @buf: The stereo buffer.
+ *   @time: The time array, must have 'len+1' elements.
+ *   @len: The length.
+ */
+void amp_engine_block(struct amp_engine_t *engine, double **buf, struct amp_time_t *time, unsigned int len)
+{
+	int64_t base, stamp, delay;
+	struct amp_event_t event;
+	struct amp_queue_t queue;
+	struct amp_graph_t *graph;
+
+	base = sys_utime() - (int64_t)len * 1000000 / engine->rate;
+	amp_engine_proc(engine);
+	graph = engine->graph;
+
+	amp_clock_proc(graph->clock, time, len);
+	amp_queue_init(&queue);
+
+	while((queue.idx < AMP_QUEUE_LEN) && amp_comm_read(engine->comm, &event, &stamp)) {
+		delay = (stamp - base) * engine->rate / 1000000;
+		delay = (delay < 0) ? 0 : (delay >= len) ? (len - 1) : delay;
+		amp_queue_add(&queue, (struct amp_action_t){ delay, event });
+	}
+
+	if(graph->instr.iface != NULL) {
+#if DSP_FLOAT
+		unsigned int i;
+		dsp_sample_t left[len], right[len], *tmp[2] = { left, right };
+
+		for(i = 0; i < len; i++)
+			left[i] = buf[0][i], right[i] = buf[1][i];
+
+		amp_instr_proc(graph->instr, tmp, time, len, &queue);
+
+		for(i = 0; i < len; i++)
+			buf[0][i] = left[i], buf[1][i] = right[i];
+#else
+		amp_instr_proc(graph->instr, buf, time, len, &queue);
+#endif
+	}
+	else
+		dsp_zero_d(buf[0], len), dsp_zero_d(buf[1], len);
+
+	amp_engine_publish(engine);
+}
+
+/**
+ * Set the live state of the engine. When live, commands are queued for the
+ * audio callback; otherwise, they are applied immediately. The engine lock
+ * must be held, and the audio callback must not be executing when clearing
+ * the live flag.
+ *   @engine: The engine.
+ *   @live: The live flag.
+ */
+void amp_engine_live(struct amp_engine_t *engine, bool live)
+{
+	if(!live)
+		amp_engine_proc(engine);
+
+	engine->live = live;
+}
+
+/**
+ * Post a command to the engine. The engine lock must be held. If the command
+ * ring is full, the caller waits for the audio callback to make room.
+ *   @engine: The engine.
+ *   @cmd: The command.
+ */
+void amp_engine_post(struct amp_engine_t *engine, struct amp_cmd_t cmd)
+{
+	unsigned int wr;
+
+	if(!engine->live) {
+		engine_apply(engine, cmd);
+
+		return;
+	}
+
+	wr = (engine->wr + 1) % AMP_CMD_LEN;
+	while(wr == __atomic_load_n(&engine->rd, __ATOMIC_ACQUIRE))
+		sys_usleep(500);
+
+	engine->cmd[engine->wr] = cmd;
+	__atomic_store_n(&engine->wr, wr, __ATOMIC_RELEASE);
+}
+
+/**
+ * Process all pending commands on the engine. This function is wait-free and
+ * is called from the audio callback at the beginning of every block.
+ *   @engine: The engine.
+ */
+void amp_engine_proc(struct amp_engine_t *engine)
+{
+	unsigned int rd;
+
+	rd = engine->rd;
+	while(rd != __atomic_load_n(&engine->wr, __ATOMIC_ACQUIRE)) {
+		engine_apply(engine, engine->cmd[rd]);
+
+		rd = (rd + 1) % AMP_CMD_LEN;
+		__atomic_store_n(&engine->rd, rd, __ATOMIC_RELEASE);
+	}
+}
+
+/**
+ * Publish the location of the engine. Called from the audio callback after
+ * processing a block.
+ *   @engine: The engine.
+ */
+void amp_engine_publish(struct amp_engine_t *engine)
+{
+	struct amp_loc_t loc;
+
+	amp_clock_info(engine->graph->clock, amp_info_loc(&loc));
+
+	__atomic_store_n(&engine->seq, engine->seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	engine->loc = loc;
+	__atomic_store_n(&engine->seq, engine->seq + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Reclaim all graphs retired by the audio callback. The engine lock must be
+ * held. When live, this waits a bounded amount of time for the callback to
+ * consume all pending commands; anything not yet retired is reclaimed by a
+ * later call.
+ *   @engine: The engine.
+ */
+void amp_engine_reclaim(struct amp_engine_t *engine)
+{
+	unsigned int i;
+	struct amp_graph_t *graph;
+
+	if(engine->live) {
+		for(i = 0; i < 2000; i++) {
+			if(engine->wr == __atomic_load_n(&engine->rd, __ATOMIC_ACQUIRE))
+				break;
+
+			sys_usleep(500);
+		}
+	}
+
+	graph = __atomic_exchange_n(&engine->retire, NULL, __ATOMIC_ACQUIRE);
+	while(graph != NULL) {
+		struct amp_graph_t *next = graph->next;
+
+		amp_graph_delete(graph);
+		graph = next;
+	}
+}
+
+
+/**
+ * Apply a command to the engine.
+ *   @engine: The engine.
+ *   @cmd: The command.
+ */
+static void engine_apply(struct amp_engine_t *engine, struct amp_cmd_t cmd)
 {
 	struct amp_seek_t seek;
+	struct amp_graph_t *graph = engine->graph;
 
-	if(engine->run)
-		amp_clock_info(engine->clock, amp_info_stop(&seek));
+	switch(cmd.type) {
+	case amp_cmd_start_v:
+		amp_clock_info(graph->clock, amp_info_start(&seek));
+		if(graph->instr.iface != NULL)
+			amp_instr_info(graph->instr, amp_info_start(&seek));
 
-	amp_clock_info(engine->clock, amp_info_seek(&bar));
-	amp_instr_info(engine->instr, amp_info_seek(&bar));
+		break;
 
-	if(engine->run)
-		amp_clock_info(engine->clock, amp_info_start(&seek));
+	case amp_cmd_stop_v:
+		amp_clock_info(graph->clock, amp_info_stop(&seek));
+		if(graph->instr.iface != NULL)
+			amp_instr_info(graph->instr, amp_info_stop(&seek));
+
+		break;
+
+	case amp_cmd_seek_v:
+		if(cmd.run)
+			amp_clock_info(graph->clock, amp_info_stop(&seek));
+
+		amp_clock_info(graph->clock, amp_info_seek(&cmd.bar));
+		if(graph->instr.iface != NULL)
+			amp_instr_info(graph->instr, amp_info_seek(&cmd.bar));
+
+		if(cmd.run)
+			amp_clock_info(graph->clock, amp_info_start(&seek));
+
+		break;
+
+	case amp_cmd_swap_v:
+		engine->graph = cmd.graph;
+
+		graph->next = __atomic_exchange_n(&engine->retire, NULL, __ATOMIC_ACQUIRE);
+		__atomic_store_n(&engine->retire, graph, __ATOMIC_RELEASE);
+
+		break;
+	}
+}
+
+
+/**
+ * Create a graph with a default clock and no instrument.
+ *   @rate: The sample rate.
+ *   &returns: The graph.
+ */
+struct amp_graph_t *amp_graph_new(unsigned int rate)
+{
+	struct amp_graph_t *graph;
+
+	graph = malloc(sizeof(struct amp_graph_t));
+	graph->clock = amp_basic_clock(amp_basic_new(120.0, 4.0, rate));
+	graph->instr = amp_instr_null;
+	graph->next = NULL;
+
+	return graph;
+}
+
+/**
+ * Delete a graph.
+ *   @graph: The graph.
+ */
+void amp_graph_delete(struct amp_graph_t *graph)
+{
+	amp_clock_delete(graph->clock);
+	amp_instr_erase(graph->instr);
+	free(graph);
 }
@@ -23,9 +23,7 @@ struct amp_watch_t {
 /*
  * engine declarations
  */
-struct amp_audio_t;
-
-struct amp_engine_t *amp_engine_new(const char *file, struct amp_comm_t *comm, struct amp_audio_t audio);
+struct amp_engine_t *amp_engine_new(const char *path, struct amp_comm_t *comm, unsigned int rate, const char *iface);
 void amp_engine_delete(struct amp_engine_t *engine);
 
 void amp_engine_update(struct amp_engine_t *engine, const char *path);
@@ -36,5 +34,16 @@ bool amp_engine_status(struct amp_engine_t *engine);
 void amp_engine_start(struct amp_engine_t *engine);
 void amp_engine_stop(struct amp_engine_t *engine);
 void amp_engine_seek(struct amp_engine_t *engine, double bar);
+struct amp_loc_t amp_engine_loc(struct amp_engine_t *engine);
+
+void amp_engine_block(struct amp_engine_t *engine, double **buf, struct amp_time_t *time, unsigned int len);
+void amp_engine_live(struct amp_engine_t *engine, bool live);
+void amp_engine_post(struct amp_engine_t *engine, struct amp_cmd_t cmd);
+void amp_engine_proc(struct amp_engine_t *engine);
+void amp_engine_publish(struct amp_engine_t *engine);
+void amp_engine_reclaim(struct amp_engine_t *engine);
+
+struct amp_graph_t *amp_graph_new(unsigned int rate);
+void amp_graph_delete(struct amp_graph_t *graph);
 
 #endif
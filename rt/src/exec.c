@@ -1,14 +1,29 @@
 #include "common.h"
 
 
+/**
+ * Callback structure.
+ *   @engine: The engine.
+ *   @stack: Flag indicating the audio thread stack must be locked.
+ */
+struct exec_t {
+	struct amp_engine_t *engine;
+	bool stack;
+};
+
 /*
  * local declarations
  */
+static const char *audio_name(struct amp_audio_t audio);
+static void exec_top(struct amp_engine_t *engine);
 static void callback(double **buf, unsigned int len, void *arg);
 
 
 /**
- * Update the engine with the code from the given path.
+ * Update the engine with the code from the given path. The new graph is built
+ * and initialized without holding the engine lock, then handed to the audio
+ * callback through the command ring. The replaced graph is deleted from this
+ * thread once the callback has retired it.
  *   @engine: The engine.
  *   @path: The path.
  */
@@ -18,28 +33,20 @@ void amp_engine_update(struct amp_engine_t *engine, const char *path)
 	struct ml_value_t *value;
 	struct amp_box_t *box;
 	struct ml_env_t *env;
+	struct amp_graph_t *graph;
 
 	env = amp_core_eval(engine->core, path, &err);
 	if(env == NULL) {
 		fprintf(stderr, "%s\n", err), free(err); return;
 	}
 
-	sys_mutex_lock(&engine->sync);
-	sys_mutex_lock(&engine->lock);
-
-	if(engine->run)
-		amp_engine_stop(engine);
-
-	double bar;
-	amp_clock_info(engine->clock, amp_info_tell(&bar));
+	graph = amp_graph_new(amp_core_rate(env));
 
 	value = ml_env_lookup(env, "amp.clock");
 	if(value != NULL) {
 		box = amp_unbox_value(value, amp_box_clock_e);
-		if(box != NULL) {
-			amp_clock_set(&engine->clock, amp_clock_copy(box->data.clock));
-			amp_clock_info(engine->clock, amp_info_init());
-		}
+		if(box != NULL)
+			amp_clock_set(&graph->clock, amp_clock_copy(box->data.clock));
 		else
 			fprintf(stderr, "Type for 'amp.clock' is not valid.\n");
 	}
@@ -47,14 +54,24 @@ void amp_engine_update(struct amp_engine_t *engine, const char *path)
 	value = ml_env_lookup(env, "amp.instr");
 	if(value != NULL) {
 		box = amp_unbox_value(value, amp_box_instr_e);
-		if(box != NULL) {
-			amp_instr_set(&engine->instr, amp_instr_copy(box->data.instr));
-			amp_instr_info(engine->instr, amp_info_init());
-		}
+		if(box != NULL)
+			amp_instr_set(&graph->instr, amp_instr_copy(box->data.instr));
 		else
 			fprintf(stderr, "Type for 'amp.instr' is not valid.\n");
 	}
 
+	amp_clock_info(graph->clock, amp_info_init());
+	if(graph->instr.iface != NULL)
+		amp_instr_info(graph->instr, amp_info_init());
+
+	sys_mutex_lock(&engine->sync);
+	sys_mutex_lock(&engine->lock);
+
+	if(engine->run)
+		amp_engine_stop(engine);
+
+	amp_engine_post(engine, (struct amp_cmd_t){ amp_cmd_swap_v, false, 0.0, graph });
+
 	value = ml_env_lookup(env, "amp.bar");
 	if(value != NULL) {
 		if(ml_value_isnum(value)) {
@@ -92,8 +109,7 @@ void amp_engine_update(struct amp_engine_t *engine, const char *path)
 	for(watch = engine->watch; watch != NULL; watch = watch->next)
 		watch->func(env, watch->arg);
 
-	//amp_clock_info(engine->clock, amp_info_seek(&bar));
-	//amp_instr_info(engine->instr, amp_info_seek(&bar));
+	amp_engine_reclaim(engine);
 
 	sys_mutex_unlock(&engine->lock);
 	sys_mutex_unlock(&engine->sync);
@@ -108,14 +124,21 @@ void amp_engine_update(struct amp_engine_t *engine, const char *path)
  *   @file: The file.
  *   @plugin: The plugin list.
  *   @comm: Optional. Consumed. The communication structure.
+ *   @harden: The real-time hardening options.
  */
-void amp_exec(struct amp_audio_t audio, const char *file, char **plugin, struct amp_comm_t *comm)
+void amp_exec(struct amp_audio_t audio, const char *file, char **plugin, struct amp_comm_t *comm, const struct amp_harden_t *harden)
 {
 	bool quit = false;
 	char **el;
+	struct exec_t exec;
 	struct amp_engine_t *engine;
 
-	engine = amp_engine_new(file, comm, audio);
+	engine = amp_engine_new(file, comm, amp_audio_info(audio).rate, audio_name(audio));
+	exec.engine = engine;
+	exec.stack = amp_harden_lock(harden);
+	amp_io_lock(engine->core->io, exec.stack);
+	amp_harden_pool(harden, engine->core->pool);
+	amp_cache_prefault(engine->core->cache, harden->fault);
 
 	for(el = plugin; *el != NULL; el++) {
 		char *err;
@@ -126,7 +149,12 @@ void amp_exec(struct amp_audio_t audio, const char *file, char **plugin, struct
 	}
 
 	amp_engine_update(engine, file);
-	amp_audio_exec(audio, callback, engine);
+
+	sys_mutex_lock(&engine->lock);
+	amp_engine_live(engine, true);
+	sys_mutex_unlock(&engine->lock);
+
+	amp_harden_exec(harden, audio, callback, &exec);
 
 	while(!quit) {
 		unsigned int argc;
@@ -144,8 +172,10 @@ void amp_exec(struct amp_audio_t audio, const char *file, char **plugin, struct
 				quit = true;
 			else if(strcmp(argv[0], "s") == 0) {
 				printf("%s engine.\n", engine->run ? "Stopping" : "Starting");
-				(engine->run ? amp_engine_stop : amp_engine_start)(engine);
+				(engine->run ? amp_export_stop : amp_export_start)(engine);
 			}
+			else if(strcmp(argv[0], "top") == 0)
+				exec_top(engine);
 			else
 				printf("Unknown command '%s'.\n", argv[0]);
 		}
@@ -154,47 +184,110 @@ void amp_exec(struct amp_audio_t audio, const char *file, char **plugin, struct
 	}
 
 	amp_audio_halt(audio);
+
+	sys_mutex_lock(&engine->lock);
+	amp_engine_live(engine, false);
+	sys_mutex_unlock(&engine->lock);
+
 	amp_engine_delete(engine);
 }
 
 
 /**
- * Audio callback.
- *   @buf: The buffer.
- *   @len: The length.
- *   @arg: The argument.
+ * Retrieve the name of an audio interface.
+ *   @audio: The audio device.
+ *   &returns: The name.
  */
-static void callback(double **buf, unsigned int len, void *arg)
+static const char *audio_name(struct amp_audio_t audio)
 {
-	struct amp_event_t event;
-	struct amp_engine_t *engine = arg;
-	struct amp_time_t time[len+1];
+	if(audio.iface == &dummy_audio_iface)
+		return "dummy";
+#if ALSA
+	else if(audio.iface == &alsa_audio_iface)
+		return "alsa";
+#endif
+#if PULSE
+	else if(audio.iface == &pulse_audio_iface)
+		return "pulse";
+#endif
+	else
+		return "unk";
+}
 
-	if(len == 0) {
-		printf("xrun\n");
-		return;
-	}
+/**
+ * Display a live view of the profiler, refreshed every second, until a line
+ * is entered. The profiler is enabled for the duration of the view if not
+ * already running.
+ *   @engine: The engine.
+ */
+static void exec_top(struct amp_engine_t *engine)
+{
+	bool enabled;
+	unsigned int i, n, rate;
+	struct amp_prof_stat_t *stat;
+	struct amp_prof_t *prof = engine->core->prof;
 
-	if(!sys_mutex_trylock(&engine->lock)) {
-		dsp_zero_d(buf[0], len);
-		dsp_zero_d(buf[1], len);
+	enabled = amp_prof_enabled(prof);
+	if(!enabled)
+		amp_prof_enable(prof, true);
 
-		return;
+	rate = amp_core_rate(engine->core->env);
+
+	while(true) {
+		char buf[256];
+		struct sys_poll_t poll;
+
+		n = amp_prof_stat(prof, &stat);
+
+		printf("\x1b[H\x1b[2J");
+		printf("%u nodes, %lu samples lost, %lu events lost, %lu stream underruns. Press enter to return.\n\n", n, (unsigned long)amp_prof_lost(prof), (unsigned long)amp_export_lost(engine), (unsigned long)amp_io_underrun(engine->core->io));
+		printf("%-20s %-16s %10s %10s %10s %10s %7s\n", "NODE", "REF", "MEAN(us)", "P99(us)", "WORST(us)", "TOTAL(us)", "LOAD");
+
+		for(i = 0; (i < n) && (i < 24); i++) {
+			double budget = 1e6 * stat[i].len / rate;
+
+			printf("%-20s %-16p %10.2f %10.2f %10.2f %10.2f %6.2f%%\n", stat[i].name, stat[i].ref, stat[i].mean, stat[i].p99, stat[i].worst, stat[i].total, 100.0 * stat[i].mean / budget);
+		}
+
+		fflush(stdout);
+		free(stat);
+
+		poll = sys_poll_fd(0, sys_poll_in_e);
+		if(sys_poll(&poll, 1, 1000)) {
+			if(fgets(buf, sizeof(buf), stdin) == NULL)
+				clearerr(stdin);
+
+			break;
+		}
 	}
 
-	amp_clock_proc(engine->clock, time, len);
+	if(!enabled)
+		amp_prof_enable(prof, false);
+}
 
-	struct amp_queue_t queue;
 
-	amp_queue_init(&queue);
+/**
+ * Audio callback. The callback never blocks: pending commands, including
+ * graph swaps, are applied at the start of the block. The first call locks
+ * the audio thread stack when memory locking is enabled.
+ *   @buf: The buffer.
+ *   @len: The length.
+ *   @arg: The callback structure.
+ */
+static void callback(double **buf, unsigned int len, void *arg)
+{
+	struct exec_t *exec = arg;
+	struct amp_time_t time[len+1];
 
-	while(amp_comm_read(engine->comm, &event))
-		amp_queue_add(&queue, (struct amp_action_t){ 0, event });
+	if(exec->stack) {
+		exec->stack = false;
+		amp_harden_stack();
+	}
 
-	if(engine->instr.iface != NULL)
-		amp_instr_proc(engine->instr, buf, time, len, &queue);
-	else
-		dsp_zero_d(buf[0], len), dsp_zero_d(buf[1], len);
+	if(len == 0) {
+		printf("xrun\n");
+		return;
+	}
 
-	sys_mutex_unlock(&engine->lock);
+	amp_engine_block(exec->engine, buf, time, len);
 }
@@ -4,6 +4,6 @@
 /*
  * execution declarations
  */
-void amp_exec(struct amp_audio_t audio, const char *file, char **plugin, struct amp_comm_t *comm);
+void amp_exec(struct amp_audio_t audio, const char *file, char **plugin, struct amp_comm_t *comm, const struct amp_harden_t *harden);
 
 #endif
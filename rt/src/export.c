@@ -63,3 +63,29 @@ void amp_export_seek(struct amp_engine_t *engine, double bar)
 
 	sys_mutex_unlock(&engine->lock);
 }
+
+/**
+ * Retrieve the location of the engine.
+ *   @engine: The engine.
+ *   &returns: The location.
+ */
+struct amp_loc_t amp_export_loc(struct amp_engine_t *engine)
+{
+	struct amp_loc_t loc;
+
+	sys_mutex_lock(&engine->lock);
+	loc = amp_engine_loc(engine);
+	sys_mutex_unlock(&engine->lock);
+
+	return loc;
+}
+
+/**
+ * Retrieve the number of events lost to a full communication ring.
+ *   @engine: The engine.
+ *   &returns: The lost event count.
+ */
+uint64_t amp_export_lost(struct amp_engine_t *engine)
+{
+	return (engine->comm != NULL) ? amp_comm_lost(engine->comm) : 0;
+}
@@ -16,6 +16,8 @@ typedef void (*amp_watch_f)(struct ml_env_t *env, void *arg);
  *   @start: Start the engine.
  *   @stop: Stop the engine.
  *   @seek: Seek to a new time.
+ *   @loc: Retrieve the current location.
+ *   @lost: Retrieve the number of lost input events.
  */
 struct amp_rt_t {
 	struct amp_engine_t *engine;
@@ -24,31 +26,91 @@ struct amp_rt_t {
 	void (*start)(struct amp_engine_t *);
 	void (*stop)(struct amp_engine_t *);
 	void (*seek)(struct amp_engine_t *, double bar);
+	struct amp_loc_t (*loc)(struct amp_engine_t *);
+	uint64_t (*lost)(struct amp_engine_t *);
 };
 
+/**
+ * Graph structure.
+ *   @clock: The clock.
+ *   @instr: The instrument.
+ *   @next: The next graph on the retire list.
+ */
+struct amp_graph_t {
+	struct amp_clock_t clock;
+	struct amp_instr_t instr;
+
+	struct amp_graph_t *next;
+};
+
+/**
+ * Command enumerator.
+ *   @amp_cmd_start_v: Start.
+ *   @amp_cmd_stop_v: Stop.
+ *   @amp_cmd_seek_v: Seek.
+ *   @amp_cmd_swap_v: Swap the graph.
+ */
+enum amp_cmd_e {
+	amp_cmd_start_v,
+	amp_cmd_stop_v,
+	amp_cmd_seek_v,
+	amp_cmd_swap_v
+};
+
+/**
+ * Command structure.
+ *   @type: The type.
+ *   @run: The run flag, used by seek.
+ *   @bar: The bar, used by seek.
+ *   @graph: The graph, used by swap.
+ */
+struct amp_cmd_t {
+	enum amp_cmd_e type;
+
+	bool run;
+	double bar;
+	struct amp_graph_t *graph;
+};
+
+/**
+ * Command ring length.
+ */
+#define AMP_CMD_LEN 16
+
 /**
  * Engine structure.
  *   @run: The run flag.
+ *   @rate: The sample rate.
  *   @core: The core.
  *   @notify: The notifier.
  *   @rev: The revision number.
  *   @lock, sync: The engine lock and synchronizer.
- *   @clock: The clock.
- *   @seq: The sequencer.
- *   @instr: The instrument.
+ *   @live: The live flag, set while the audio callback is executing.
+ *   @graph: The active graph, owned by the audio callback while live.
+ *   @retire: The list of graphs retired by the audio callback.
+ *   @rd, wr, cmd: The command ring read index, write index, and array.
+ *   @seq, loc: The location sequence counter and location.
  *   @rt: The AmpRT structure.
  *   @comm: MIDI device communcation.
  *   @watch: The watch list.
  */
 struct amp_engine_t {
 	bool run;
+	unsigned int rate;
 	struct amp_core_t *core;
 	struct sys_task_t *notify;
 
 	unsigned int rev;
 	sys_mutex_t lock, sync;
-	struct amp_clock_t clock;
-	struct amp_instr_t instr;
+
+	bool live;
+	struct amp_graph_t *graph, *retire;
+
+	unsigned int rd, wr;
+	struct amp_cmd_t cmd[AMP_CMD_LEN];
+
+	unsigned int seq;
+	struct amp_loc_t loc;
 
 	struct amp_rt_t rt;
 	struct amp_comm_t *comm;
@@ -122,6 +184,26 @@ static inline void amp_rt_seek(struct amp_rt_t *rt, double bar)
 	rt->seek(rt->engine, bar);
 }
 
+/**
+ * Retrieve the location of the RT core.
+ *   @rt: The RT core.
+ *   &returns: The location.
+ */
+static inline struct amp_loc_t amp_rt_loc(struct amp_rt_t *rt)
+{
+	return rt->loc(rt->engine);
+}
+
+/**
+ * Retrieve the number of input events lost by the RT core.
+ *   @rt: The RT core.
+ *   &returns: The lost event count.
+ */
+static inline uint64_t amp_rt_lost(struct amp_rt_t *rt)
+{
+	return rt->lost(rt->engine);
+}
+
 
 /*
  * export functions
@@ -131,5 +213,7 @@ bool amp_export_status(struct amp_engine_t *engine);
 void amp_export_start(struct amp_engine_t *engine);
 void amp_export_stop(struct amp_engine_t *engine);
 void amp_export_seek(struct amp_engine_t *engine, double bar);
+struct amp_loc_t amp_export_loc(struct amp_engine_t *engine);
+uint64_t amp_export_lost(struct amp_engine_t *engine);
 
 #endif
@@ -0,0 +1,259 @@
+#define _GNU_SOURCE
+#include "common.h"
+
+#ifndef WINDOWS
+#	include <malloc.h>
+#	include <pthread.h>
+#	include <sched.h>
+#	include <sys/mman.h>
+#endif
+
+
+/**
+ * Parse a hardening configuration string. The string is a list of options,
+ * each a letter followed by a number: 'p' sets the SCHED_FIFO priority, 'c'
+ * pins the audio thread to a CPU, 'm' enables memory locking, 'f' prefaults
+ * sample files, and 'h' sets the heap prefault in MiB.
+ *   @harden: The hardening structure.
+ *   @str: Optional. The configuration string.
+ */
+void amp_harden_conf(struct amp_harden_t *harden, const char *str)
+{
+	*harden = (struct amp_harden_t){ 99, -1, false, false, 16 };
+
+	if(str == NULL)
+		return;
+
+	while(true) {
+		char opt;
+		long val;
+
+		while(isspace(*str))
+			str++;
+
+		if(*str == '\0')
+			break;
+
+		opt = *str++;
+		if(!isdigit(*str))
+			fprintf(stderr, "Missing RT parameter.\n"), exit(1);
+
+		errno = 0;
+		val = strtol(str, (char **)&str, 0);
+		if((errno != 0) || (val > INT_MAX))
+			fprintf(stderr, "Invalid RT parameter. %s.\n", strerror(errno)), exit(1);
+
+		switch(opt) {
+		case 'p': harden->prio = val; break;
+		case 'c': harden->cpu = val; break;
+		case 'm': harden->lock = (val != 0); break;
+		case 'f': harden->fault = (val != 0); break;
+		case 'h': harden->heap = val; break;
+		default: fprintf(stderr, "Invalid RT option '%c'.\n", opt), exit(1);
+		}
+	}
+}
+
+
+/**
+ * Prefault the heap and lock the pages currently mapped. This is called once
+ * the engine is built, so the pool worker stacks, the communication rings,
+ * and the prefaulted heap are locked, while sample files mapped later are
+ * left to 'amp_cache_prefault'. Heap trimming and mmap'd allocations are
+ * disabled so that the locked pages remain in the arena for later
+ * allocations, such as graphs built during a reload. Structures created
+ * afterwards must be locked explicitly, such as the audio thread stack with
+ * 'amp_harden_stack'.
+ *   @harden: The hardening structure.
+ *   &returns: True if memory was locked.
+ */
+bool amp_harden_lock(const struct amp_harden_t *harden)
+{
+	if(!harden->lock)
+		return false;
+
+#ifndef WINDOWS
+	bool fault = true;
+
+	if(harden->heap > 0) {
+		size_t i, size = (size_t)harden->heap * 1024 * 1024;
+		long page = sysconf(_SC_PAGESIZE);
+		volatile uint8_t *ptr;
+
+		mallopt(M_TRIM_THRESHOLD, -1);
+		mallopt(M_MMAP_MAX, 0);
+
+		ptr = malloc(size);
+		if(ptr != NULL) {
+			for(i = 0; i < size; i += page)
+				ptr[i] = 0;
+
+			free((void *)ptr);
+		}
+		else
+			fault = false;
+	}
+
+	if(mlockall(MCL_CURRENT) < 0) {
+		printf("RT: memory lock failed. %s.\n", strerror(errno));
+		return false;
+	}
+
+	if(fault)
+		printf("RT: memory locked, %u MiB heap prefaulted.\n", harden->heap);
+	else
+		printf("RT: memory locked, %u MiB heap prefault failed.\n", harden->heap);
+
+	return true;
+#else
+	printf("RT: memory lock unsupported.\n");
+
+	return false;
+#endif
+}
+
+/**
+ * Lock the stack of the calling thread, for threads created after
+ * 'amp_harden_lock'.
+ */
+void amp_harden_stack(void)
+{
+#ifndef WINDOWS
+	int err;
+	void *addr;
+	size_t size;
+	pthread_attr_t attr;
+
+	err = pthread_getattr_np(pthread_self(), &attr);
+	if(err != 0) {
+		printf("RT: stack lock failed. %s.\n", strerror(err));
+		return;
+	}
+
+	pthread_attr_getstack(&attr, &addr, &size);
+	pthread_attr_destroy(&attr);
+
+	if(mlock(addr, size) < 0)
+		printf("RT: stack lock failed. %s.\n", strerror(errno));
+#endif
+}
+
+/**
+ * Harden the worker pool. Workers run with SCHED_FIFO one priority below the
+ * audio thread, and when the audio thread is pinned, each worker is pinned
+ * to one of the following CPUs so that none competes with it.
+ *   @harden: The hardening structure.
+ *   @pool: The worker pool.
+ */
+void amp_harden_pool(const struct amp_harden_t *harden, struct amp_pool_t *pool)
+{
+	unsigned int n = amp_pool_nthreads(pool);
+
+	if(n == 0)
+		return;
+
+#ifndef WINDOWS
+	int err;
+	unsigned int i;
+	struct sched_param param;
+	cpu_set_t set;
+
+	if(harden->prio > 1) {
+		param.sched_priority = harden->prio - 1;
+
+		for(i = 0, err = 0; (i < n) && (err == 0); i++)
+			err = pthread_setschedparam(amp_pool_thread(pool, i)->pthrd, SCHED_FIFO, &param);
+
+		if(err != 0)
+			printf("RT: pool SCHED_FIFO priority %d failed. %s.\n", harden->prio - 1, strerror(err));
+		else
+			printf("RT: pool SCHED_FIFO priority %d.\n", harden->prio - 1);
+	}
+
+	if((harden->cpu >= 0) && (harden->cpu < CPU_SETSIZE)) {
+		unsigned int ncpu = amp_pool_ncpu();
+
+		for(i = 0, err = 0; (i < n) && (err == 0); i++) {
+			CPU_ZERO(&set);
+			CPU_SET((harden->cpu + 1 + i % (ncpu - 1)) % ncpu, &set);
+			err = pthread_setaffinity_np(amp_pool_thread(pool, i)->pthrd, sizeof(cpu_set_t), &set);
+		}
+
+		if(err != 0)
+			printf("RT: pinning pool failed. %s.\n", strerror(err));
+		else
+			printf("RT: pool pinned beside CPU %d.\n", harden->cpu);
+	}
+#else
+	if((harden->prio > 1) || (harden->cpu >= 0))
+		printf("RT: pool hardening unsupported.\n");
+#endif
+}
+
+/**
+ * Start an audio device with a hardened audio thread. The scheduler and CPU
+ * affinity are applied to the calling thread, and reported as each takes
+ * effect or fails, so that the thread created by the device inherits them
+ * before the stream starts. The calling thread is restored afterwards.
+ *   @harden: The hardening structure.
+ *   @audio: The audio device.
+ *   @func: The audio callback.
+ *   @arg: The callback argument.
+ */
+void amp_harden_exec(const struct amp_harden_t *harden, struct amp_audio_t audio, amp_audio_f func, void *arg)
+{
+#ifndef WINDOWS
+	int err, policy, prev;
+	struct sched_param param, save;
+	cpu_set_t set, mask;
+	bool sched = false, pin = false;
+
+	if(harden->prio > 0) {
+		pthread_getschedparam(pthread_self(), &prev, &save);
+
+		param.sched_priority = harden->prio;
+		err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+		if(err == 0)
+			err = pthread_getschedparam(pthread_self(), &policy, &param);
+
+		if(err != 0)
+			printf("RT: SCHED_FIFO priority %d failed. %s.\n", harden->prio, strerror(err));
+		else if((policy != SCHED_FIFO) || (param.sched_priority != harden->prio))
+			printf("RT: SCHED_FIFO priority %d not applied.\n", harden->prio);
+		else
+			printf("RT: SCHED_FIFO priority %d.\n", harden->prio);
+
+		sched = (err == 0);
+	}
+
+	if(harden->cpu >= CPU_SETSIZE)
+		printf("RT: pinning to CPU %d failed. CPU out of range.\n", harden->cpu);
+	else if(harden->cpu >= 0) {
+		pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &mask);
+
+		CPU_ZERO(&set);
+		CPU_SET(harden->cpu, &set);
+		err = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set);
+		if(err != 0)
+			printf("RT: pinning to CPU %d failed. %s.\n", harden->cpu, strerror(err));
+		else
+			printf("RT: pinned to CPU %d.\n", harden->cpu);
+
+		pin = (err == 0);
+	}
+
+	fflush(stdout);
+	amp_audio_exec(audio, func, arg);
+
+	if(sched)
+		pthread_setschedparam(pthread_self(), prev, &save);
+
+	if(pin)
+		pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &mask);
+#else
+	if((harden->prio > 0) || (harden->cpu >= 0))
+		printf("RT: thread hardening unsupported.\n");
+
+	amp_audio_exec(audio, func, arg);
+#endif
+}
@@ -0,0 +1,14 @@
+#ifndef HARDEN_H
+#define HARDEN_H
+
+/*
+ * hardening declarations
+ */
+void amp_harden_conf(struct amp_harden_t *harden, const char *str);
+
+bool amp_harden_lock(const struct amp_harden_t *harden);
+void amp_harden_stack(void);
+void amp_harden_pool(const struct amp_harden_t *harden, struct amp_pool_t *pool);
+void amp_harden_exec(const struct amp_harden_t *harden, struct amp_audio_t audio, amp_audio_f func, void *arg);
+
+#endif
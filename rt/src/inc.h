@@ -3,6 +3,8 @@
 #include "engine.h"
 #include "exec.h"
 #include "export.h"
+#include "harden.h"
+#include "render.h"
 #include "watch.h"
 #include "dummy/audio.h"
 #include "export.h"
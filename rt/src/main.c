@@ -64,8 +64,9 @@ int main(int argc, char **argv)
 {
 	struct amp_audio_t audio;
 	struct amp_comm_t *comm;
+	struct amp_harden_t harden;
 	const struct amp_audio_i *iface = NULL;
-	char **arg, *file = NULL, **plugin, *val, *conf = NULL;
+	char **arg, *file = NULL, **plugin, *val, *conf = NULL, *render = NULL, *rt = NULL;
 
 #if DEBUG
 	setbuf(stdout, NULL);
@@ -117,6 +118,10 @@ int main(int argc, char **argv)
 				fprintf(stderr, "PulseAudio is unavailable.\n"), exit(1);
 #endif
 			}
+			else if((val = optlong(&arg, "--render")) != NULL)
+				render = val;
+			else if((val = optlong(&arg, "--rt")) != NULL)
+				rt = val;
 			else if((val = optlong(&arg, "--midi")) != NULL) {
 				const char *str;
 				unsigned long dev;
@@ -160,14 +165,21 @@ int main(int argc, char **argv)
 			fprintf(stderr, "Cannot handle short options.\n"), exit(1);
 	}
 
-	if(iface == NULL)
+	if((iface != NULL) && (render != NULL))
+		fprintf(stderr, "Cannot render while using an audio interface.\n"), exit(1);
+	if((iface == NULL) && (render == NULL))
 		fprintf(stderr, "No audio interface selected.\n"), exit(1);
 	if(file == NULL)
 		fprintf(stderr, "Missing source file.\n"), exit(1);
 
-	audio = amp_audio_open(conf, iface);
-	amp_exec(audio, file, plugin, comm);
-	amp_audio_close(audio);
+	if(render != NULL)
+		amp_render(file, plugin, comm, render);
+	else {
+		amp_harden_conf(&harden, rt);
+		audio = amp_audio_open(conf, iface);
+		amp_exec(audio, file, plugin, comm, &harden);
+		amp_audio_close(audio);
+	}
 	strlist_delete(plugin);
 
 	if(hax_memcnt != 0)
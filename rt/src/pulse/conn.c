@@ -76,8 +76,6 @@ struct pulse_conn_t *pulse_conn_open(const char *name, amp_audio_f func, void *a
 {
 	int err;
 	unsigned int i;
-	pthread_attr_t attr;
-	struct sched_param param;
 	struct pulse_conn_t *conn;
 
 	conn = malloc(sizeof(struct pulse_conn_t));
@@ -110,33 +108,9 @@ struct pulse_conn_t *pulse_conn_open(const char *name, amp_audio_f func, void *a
 	pa_context_set_state_callback(conn->context, conn_state, conn);
 	pa_context_connect(conn->context, NULL, 0, NULL);
 
-	err = pthread_attr_init(&attr);
+	err = pthread_create(&conn->thread, NULL, conn_thread, conn);
 	if(err != 0)
-		fprintf(stderr, "Failed to initialize thread attributes. %s.", strerror(err)), exit(1);
-
-	err = pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
-	if(err != 0)
-		fprintf(stderr, "Failed to set schedular inheritance. %s.", strerror(err)), exit(1);
-
-	err = pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
-	if(err != 0)
-		fprintf(stderr, "Failed to set schedular policy. %s.", strerror(err)), exit(1);
-
-	param.sched_priority = 99;
-	err = pthread_attr_setschedparam(&attr, &param);
-	if(err != 0)
-		fprintf(stderr, "Failed to set schedular parameter. %s.", strerror(err)), exit(1);
-
-	err = pthread_create(&conn->thread, &attr, conn_thread, conn);
-	if(err != 0) {
-		err = pthread_create(&conn->thread, NULL, conn_thread, conn);
-		if(err != 0)
-			fprintf(stderr, "Failed to start thread. %s.", strerror(err)), exit(1);
-	}
-
-	pthread_attr_destroy(&attr);
-	if(err != 0)
-		fprintf(stderr, "Failed to destroy thread attributes. %s.", strerror(err)), exit(1);
+		fprintf(stderr, "Failed to start thread. %s.", strerror(err)), exit(1);
 
 	return conn;
 }
@@ -0,0 +1,321 @@
+#include "common.h"
+#include <sndfile.h>
+
+
+/**
+ * Render configuration structure.
+ *   @path: The output path.
+ *   @rate, len: The sample rate and block length.
+ *   @secs, bars: The length in seconds or bars, zero if unused.
+ */
+struct render_conf_t {
+	char path[256];
+	unsigned int rate, len;
+	double secs, bars;
+};
+
+/**
+ * Render output structure.
+ *   @file: The sound file, null if writing ACW.
+ *   @enc: The ACW encoders for each channel, null if writing through
+ *     libsndfile.
+ *   @path: The output path.
+ *   @rate: The sample rate.
+ *   @arr: The conversion buffer, holding an interleaved stereo block.
+ */
+struct render_out_t {
+	SNDFILE *file;
+	struct acw_encode_t *enc[2];
+
+	const char *path;
+	unsigned int rate;
+
+	double *arr;
+};
+
+
+/*
+ * local declarations
+ */
+static void render_conf(struct render_conf_t *conf, const char *str);
+
+static void out_open(struct render_out_t *out, const char *path, unsigned int rate, unsigned int len);
+static void out_write(struct render_out_t *out, double **buf, unsigned int len);
+static void out_close(struct render_out_t *out);
+
+
+/**
+ * Render a file offline, as fast as possible, without an audio device. A
+ * render in bars stops after 'AMP_RENDER_CAP' seconds if the last bar is
+ * never reached.
+ *   @file: The source file.
+ *   @plugin: The plugin list.
+ *   @comm: Optional. Consumed. The communication structure.
+ *   @str: The render configuration string.
+ */
+void amp_render(const char *file, char **plugin, struct amp_comm_t *comm, const char *str)
+{
+	char **el;
+	uint64_t n, total;
+	int64_t begin;
+	double *buf[2];
+	struct amp_time_t *time;
+	struct render_conf_t conf;
+	struct render_out_t out;
+	struct amp_engine_t *engine;
+
+	render_conf(&conf, str);
+
+	engine = amp_engine_new(NULL, comm, conf.rate, "render");
+
+	for(el = plugin; *el != NULL; el++) {
+		char *err;
+
+		err = amp_core_plugin(engine->core, *el);
+		if(err != NULL)
+			fprintf(stderr, "Warning. %s\n", err), free(err);
+	}
+
+	amp_engine_update(engine, file);
+
+	sys_mutex_lock(&engine->lock);
+	if(!engine->run)
+		amp_engine_start(engine);
+	sys_mutex_unlock(&engine->lock);
+
+	out_open(&out, conf.path, conf.rate, conf.len);
+
+	n = 0;
+	total = (uint64_t)(((conf.secs > 0.0) ? conf.secs : AMP_RENDER_CAP) * conf.rate);
+	begin = sys_utime();
+
+	buf[0] = malloc(conf.len * sizeof(double));
+	buf[1] = malloc(conf.len * sizeof(double));
+	time = malloc((conf.len + 1) * sizeof(struct amp_time_t));
+
+	while(n < total) {
+		bool done = false;
+		unsigned int i, len;
+
+		len = ((total - n) < conf.len) ? (total - n) : conf.len;
+		dsp_zero_d(buf[0], len);
+		dsp_zero_d(buf[1], len);
+		amp_engine_block(engine, buf, time, len);
+
+		if(conf.bars > 0.0) {
+			for(i = 0; i < len; i++) {
+				if(time[i].bar >= conf.bars)
+					break;
+			}
+
+			done = (i < len);
+			len = i;
+		}
+
+		out_write(&out, buf, len);
+		n += len;
+
+		if(done)
+			break;
+	}
+
+	if((conf.secs == 0.0) && (n == total))
+		fprintf(stderr, "Warning. Render stopped after %u seconds before bar %g.\n", AMP_RENDER_CAP, conf.bars);
+
+	free(buf[0]);
+	free(buf[1]);
+	free(time);
+	out_close(&out);
+
+	fprintf(stderr, "Rendered %.3f seconds in %.3f seconds.\n", (double)n / conf.rate, (sys_utime() - begin) / 1000000.0);
+
+	amp_engine_delete(engine);
+}
+
+
+/**
+ * Parse the render configuration. The string starts with the output path,
+ * followed by any number of options: 'r' for sample rate, 'l' for block
+ * length, 's' for seconds, and 'b' for bars.
+ *   @conf: The configuration.
+ *   @str: The string.
+ */
+static void render_conf(struct render_conf_t *conf, const char *str)
+{
+	unsigned int i = 0;
+
+	while(isspace(*str))
+		str++;
+
+	if(*str == '\'') {
+		for(str++; (*str != '\'') && (*str != '\0'); str++) {
+			if(i < sizeof(conf->path) - 1)
+				conf->path[i++] = *str;
+		}
+
+		if(*str == '\'')
+			str++;
+	}
+	else {
+		for(; !isspace(*str) && (*str != '\0'); str++) {
+			if(i < sizeof(conf->path) - 1)
+				conf->path[i++] = *str;
+		}
+	}
+
+	conf->path[i] = '\0';
+	conf->rate = 48000;
+	conf->len = 256;
+	conf->secs = 0.0;
+	conf->bars = 0.0;
+
+	if(conf->path[0] == '\0')
+		fprintf(stderr, "Missing render output path.\n"), exit(1);
+
+	while(true) {
+		char opt;
+		double val;
+
+		while(isspace(*str))
+			str++;
+
+		if(*str == '\0')
+			break;
+
+		opt = *str++;
+		if(!isdigit(*str) && (*str != '.'))
+			fprintf(stderr, "Missing render parameter.\n"), exit(1);
+
+		errno = 0;
+		val = strtod(str, (char **)&str);
+		if((errno != 0) || (val < 0.0) || (val > UINT_MAX))
+			fprintf(stderr, "Invalid parameter. %s.\n", strerror(errno)), exit(1);
+
+		switch(opt) {
+		case 'r': conf->rate = val; break;
+		case 'l': conf->len = val; break;
+		case 's': conf->secs = val; break;
+		case 'b': conf->bars = val; break;
+		default: fprintf(stderr, "Invalid render option '%c'.\n", opt), exit(1);
+		}
+	}
+
+	if((conf->rate == 0) || (conf->len == 0))
+		fprintf(stderr, "Render rate and block length must be non-zero.\n"), exit(1);
+
+	if(conf->len > AMP_RENDER_LEN)
+		fprintf(stderr, "Render block length must be at most %u.\n", AMP_RENDER_LEN), exit(1);
+
+	if((conf->secs == 0.0) && (conf->bars == 0.0))
+		fprintf(stderr, "Render length must be given in seconds or bars.\n"), exit(1);
+}
+
+
+/**
+ * Open the render output. The format is selected from the extension: '.acw'
+ * writes stereo through the ACW encoder, '.flac' and '.wav' write 24-bit
+ * stereo through libsndfile.
+ *   @out: The output.
+ *   @path: The path.
+ *   @rate: The sample rate.
+ *   @len: The largest block length.
+ */
+static void out_open(struct render_out_t *out, const char *path, unsigned int rate, unsigned int len)
+{
+	const char *ext;
+	SF_INFO info;
+
+	out->path = path;
+	out->rate = rate;
+	out->file = NULL;
+	out->enc[0] = out->enc[1] = NULL;
+	out->arr = malloc(2 * len * sizeof(double));
+
+	ext = strrchr(path, '.');
+	if(ext == NULL)
+		fprintf(stderr, "Render output '%s' has no extension.\n", path), exit(1);
+
+	if(strcasecmp(ext, ".acw") == 0) {
+		out->enc[0] = acw_encode_new();
+		out->enc[1] = acw_encode_new();
+
+		return;
+	}
+	else if(strcasecmp(ext, ".flac") == 0)
+		info.format = SF_FORMAT_FLAC | SF_FORMAT_PCM_24;
+	else if(strcasecmp(ext, ".wav") == 0)
+		info.format = SF_FORMAT_WAV | SF_FORMAT_PCM_24;
+	else
+		fprintf(stderr, "Unknown render format '%s'.\n", ext), exit(1);
+
+	info.samplerate = rate;
+	info.channels = 2;
+
+	out->file = sf_open(path, SFM_WRITE, &info);
+	if(out->file == NULL)
+		fprintf(stderr, "Cannot write '%s'. %s\n", path, sf_strerror(NULL)), exit(1);
+}
+
+/**
+ * Write a block to the render output.
+ *   @out: The output.
+ *   @buf: The stereo buffer.
+ *   @len: The length, at most the length given on open.
+ */
+static void out_write(struct render_out_t *out, double **buf, unsigned int len)
+{
+	unsigned int i, c;
+
+	dsp_clamp_d(buf[0], len);
+	dsp_clamp_d(buf[1], len);
+
+	if(out->enc[0] != NULL) {
+		int *arr = (int *)out->arr;
+
+		for(c = 0; c < 2; c++) {
+			for(i = 0; i < len; i++)
+				arr[i] = buf[c][i] * 8388607.0;
+
+			acw_encode_proc(out->enc[c], arr, len);
+		}
+	}
+	else {
+		double *arr = out->arr;
+
+		for(i = 0; i < len; i++) {
+			arr[2*i+0] = buf[0][i];
+			arr[2*i+1] = buf[1][i];
+		}
+
+		if(sf_writef_double(out->file, arr, len) != len)
+			fprintf(stderr, "Failed to write '%s'. %s\n", out->path, sf_strerror(out->file)), exit(1);
+	}
+}
+
+/**
+ * Close the render output.
+ *   @out: The output.
+ */
+static void out_close(struct render_out_t *out)
+{
+	char *err;
+	struct acw_buf_t buf, chan[2];
+
+	if(out->enc[0] != NULL) {
+		chan[0] = acw_encode_done(out->enc[0]);
+		chan[1] = acw_encode_done(out->enc[1]);
+
+		buf = acw_buf_join(chan, 2);
+		buf.info.rate = out->rate;
+
+		err = acw_buf_save(buf, out->path);
+		acw_buf_delete(buf);
+
+		if(err != NULL)
+			fprintf(stderr, "%s\n", err), free(err), exit(1);
+	}
+	else
+		sf_close(out->file);
+
+	free(out->arr);
+}
@@ -0,0 +1,9 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+/*
+ * render declarations
+ */
+void amp_render(const char *file, char **plugin, struct amp_comm_t *comm, const char *conf);
+
+#endif